@@ -0,0 +1,27 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_FLAGS_H
+#define LOXALONE_FLAGS_H
+
+#include <charconv>
+#include <cstddef>
+#include <string_view>
+#include <system_error>
+
+// Parses the value of a `--name=N` flag, returns false if `arg` isn't that
+// flag or the value isn't a number of at least `min`
+inline auto parse_flag(std::string_view arg, std::string_view name,
+                       size_t& out, size_t min = 1) -> bool {
+  if (!arg.starts_with(name)) return false;
+  arg.remove_prefix(name.size());
+
+  size_t value = 0;
+  auto [end, err] = std::from_chars(arg.begin(), arg.end(), value);
+  if (err != std::errc{} || end != arg.end() || value < min) return false;
+  out = value;
+  return true;
+}
+
+#endif  // LOXALONE_FLAGS_H
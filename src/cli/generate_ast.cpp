@@ -21,8 +21,20 @@ struct Field {
 struct Class {
   std::string_view name;
   std::vector<Field> fields;
+  // Fields that are filled in after the node is created, e.g. by the resolver
+  std::vector<Field> annotations;
 };
 
+// Lists are stored in the arena, but built by the parser as vectors
+auto is_list(const Field& field) -> bool {
+  return field.type.starts_with("List<");
+}
+
+auto create_param_type(const Field& field) -> std::string {
+  if (!is_list(field)) return std::string{field.type};
+  return fmt::format("std::vector{}", field.type.substr(4));
+}
+
 auto define_type(std::ostream& out, const std::string_view& base,
                  const Class& cls) -> void {
   out << fmt::format("class {}", cls.name) << " {\n"
@@ -31,6 +43,9 @@ auto define_type(std::ostream& out, const std::string_view& base,
     // Not very great but this will do for now...
     out << fmt::format("  const {} {}_m;\n", field.type, field.name);
   }
+  for (const auto& field : cls.annotations) {
+    out << fmt::format("  {} {}_m{{}};\n", field.type, field.name);
+  }
 
   out << "\n"
       << (cls.fields.size() == 1 ? "  explicit " : "  ") << cls.name << "(";
@@ -50,17 +65,19 @@ auto define_type(std::ostream& out, const std::string_view& base,
 
   out << " {}\n" << fmt::format("  ~{}() = default;\n\n", cls.name);
 
-  // helper method for creating this type
-  out << "  static auto create(";
-  for (int i = 0; i < cls.fields.size(); i++) {
-    out << fmt::format("{}&& {}", cls.fields[i].type,
-                       to_lowercase(cls.fields[i].name));
-    if (i < cls.fields.size() - 1) out << ", ";
+  // helper method for creating this type inside the arena
+  out << "  static auto create(Arena& arena";
+  for (const auto& field : cls.fields) {
+    out << fmt::format(", {}&& {}", create_param_type(field),
+                       to_lowercase(field.name));
   }
   out << fmt::format(") -> {}Ptr {{\n", cls.name)
-      << fmt::format("    return std::make_unique<{}>(", cls.name);
+      << fmt::format("    return arena.make<{}>(", cls.name);
   for (int i = 0; i < cls.fields.size(); i++) {
-    out << fmt::format("std::move({})", cls.fields[i].name);
+    if (is_list(cls.fields[i]))
+      out << fmt::format("arena.list(std::move({}))", cls.fields[i].name);
+    else
+      out << fmt::format("std::move({})", cls.fields[i].name);
     if (i < cls.fields.size() - 1) out << ", ";
   }
   out << ");\n"
@@ -69,7 +86,7 @@ auto define_type(std::ostream& out, const std::string_view& base,
   // helper method for creating empty() method for creating empty pointer of
   // this type
   out << fmt::format("  static auto empty() -> {} {{\n", base)
-      << fmt::format("    return std::unique_ptr<{}>(nullptr);\n", cls.name)
+      << fmt::format("    return static_cast<{}Ptr>(nullptr);\n", cls.name)
       << "  }\n\n";
 
   // end
@@ -79,17 +96,22 @@ auto define_type(std::ostream& out, const std::string_view& base,
 // TODO: Revisit this by checking out other interpreters, how do we implement
 //       visiting without pointers?
 // TODO: Maybe a better way is to have a template engine do all of these for us?
+// `declarations` are the classes the nodes only point to, which are defined in
+// headers including this one
 auto define_ast(const std::filesystem::path& filepath,
                 const std::string_view& base,
                 const std::vector<std::string_view>& types,
-                const std::vector<std::string_view>& imports) -> int {
+                const std::vector<std::string_view>& imports,
+                const std::vector<std::string_view>& declarations = {})
+    -> int {
   std::ofstream out{filepath, std::ios_base::out};
 
   out << fmt::format("#ifndef LOXALONE_{}_H\n", base)
-      << fmt::format("#define LOXALONE_{}_H\n\n", base) << "#include <memory>\n"
+      << fmt::format("#define LOXALONE_{}_H\n\n", base)
       << "#include <vector>\n"
       << "#include <string>\n"
       << "#include <variant>\n\n"
+      << "#include \"Arena.h\"\n"
       << "#include \"Token.h\"\n\n";
 
   for (const auto& imp : imports) {
@@ -98,18 +120,32 @@ auto define_ast(const std::filesystem::path& filepath,
   out << '\n';
 
   out << "namespace loxalone {\n\n";
+  for (const auto& declaration : declarations) {
+    out << fmt::format("class {};\n", declaration);
+  }
+  if (!declarations.empty()) out << '\n';
+
   std::vector<Class> classes{};
   for (const auto& type : types) {
     std::vector parts = split(type, '-');
-    std::string_view name = trim(parts[0]), fields_string = trim(parts[1]);
-
-    std::vector<Field> fields{};
-    for (const auto& part : split(fields_string, ',')) {
-      std::vector<std::string_view> field_parts = split(trim(part), ' ');
-      fields.emplace_back(Field{field_parts[0], field_parts[1]});
-    }
-
-    classes.emplace_back(Class{name, fields});
+    std::string_view name = trim(parts[0]);
+
+    // Constructor fields and annotations are separated by '|'
+    std::vector sections = split(trim(parts[1]), '|');
+    auto parse_fields = [](std::string_view fields_string) {
+      std::vector<Field> fields{};
+      for (const auto& part : split(fields_string, ',')) {
+        std::vector<std::string_view> field_parts = split(trim(part), ' ');
+        fields.emplace_back(Field{field_parts[0], field_parts[1]});
+      }
+      return fields;
+    };
+
+    std::vector<Field> fields = parse_fields(trim(sections[0]));
+    std::vector<Field> annotations{};
+    if (sections.size() > 1) annotations = parse_fields(trim(sections[1]));
+
+    classes.emplace_back(Class{name, fields, annotations});
   }
 
   for (const auto& cls : classes) {
@@ -117,10 +153,9 @@ auto define_ast(const std::filesystem::path& filepath,
   }
   out << "\n";
 
-  // define pointer types
+  // define pointer types, the nodes are owned by the arena
   for (const auto& cls : classes) {
-    out << fmt::format("using {}Ptr = std::unique_ptr<{}>;\n", cls.name,
-                       cls.name);
+    out << fmt::format("using {}Ptr = {}*;\n", cls.name, cls.name);
   }
   out << "\n";
 
@@ -176,7 +211,7 @@ auto define_ast(const std::filesystem::path& filepath,
 
 int main(int argc, char** argv) {
   if (argc != 2) {
-    fmt::print(stderr, USAGE);
+    fmt::print(stderr, "{}", USAGE);
     return EX_USAGE;
   }
 
@@ -185,24 +220,34 @@ int main(int argc, char** argv) {
 
   // clang-format off
   define_ast(filepath / "Expr.h", "Expr", {
-              "Assign   - Token name, Expr value",
-              "Binary   - Expr left, Token oper, Expr right",
-              "Call     - Expr callee, Token paren, std::vector<Expr> arguments",
-              "Grouping - Expr expression",
-              "Literal  - lox_literal value",
-              "Logical  - Expr left, Token oper, Expr right",
-              "Unary    - Token oper, Expr right",
-              "Variable - Token name"}, {});
+              "Assign      - Token name, Expr value | Slot slot",
+              "Binary      - Expr left, Token oper, Expr right",
+              "Call        - Expr callee, Token paren, List<Expr> arguments",
+              "Get         - Expr object, Token name | PropertyCache cache, MethodCache method_cache",
+              "Grouping    - Expr expression",
+              "Index       - Expr object, Token bracket, Expr index",
+              "ListLiteral - Token bracket, List<Expr> elements",
+              "Literal     - Value value",
+              "Logical     - Expr left, Token oper, Expr right",
+              "MapLiteral  - Token brace, List<Expr> keys, List<Expr> values",
+              "Set         - Expr object, Token name, Expr value | PropertyCache cache",
+              "SetIndex    - Expr object, Token bracket, Expr index, Expr value",
+              "Super       - Token keyword, Token method | Slot slot, Slot receiver, MethodCache cache",
+              "This        - Token keyword | Slot slot",
+              "Unary       - Token oper, Expr right",
+              "Variable    - Token name | Slot slot"}, {"Shape.h", "Slot.h"});
 
   define_ast(filepath / "Stmt.h", "Stmt", {
-              "Block      - std::vector<Stmt> statements",
+              "Block      - List<Stmt> statements",
               "Expression - Expr expression",
-              "Function   - Token name, std::vector<Token> params, std::vector<Stmt> body",
-              "Class      - Token name, std::vector<FunctionPtr> methods",
+              "Function   - Token name, List<Token> params, List<Stmt> body | Slot slot, FunctionLayout layout, MemoTable* memo",
+              "Class      - Token name, Expr superclass, List<FunctionPtr> methods | Slot slot, Slot super_slot",
               "If         - Expr expression, Token token, Stmt then_branch, Stmt else_branch",
               "While      - Expr condition, Stmt body, Token token",
+              "ForIn      - Token name, Expr iterable, Stmt body, Token token | Slot slot",
               "Print      - Expr expression",
               "Return     - Token keyword, Expr value",
-              "Var        - Token name, Expr initializer"}, {"Expr.h"});
+              "Var        - Token name, Expr initializer | Slot slot",
+              "Import     - Token keyword, Token path | Module* module"}, {"Expr.h", "Memo.h"}, {"Module"});
   // clang-format on
 }
\ No newline at end of file
@@ -1,37 +1,126 @@
 #include <fmt/format.h>
 #include <sysexits.h>
 
-#include <fstream>
+#include <algorithm>
 #include <iostream>
+#include <optional>
 #include <string_view>
+#include <thread>
+#include <utility>
+#include <variant>
 
 #include "../interpreter/Interpreter.h"
+#include "../interpreter/Module.h"
+#include "../interpreter/NativeStack.h"
+#include "../interpreter/Optimizer.h"
 #include "../interpreter/Parser.h"
+#include "../interpreter/Purity.h"
 #include "../interpreter/Resolver.h"
 #include "../interpreter/Scanner.h"
+#include "../interpreter/SourceFile.h"
+#include "../interpreter/VM.h"
+#include "Flags.h"
 
-const auto USAGE = "Usage: loxalone [script]";
+const auto USAGE =
+    "Usage: loxalone [--engine=tree|vm] [--opt=0|1] [--stats] "
+    "[--max-call-depth=N] [--memoize-pure] [--jobs=N] [script]";
 
 using namespace loxalone;
 
-// Probably should return result rather than boolean
-// And also each line is run once here, the interpreter probably needs to
-// maintain internal state (e.g. variables set, classes defined, etc.)
-// and probably needs to move the run function out of this
-auto run(Interpreter& interpreter, const std::string_view& source) -> bool {
-  Scanner scanner{source};
+struct Options {
+  // 0 runs the tree as parsed, 1 runs the optimizer on it first
+  int opt_level = 0;
+  // Reports what the optimizer and the memo tables did to stderr
+  bool stats = false;
+  // Calls nested deeper than this are reported as a stack overflow
+  size_t max_call_depth = DEFAULT_MAX_CALL_DEPTH;
+  // Caches the results of the pure functions by their arguments
+  bool memoize_pure = false;
+  // Number of threads loading the imported modules
+  size_t jobs = std::thread::hardware_concurrency();
+};
+
+// One optimizer is used for the whole script, so the number of nodes it
+// removed adds up over the declarations
+auto optimize(Optimizer& optimizer, List<Stmt> statements,
+              const Options& options) -> List<Stmt> {
+  if (options.opt_level < 1) return statements;
+  return optimizer.optimize(statements);
+}
+
+auto report_optimizer(const Optimizer& optimizer, const Options& options)
+    -> void {
+  if (options.opt_level < 1 || !options.stats) return;
+  fmt::print(stderr, "optimizer: removed {} nodes\n", optimizer.removed());
+}
+
+// Loads the modules imported by the statements and optimizes the ones loaded
+// for the first time. Returns them in dependency order, or nullopt if any of
+// them can't be loaded.
+auto link(ModuleLoader& modules, Optimizer& optimizer, const Options& options,
+          List<Stmt> statements) -> std::optional<std::vector<Module*>> {
+  auto loaded = modules.load(statements);
+  if (!loaded.has_value()) return std::nullopt;
+  for (Module* module : *loaded)
+    module->statements = optimize(optimizer, module->statements, options);
+  return loaded;
+}
+
+// The functions of the modules are called by the script and the other way
+// around, so purity is decided for all of them at once
+auto memoize(Arena& arena, const std::vector<Module*>& modules,
+             List<Stmt> statements, const Options& options)
+    -> std::vector<MemoTable*> {
+  if (!options.memoize_pure) return {};
+
+  std::vector<Stmt> program{};
+  for (const auto* module : modules)
+    program.insert(program.end(), module->statements.begin(),
+                   module->statements.end());
+  program.insert(program.end(), statements.begin(), statements.end());
+  return Purity{arena}.memoize(arena.list(std::move(program)));
+}
+
+auto report_memo(const std::vector<MemoTable*>& tables,
+                 const Options& options) -> void {
+  if (!options.stats) return;
+  for (const auto* table : tables) {
+    fmt::print(stderr, "memoize: {} {} hits, {} misses\n", table->name(),
+               table->hits(), table->misses());
+  }
+}
 
-  std::optional<std::vector<Token>> tokens{scanner.scan_tokens()};
-  if (!tokens.has_value()) return false;
+auto is_import(const Stmt& statement) -> bool {
+  return std::holds_alternative<ImportPtr>(statement);
+}
 
-  Parser parser{tokens.value()};
-  std::vector<Stmt> statements = parser.parse();
+// Returns the statements before the first import, which don't need any of
+// the modules. Without memoizing they run in a batch of their own, so they
+// still run when an import fails.
+auto before_import(Arena& arena, List<Stmt> statements) -> List<Stmt> {
+  auto first = std::find_if(statements.begin(), statements.end(), is_import);
+  return arena.list(std::vector<Stmt>{statements.begin(), first});
+}
 
+// Runs parsed statements, returns false if they fail to run to completion
+auto execute(Interpreter& interpreter, Arena& arena, ModuleLoader& modules,
+             Optimizer& optimizer, const Options& options,
+             List<Stmt> statements) -> bool {
   try {
-    Resolver resolver{interpreter};
+    Resolver resolver{};
     resolver.resolve(statements);
 
-    return interpreter.interpret(statements);
+    auto loaded = link(modules, optimizer, options, statements);
+    if (!loaded.has_value()) {
+      interpreter.interpret(
+          optimize(optimizer, before_import(arena, statements), options));
+      return false;
+    }
+    List<Stmt> program = optimize(optimizer, statements, options);
+    auto tables = memoize(arena, *loaded, program, options);
+    bool ok = interpreter.interpret(program);
+    report_memo(tables, options);
+    return ok;
   } catch (const ParserError& err) {
     report(err.token.line, "", err.msg);
   } catch (const RuntimeError& err) {
@@ -41,58 +130,175 @@ auto run(Interpreter& interpreter, const std::string_view& source) -> bool {
   return false;
 }
 
-// TODO: Non-existent files are not being reported here, fix this.
-auto run_file(const std::string_view& file) -> int {
+// Same as above, but the statements are compiled and run by the bytecode VM
+auto execute(VM& vm, Arena& arena, ModuleLoader& modules, Optimizer& optimizer,
+             const Options& options, List<Stmt> statements) -> bool {
   try {
-    std::ifstream fs{file};
-    std::string source{};
+    auto loaded = link(modules, optimizer, options, statements);
+    if (!loaded.has_value()) {
+      vm.interpret(
+          optimize(optimizer, before_import(arena, statements), options));
+      return false;
+    }
+    List<Stmt> program = optimize(optimizer, statements, options);
+    auto tables = memoize(arena, *loaded, program, options);
+    bool ok = vm.interpret(program);
+    report_memo(tables, options);
+    return ok;
+  } catch (const RuntimeError& err) {
+    report(err.token.line, "", err.msg);
+  }
 
-    char c;
-    while (fs.get(c))
-      source.push_back(c);
+  return false;
+}
 
-    Scanner scanner{source};
-    std::optional<std::vector<Token>> tokens{scanner.scan_tokens()};
-    if (!tokens.has_value()) return false;
+// Top-level declarations are run in batches of this many as they are parsed.
+// Running them one by one would cost a compile and a call each.
+static constexpr size_t BATCH_SIZE = 64;
 
-    Parser parser{tokens.value()};
+// Runs the source, returns false if it fails to run to completion.
+//
+// The top-level declarations are run as soon as a batch of them is parsed, so
+// a long script starts running right away and only a few of its tokens exist
+// at a time. The declarations before a syntax error still run, after it the
+// rest of the script is only parsed to report the other errors. Purity is
+// decided for the whole program though, so with memoizing all of it is parsed
+// first.
+//
+// The modules imported by a batch are loaded before any of it runs, so a
+// batch ends before an import following other statements, which then run
+// even if the import fails. Imports in a row are still loaded together. With
+// memoizing, all of the modules are loaded before anything runs. If one of
+// them can't be loaded, the statements before the first import run after all,
+// so they print the same either way.
+//
+// The syntax tree is allocated in `arena`, which must outlive the engine as
+// the functions defined keep pointing to their declarations. The tokens
+// point into the source, so it must be kept in the arena too. The same goes
+// for the modules and their loader.
+template <typename Engine>
+auto run(Engine& engine, Arena& arena, ModuleLoader& modules,
+         const Options& options, std::string_view source) -> bool {
+  Scanner scanner{source};
+  Parser parser{scanner, arena};
+  Optimizer optimizer{arena};
+
+  bool ok = true;
+  if (options.memoize_pure) {
     std::vector<Stmt> statements = parser.parse();
+    ok = parser.well_formed() &&
+         execute(engine, arena, modules, optimizer, options,
+                 arena.list(std::move(statements)));
+  } else {
+    std::vector<Stmt> batch{};
+    while (auto statement = parser.next()) {
+      if (!parser.well_formed()) break;
+      if (is_import(*statement) && !batch.empty() && !is_import(batch.back())) {
+        ok = execute(engine, arena, modules, optimizer, options,
+                     arena.list(std::exchange(batch, {})));
+        if (!ok) break;
+      }
+      batch.emplace_back(std::move(statement.value()));
+      if (batch.size() < BATCH_SIZE) continue;
 
-    Interpreter interpreter{};
-    Resolver resolver{interpreter};
-    resolver.resolve(statements);
-    return interpreter.interpret(statements);
-  } catch (const ParserError& err) {
-    report(err.token.line, "", err.msg);
-  } catch (const RuntimeError& err) {
-    report(err.token.line, "", err.msg);
+      ok = execute(engine, arena, modules, optimizer, options,
+                   arena.list(std::exchange(batch, {})));
+      if (!ok) break;
+    }
+    if (ok && !batch.empty())
+      ok = execute(engine, arena, modules, optimizer, options,
+                   arena.list(std::move(batch)));
+
+    if (!parser.well_formed()) {
+      while (parser.next().has_value()) continue;
+      ok = false;
+    }
   }
 
-  return 1;
+  report_optimizer(optimizer, options);
+  return ok;
 }
 
-auto run_prompt() -> int {
-  Interpreter interpreter{};
+template <typename Engine>
+auto run_file(const std::string_view& file, const Options& options) -> int {
+  std::string error{};
+  auto source = SourceFile::load(std::string{file}, error);
+  if (!source.has_value()) {
+    fmt::print(stderr, "Could not read {}: {}\n", file, error);
+    return EX_NOINPUT;
+  }
+
+  Arena arena{};
+  // The file stays loaded as long as the arena, the scanner reads it in place
+  std::string_view text = arena.make<SourceFile>(std::move(*source))->text();
+  ModuleLoader modules{file, options.jobs};
+  Engine engine{options.max_call_depth};
+  return run(engine, arena, modules, options, text) ? EX_OK : EX_SOFTWARE;
+}
+
+template <typename Engine>
+auto run_prompt(Options options) -> int {
+  Arena arena{};
+  // Imports are relative to the working directory
+  ModuleLoader modules{{}, options.jobs};
+  Engine engine{options.max_call_depth};
+
+  // Purity is decided for the whole program, but a later line could still
+  // reassign a function, so nothing is memoized in the prompt
+  options.memoize_pure = false;
 
   std::string input;
 
   while (true) {
     fmt::print("> ");
-    std::getline(std::cin, input);
+    if (!std::getline(std::cin, input)) return 0;
 
     if (input.length() > 0) {
-      run(interpreter, input);
+      run(engine, arena, modules, options, arena.keep(std::move(input)));
     }
   }
 }
 
 int main(int argc, char** argv) {
-  if (argc > 2) {
+  bool use_vm = false;
+  Options options{};
+  std::vector<std::string_view> args{};
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg{argv[i]};
+    if (arg == "--engine=vm") {
+      use_vm = true;
+    } else if (arg == "--engine=tree") {
+      use_vm = false;
+    } else if (arg == "--opt=0" || arg == "--opt=1") {
+      options.opt_level = arg.back() - '0';
+    } else if (arg == "--stats") {
+      options.stats = true;
+    } else if (arg == "--memoize-pure") {
+      options.memoize_pure = true;
+    } else if (parse_flag(arg, "--max-call-depth=", options.max_call_depth)) {
+      continue;
+    } else if (parse_flag(arg, "--jobs=", options.jobs)) {
+      continue;
+    } else if (arg.starts_with("--")) {
+      fmt::print("{}\n", USAGE);
+      return EX_USAGE;
+    } else {
+      args.emplace_back(arg);
+    }
+  }
+
+  if (args.size() > 1) {
     fmt::print("{}\n", USAGE);
     return EX_USAGE;
-  } else if (argc == 2) {
-    return run_file(argv[1]);
-  } else {
-    return run_prompt();
+  } else if (use_vm) {
+    return args.size() == 1 ? run_file<VM>(args[0], options)
+                            : run_prompt<VM>(options);
   }
+
+  // The tree-walking interpreter runs on a thread with enough stack for the
+  // calls it allows
+  return run_with_stack(native_stack_size(options.max_call_depth), [&] {
+    return args.size() == 1 ? run_file<Interpreter>(args[0], options)
+                            : run_prompt<Interpreter>(options);
+  });
 }
@@ -0,0 +1,373 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <sysexits.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../interpreter/Compiler.h"
+#include "../interpreter/Interpreter.h"
+#include "../interpreter/Module.h"
+#include "../interpreter/NativeStack.h"
+#include "../interpreter/Optimizer.h"
+#include "../interpreter/Parser.h"
+#include "../interpreter/Percentile.h"
+#include "../interpreter/Resolver.h"
+#include "../interpreter/Scanner.h"
+#include "../interpreter/SourceFile.h"
+#include "../interpreter/VM.h"
+#include "Flags.h"
+
+static const auto USAGE =
+    "Usage: loxalone_bench [--engine=tree|vm] [--opt=0|1] [--warmup=N] "
+    "[--runs=N] [--jobs=N] [--json] [script or directory...]\n";
+
+using namespace loxalone;
+namespace fs = std::filesystem;
+
+using Clock = std::chrono::steady_clock;
+
+// Phases of running a script, in the order they are run. The script is
+// loaded from disk again for every run, and so are the modules it imports,
+// which are loaded, scanned, parsed and resolved in the link phase. The
+// tree-walking interpreter resolves the statements, the VM compiles them
+// instead. The optimizer is timed as part of that phase.
+enum class Phase { LOAD, SCAN, PARSE, LINK, RESOLVE, RUN, TOTAL };
+
+static constexpr Phase PHASES[] = {Phase::LOAD, Phase::SCAN,    Phase::PARSE,
+                                   Phase::LINK, Phase::RESOLVE, Phase::RUN,
+                                   Phase::TOTAL};
+
+auto phase_name(Phase phase, bool use_vm) -> std::string_view {
+  switch (phase) {
+    case Phase::LOAD:
+      return "load";
+    case Phase::SCAN:
+      return "scan";
+    case Phase::PARSE:
+      return "parse";
+    case Phase::LINK:
+      return "link";
+    case Phase::RESOLVE:
+      return use_vm ? "compile" : "resolve";
+    case Phase::RUN:
+      return "run";
+    case Phase::TOTAL:
+      return "total";
+  }
+  return "";
+}
+
+// Durations of each phase of a single run, in milliseconds
+using Sample = std::map<Phase, double>;
+
+struct Stats {
+  double min, median, p90, p99, max;
+};
+
+struct Workload {
+  std::string name;
+  std::string path;
+  size_t bytes;
+  std::vector<Sample> samples;
+  bool ok = true;
+};
+
+// Silences the standard output while it's alive, so `print` statements of
+// the benchmarks don't end up in the report
+class QuietStdout {
+ public:
+  QuietStdout() {
+    std::fflush(stdout);
+    saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+  }
+
+  ~QuietStdout() {
+    std::fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+  }
+
+ private:
+  int saved;
+};
+
+auto elapsed_ms(Clock::time_point since) -> double {
+  return std::chrono::duration<double, std::milli>(Clock::now() - since)
+      .count();
+}
+
+// Runs the script once, returns false if it fails to run to completion
+template <typename Engine>
+auto run_once(const std::string& path, size_t opt_level, size_t jobs,
+              Sample& sample) -> bool {
+  Arena arena{};
+  ModuleLoader modules{path, jobs};
+  Engine engine{};
+
+  auto start = Clock::now();
+  auto phase_start = start;
+  auto end_phase = [&](Phase phase) {
+    sample[phase] = elapsed_ms(phase_start);
+    phase_start = Clock::now();
+  };
+
+  std::string error{};
+  auto source = SourceFile::load(path, error);
+  if (!source.has_value()) {
+    fmt::print(stderr, "Could not read {}: {}\n", path, error);
+    return false;
+  }
+  std::string_view text = arena.make<SourceFile>(std::move(*source))->text();
+  end_phase(Phase::LOAD);
+
+  Scanner scanner{text};
+  // The tokens are scanned ahead of parsing here, to time the two separately
+  std::optional<std::vector<Token>> tokens{scanner.scan_tokens()};
+  if (!tokens.has_value()) return false;
+  end_phase(Phase::SCAN);
+
+  Parser parser{tokens.value(), arena};
+  List<Stmt> statements = arena.list(parser.parse());
+  if (!parser.well_formed()) return false;
+  end_phase(Phase::PARSE);
+
+  auto optimize = [&](List<Stmt> stmts) {
+    return opt_level < 1 ? stmts : Optimizer{arena}.optimize(stmts);
+  };
+
+  auto loaded = modules.load(statements);
+  if (!loaded.has_value()) return false;
+  for (Module* module : *loaded)
+    module->statements = optimize(module->statements);
+  end_phase(Phase::LINK);
+
+  bool ok = false;
+  try {
+    if constexpr (std::is_same_v<Engine, VM>) {
+      Compiler compiler{engine};
+      auto function = compiler.compile(optimize(statements));
+      end_phase(Phase::RESOLVE);
+
+      QuietStdout quiet{};
+      ok = engine.execute(std::move(function));
+    } else {
+      Resolver resolver{};
+      resolver.resolve(statements);
+      List<Stmt> optimized = optimize(statements);
+      end_phase(Phase::RESOLVE);
+
+      QuietStdout quiet{};
+      ok = engine.interpret(optimized);
+    }
+    end_phase(Phase::RUN);
+  } catch (const RuntimeError& err) {
+    report(err.token.line, "", err.msg);
+    return false;
+  }
+
+  sample[Phase::TOTAL] = elapsed_ms(start);
+  return ok;
+}
+
+// Loading or scanning speed in MB/s, for a median time in milliseconds
+auto throughput(const Workload& workload, double median_ms) -> double {
+  return static_cast<double>(workload.bytes) / 1e3 / median_ms;
+}
+
+auto stats_of(const std::vector<Sample>& samples, Phase phase) -> Stats {
+  std::vector<double> values{};
+  for (const auto& sample : samples) values.emplace_back(sample.at(phase));
+  std::sort(values.begin(), values.end());
+
+  return Stats{values.front(), median(values), percentile(values, 90),
+               percentile(values, 99), values.back()};
+}
+
+// Collects the scripts to run, directories are expanded to the `.lox` files
+// inside of them in alphabetical order
+auto collect_scripts(const std::vector<std::string_view>& args)
+    -> std::optional<std::vector<fs::path>> {
+  std::vector<fs::path> scripts{};
+  for (const auto& arg : args) {
+    fs::path path{arg};
+    if (fs::is_directory(path)) {
+      std::vector<fs::path> found{};
+      for (const auto& entry : fs::directory_iterator{path}) {
+        if (entry.path().extension() == ".lox") found.emplace_back(entry);
+      }
+      std::sort(found.begin(), found.end());
+      scripts.insert(scripts.end(), found.begin(), found.end());
+    } else if (fs::exists(path)) {
+      scripts.emplace_back(path);
+    } else {
+      fmt::print(stderr, "No such file or directory: {}\n", arg);
+      return std::nullopt;
+    }
+  }
+  return scripts;
+}
+
+auto print_table(const std::vector<Workload>& workloads, bool use_vm,
+                 size_t runs) -> void {
+  fmt::print("engine: {}, runs: {}, times in ms\n\n", use_vm ? "vm" : "tree",
+             runs);
+  fmt::print("{:<20} {:<8} {:>10} {:>10} {:>10} {:>10} {:>10} {:>10}\n",
+             "workload", "phase", "min", "median", "p90", "p99", "max",
+             "MB/s");
+  for (const auto& workload : workloads) {
+    if (!workload.ok) {
+      fmt::print("{:<20} failed\n", workload.name);
+      continue;
+    }
+    for (Phase phase : PHASES) {
+      Stats s = stats_of(workload.samples, phase);
+      fmt::print(
+          "{:<20} {:<8} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}",
+          phase == Phase::LOAD ? workload.name : "", phase_name(phase, use_vm),
+          s.min, s.median, s.p90, s.p99, s.max);
+      if (phase == Phase::LOAD || phase == Phase::SCAN)
+        fmt::print(" {:>10.1f}", throughput(workload, s.median));
+      fmt::print("\n");
+    }
+  }
+}
+
+// Returns the text as a quoted JSON string
+auto json_string(std::string_view text) -> std::string {
+  std::string quoted{"\""};
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      quoted += '\\';
+      quoted += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      quoted += fmt::format("\\u{:04x}", static_cast<int>(c));
+    } else {
+      quoted += c;
+    }
+  }
+  quoted += '"';
+  return quoted;
+}
+
+auto print_json(const std::vector<Workload>& workloads, bool use_vm,
+                size_t warmup, size_t runs) -> void {
+  fmt::print("{{\"engine\": \"{}\", \"warmup\": {}, \"runs\": {}, "
+             "\"unit\": \"ms\", \"workloads\": [",
+             use_vm ? "vm" : "tree", warmup, runs);
+  for (size_t i = 0; i < workloads.size(); i++) {
+    const auto& workload = workloads[i];
+    fmt::print("{}\n  {{\"name\": {}, \"ok\": {}, \"bytes\": {}",
+               i == 0 ? "" : ",", json_string(workload.name), workload.ok,
+               workload.bytes);
+    if (workload.ok) {
+      fmt::print(", \"phases\": {{");
+      for (Phase phase : PHASES) {
+        Stats s = stats_of(workload.samples, phase);
+        fmt::print("{}{}: {{\"min\": {:.4f}, \"median\": {:.4f}, "
+                   "\"p90\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f}}}",
+                   phase == Phase::LOAD ? "" : ", ",
+                   json_string(phase_name(phase, use_vm)),
+                   s.min, s.median, s.p90, s.p99, s.max);
+      }
+      fmt::print("}}");
+    }
+    fmt::print("}}");
+  }
+  fmt::print("\n]}}\n");
+}
+
+template <typename Engine>
+auto bench(std::vector<Workload>& workloads, size_t opt_level, size_t jobs,
+           size_t warmup, size_t runs) -> void {
+  for (auto& workload : workloads) {
+    fmt::print(stderr, "running {}\n", workload.name);
+    for (size_t i = 0; i < warmup + runs && workload.ok; i++) {
+      Sample sample{};
+      workload.ok = run_once<Engine>(workload.path, opt_level, jobs, sample);
+      if (i >= warmup) workload.samples.emplace_back(std::move(sample));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  bool use_vm = false, json = false;
+  size_t opt_level = 0, warmup = 1, runs = 5;
+  size_t jobs = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  std::vector<std::string_view> args{};
+
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg{argv[i]};
+    if (arg == "--engine=vm") {
+      use_vm = true;
+    } else if (arg == "--engine=tree") {
+      use_vm = false;
+    } else if (arg == "--json") {
+      json = true;
+    } else if (parse_flag(arg, "--opt=", opt_level, 0) ||
+               parse_flag(arg, "--warmup=", warmup, 0) ||
+               parse_flag(arg, "--runs=", runs) ||
+               parse_flag(arg, "--jobs=", jobs)) {
+      continue;
+    } else if (arg.starts_with("--")) {
+      fmt::print(stderr, "{}", USAGE);
+      return EX_USAGE;
+    } else {
+      args.emplace_back(arg);
+    }
+  }
+
+  if (opt_level > 1) {
+    fmt::print(stderr, "{}", USAGE);
+    return EX_USAGE;
+  }
+  if (args.empty()) args.emplace_back("bench");
+
+  auto scripts = collect_scripts(args);
+  if (!scripts.has_value()) return EX_NOINPUT;
+
+  std::vector<Workload> workloads{};
+  for (const auto& script : scripts.value()) {
+    std::string error{};
+    auto source = SourceFile::load(script.string(), error);
+    if (!source.has_value()) {
+      fmt::print(stderr, "Could not read {}: {}\n", script.string(), error);
+      return EX_NOINPUT;
+    }
+    workloads.emplace_back(Workload{script.stem().string(), script.string(),
+                                    source->text().size(), {}});
+  }
+
+  if (use_vm) {
+    bench<VM>(workloads, opt_level, jobs, warmup, runs);
+  } else {
+    run_with_stack(native_stack_size(DEFAULT_MAX_CALL_DEPTH), [&] {
+      bench<Interpreter>(workloads, opt_level, jobs, warmup, runs);
+      return 0;
+    });
+  }
+
+  if (json) {
+    print_json(workloads, use_vm, warmup, runs);
+  } else {
+    print_table(workloads, use_vm, runs);
+  }
+
+  bool all_ok = std::all_of(workloads.begin(), workloads.end(),
+                            [](const auto& w) { return w.ok; });
+  return all_ok ? EX_OK : EX_SOFTWARE;
+}
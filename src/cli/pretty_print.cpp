@@ -9,9 +9,10 @@
 using namespace loxalone;
 
 int main() {
-  Expr expr = Binary::create(Literal::create(2.0),
-                             Token{TokenType::PLUS, "+", std::nullopt, 1},
-                             Literal::create(2.0));
+  Arena arena{};
+  Expr expr = Binary::create(arena, Literal::create(arena, 2.0),
+                             Token{TokenType::PLUS, "+", 1},
+                             Literal::create(arena, 2.0));
 
   PrettyPrinter printer{};
   std::cout << visit<std::string>(printer, expr) << "\n";
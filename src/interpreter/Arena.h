@@ -0,0 +1,126 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_ARENA_H
+#define LOXALONE_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace loxalone {
+
+// List is an immutable sequence of values living in an arena
+template <typename T>
+using List = std::span<const T>;
+
+/*
+ * Arena is a bump allocator for the syntax tree. Nodes are placed one after
+ * another in large blocks, so creating a node is a pointer increment and the
+ * whole tree is released at once when the arena is destroyed. Objects that
+ * need their destructors run (e.g. literals holding values) are recorded and
+ * destroyed together with the arena, everything else is just dropped.
+ *
+ * Objects allocated by the arena live as long as the arena itself, so the
+ * arena must outlive everything that refers to the tree.
+ * */
+class Arena {
+ public:
+  Arena() = default;
+  Arena(const Arena&) = delete;
+  auto operator=(const Arena&) -> Arena& = delete;
+
+  ~Arena() {
+    for (auto it = finalizers.rbegin(); it != finalizers.rend(); ++it) {
+      it->destroy(it->object, it->count);
+    }
+  }
+
+  // Constructs an object of type T inside the arena
+  template <typename T, typename... Args>
+  auto make(Args&&... args) -> T* {
+    T* object = new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>)
+      finalizers.emplace_back(Finalizer{&destroy<T>, object, 1});
+    return object;
+  }
+
+  // Moves the items into the arena and returns them as a list
+  template <typename T>
+  auto list(std::vector<T>&& items) -> List<T> {
+    if (items.empty()) return {};
+
+    auto* data = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+    std::uninitialized_move(items.begin(), items.end(), data);
+    if constexpr (!std::is_trivially_destructible_v<T>)
+      finalizers.emplace_back(Finalizer{&destroy<T>, data, items.size()});
+    return {data, items.size()};
+  }
+
+  // Keeps the source alive as long as the arena, the tokens and the tree refer
+  // to it
+  auto keep(std::string&& source) -> std::string_view {
+    return *sources.emplace_back(
+        std::make_unique<const std::string>(std::move(source)));
+  }
+
+  // Number of bytes handed out by the arena so far
+  auto allocated() const -> size_t { return allocated_m; }
+
+ private:
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  struct Finalizer {
+    void (*destroy)(void*, size_t);
+    void* object;
+    size_t count;
+  };
+
+  template <typename T>
+  static auto destroy(void* object, size_t count) -> void {
+    std::destroy_n(static_cast<T*>(object), count);
+  }
+
+  auto allocate(size_t size, size_t align) -> void* {
+    auto offset = reinterpret_cast<uintptr_t>(cursor) % align;
+    size_t padding = offset == 0 ? 0 : align - offset;
+
+    if (cursor == nullptr ||
+        padding + size > static_cast<size_t>(limit - cursor)) {
+      // Objects larger than a block get a block of their own
+      size_t block_size = std::max(size + align, BLOCK_SIZE);
+      blocks.emplace_back(new std::byte[block_size]);
+      cursor = blocks.back().get();
+      limit = cursor + block_size;
+
+      offset = reinterpret_cast<uintptr_t>(cursor) % align;
+      padding = offset == 0 ? 0 : align - offset;
+    }
+
+    std::byte* result = cursor + padding;
+    cursor = result + size;
+    allocated_m += size;
+    return result;
+  }
+
+  std::vector<std::unique_ptr<std::byte[]>> blocks;
+  std::byte* cursor = nullptr;
+  std::byte* limit = nullptr;
+  std::vector<Finalizer> finalizers;
+  std::vector<std::unique_ptr<const std::string>> sources;
+  size_t allocated_m = 0;
+};
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_ARENA_H
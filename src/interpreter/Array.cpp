@@ -0,0 +1,110 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Array.h"
+
+#include <new>
+
+#include "ArrayKernels.h"
+#include "Native.h"
+
+namespace loxalone {
+
+namespace {
+
+// 32 GiB of numbers, larger arrays are most likely a mistake
+constexpr size_t MAX_ARRAY_SIZE = 1ull << 32;
+
+auto is_size(double value) -> bool {
+  return value >= 0 && value <= static_cast<double>(1ull << 48) &&
+         value == static_cast<double>(static_cast<size_t>(value));
+}
+
+auto check_same_size(const ArrayObj& left, const ArrayObj& right) -> void {
+  if (left.values.size() != right.values.size())
+    throw NativeError{"Arrays must have the same length."};
+}
+
+auto check_not_empty(const ArrayObj& array) -> void {
+  if (array.values.empty()) throw NativeError{"Array must not be empty."};
+}
+
+// An array of `size` zeros
+auto make_array(double size) -> Value {
+  if (size > static_cast<double>(MAX_ARRAY_SIZE))
+    throw NativeError{"Array size too large."};
+  if (!is_size(size))
+    throw NativeError{"Array size must be a non-negative integer."};
+  try {
+    return make_ref<ArrayObj>(static_cast<size_t>(size));
+  } catch (const std::bad_alloc&) {
+    throw NativeError{"Array size too large."};
+  }
+}
+
+auto sum(const ArrayObj& array) -> double {
+  return array_kernels().sum(array.values.data(), array.values.size());
+}
+
+auto dot(const ArrayObj& left, const ArrayObj& right) -> double {
+  check_same_size(left, right);
+  return array_kernels().dot(left.values.data(), right.values.data(),
+                             left.values.size());
+}
+
+auto min(const ArrayObj& array) -> double {
+  check_not_empty(array);
+  return array_kernels().min(array.values.data(), array.values.size());
+}
+
+auto max(const ArrayObj& array) -> double {
+  check_not_empty(array);
+  return array_kernels().max(array.values.data(), array.values.size());
+}
+
+// A new array with every element of `array` multiplied by `factor`
+auto scale(const ArrayObj& array, double factor) -> Value {
+  auto result = make_ref<ArrayObj>(array.values.size());
+  array_kernels().scale(result->values.data(), array.values.data(), factor,
+                        array.values.size());
+  return result;
+}
+
+// A new array with the element-wise sums of `left` and `right`
+auto add(const ArrayObj& left, const ArrayObj& right) -> Value {
+  check_same_size(left, right);
+  auto result = make_ref<ArrayObj>(left.values.size());
+  array_kernels().add(result->values.data(), left.values.data(),
+                      right.values.data(), left.values.size());
+  return result;
+}
+
+// Sets every element of `array` to `value`
+auto fill(ArrayObj& array, double value) -> void {
+  array_kernels().fill(array.values.data(), value, array.values.size());
+}
+
+// A copy of the elements from `from` up to but not including `to`
+auto slice(const ArrayObj& array, double from, double to) -> Value {
+  if (!is_size(from) || !is_size(to))
+    throw NativeError{"Slice bounds must be non-negative integers."};
+  if (from > to || to > static_cast<double>(array.values.size()))
+    throw NativeError{"Slice out of bounds."};
+
+  auto begin = array.values.begin() + static_cast<ptrdiff_t>(from);
+  auto end = array.values.begin() + static_cast<ptrdiff_t>(to);
+  return make_ref<ArrayObj>(std::vector<double>{begin, end});
+}
+
+}  // namespace
+
+auto array_natives() -> std::vector<Ref<NativeCallable>> {
+  return {make_native<&make_array>("Array"), make_native<&sum>("sum"),
+          make_native<&dot>("dot"),          make_native<&min>("min"),
+          make_native<&max>("max"),          make_native<&scale>("scale"),
+          make_native<&add>("add"),          make_native<&fill>("fill"),
+          make_native<&slice>("slice")};
+}
+
+}  // namespace loxalone
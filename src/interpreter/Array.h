@@ -0,0 +1,34 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_ARRAY_H
+#define LOXALONE_ARRAY_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "LoxCallable.h"
+#include "Value.h"
+
+namespace loxalone {
+
+// ArrayObj is a fixed size array of numbers, created by the `Array` native.
+// The numbers are stored unboxed and next to each other, so the builtins
+// working on whole arrays can use the SIMD kernels.
+class ArrayObj : public Obj {
+ public:
+  explicit ArrayObj(size_t size) : Obj{ObjType::ARRAY}, values(size) {}
+  explicit ArrayObj(std::vector<double> values)
+      : Obj{ObjType::ARRAY}, values{std::move(values)} {}
+
+  std::vector<double> values;
+};
+
+// The natives working on arrays
+auto array_natives() -> std::vector<Ref<NativeCallable>>;
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_ARRAY_H
@@ -0,0 +1,296 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "ArrayKernels.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <cmath>
+#include <limits>
+
+namespace loxalone {
+
+namespace {
+
+auto sum_scalar(const double* values, size_t size) -> double {
+  double total = 0;
+  for (size_t i = 0; i < size; i++) total += values[i];
+  return total;
+}
+
+auto dot_scalar(const double* left, const double* right, size_t size)
+    -> double {
+  double total = 0;
+  for (size_t i = 0; i < size; i++) total += left[i] * right[i];
+  return total;
+}
+
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+// The min and max of `result` and the values from `from` on, which is how the
+// vectorized kernels handle the remaining elements too
+auto min_from(const double* values, size_t from, size_t size, double result)
+    -> double {
+  for (size_t i = from; i < size; i++) {
+    if (std::isnan(values[i])) return NaN;
+    result = values[i] < result ? values[i] : result;
+  }
+  return result;
+}
+
+auto max_from(const double* values, size_t from, size_t size, double result)
+    -> double {
+  for (size_t i = from; i < size; i++) {
+    if (std::isnan(values[i])) return NaN;
+    result = values[i] > result ? values[i] : result;
+  }
+  return result;
+}
+
+auto min_scalar(const double* values, size_t size) -> double {
+  return min_from(values, 0, size, values[0]);
+}
+
+auto max_scalar(const double* values, size_t size) -> double {
+  return max_from(values, 0, size, values[0]);
+}
+
+auto scale_scalar(double* out, const double* values, double factor,
+                  size_t size) -> void {
+  for (size_t i = 0; i < size; i++) out[i] = values[i] * factor;
+}
+
+auto add_scalar(double* out, const double* left, const double* right,
+                size_t size) -> void {
+  for (size_t i = 0; i < size; i++) out[i] = left[i] + right[i];
+}
+
+auto fill_scalar(double* out, double value, size_t size) -> void {
+  for (size_t i = 0; i < size; i++) out[i] = value;
+}
+
+constexpr ArrayKernels SCALAR{"scalar",    &sum_scalar,   &dot_scalar,
+                              &min_scalar, &max_scalar,   &scale_scalar,
+                              &add_scalar, &fill_scalar};
+
+#if defined(__x86_64__)
+
+// SSE2 is part of x86-64, so these need no check. The loops handle two
+// vectors at a time, the remaining elements are handled one by one. The
+// min and max instructions return the second operand if either is NaN, so
+// `min` and `max` collect the lanes that are NaN on the side.
+
+auto hsum(__m128d vector) -> double {
+  return _mm_cvtsd_f64(_mm_add_sd(vector, _mm_unpackhi_pd(vector, vector)));
+}
+
+auto sum_sse2(const double* values, size_t size) -> double {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_loadu_pd(values + i));
+    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(values + i + 2));
+  }
+  double total = hsum(_mm_add_pd(acc0, acc1));
+  for (; i < size; i++) total += values[i];
+  return total;
+}
+
+auto dot_sse2(const double* left, const double* right, size_t size)
+    -> double {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(left + i),
+                                       _mm_loadu_pd(right + i)));
+    acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(left + i + 2),
+                                       _mm_loadu_pd(right + i + 2)));
+  }
+  double total = hsum(_mm_add_pd(acc0, acc1));
+  for (; i < size; i++) total += left[i] * right[i];
+  return total;
+}
+
+auto min_sse2(const double* values, size_t size) -> double {
+  __m128d acc = _mm_set1_pd(values[0]);
+  __m128d nan = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    __m128d vector = _mm_loadu_pd(values + i);
+    acc = _mm_min_pd(acc, vector);
+    nan = _mm_or_pd(nan, _mm_cmpunord_pd(vector, vector));
+  }
+  if (_mm_movemask_pd(nan) != 0) return NaN;
+  double result = _mm_cvtsd_f64(_mm_min_sd(acc, _mm_unpackhi_pd(acc, acc)));
+  return min_from(values, i, size, result);
+}
+
+auto max_sse2(const double* values, size_t size) -> double {
+  __m128d acc = _mm_set1_pd(values[0]);
+  __m128d nan = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    __m128d vector = _mm_loadu_pd(values + i);
+    acc = _mm_max_pd(acc, vector);
+    nan = _mm_or_pd(nan, _mm_cmpunord_pd(vector, vector));
+  }
+  if (_mm_movemask_pd(nan) != 0) return NaN;
+  double result = _mm_cvtsd_f64(_mm_max_sd(acc, _mm_unpackhi_pd(acc, acc)));
+  return max_from(values, i, size, result);
+}
+
+auto scale_sse2(double* out, const double* values, double factor, size_t size)
+    -> void {
+  __m128d k = _mm_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(values + i), k));
+  for (; i < size; i++) out[i] = values[i] * factor;
+}
+
+auto add_sse2(double* out, const double* left, const double* right,
+              size_t size) -> void {
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(left + i),
+                                      _mm_loadu_pd(right + i)));
+  for (; i < size; i++) out[i] = left[i] + right[i];
+}
+
+auto fill_sse2(double* out, double value, size_t size) -> void {
+  __m128d v = _mm_set1_pd(value);
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) _mm_storeu_pd(out + i, v);
+  for (; i < size; i++) out[i] = value;
+}
+
+constexpr ArrayKernels SSE2{"sse2",    &sum_sse2,   &dot_sse2,
+                            &min_sse2, &max_sse2,   &scale_sse2,
+                            &add_sse2, &fill_sse2};
+
+// The AVX versions are compiled for AVX regardless of the flags of the build,
+// they are only called after checking that the CPU supports it
+
+#define LOXALONE_AVX __attribute__((target("avx")))
+
+LOXALONE_AVX auto hsum(__m256d vector) -> double {
+  return hsum(_mm_add_pd(_mm256_castpd256_pd128(vector),
+                         _mm256_extractf128_pd(vector, 1)));
+}
+
+LOXALONE_AVX auto sum_avx(const double* values, size_t size) -> double {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(values + i));
+    acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(values + i + 4));
+  }
+  double total = hsum(_mm256_add_pd(acc0, acc1));
+  for (; i < size; i++) total += values[i];
+  return total;
+}
+
+LOXALONE_AVX auto dot_avx(const double* left, const double* right,
+                          size_t size) -> double {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(left + i),
+                                             _mm256_loadu_pd(right + i)));
+    acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(left + i + 4),
+                                             _mm256_loadu_pd(right + i + 4)));
+  }
+  double total = hsum(_mm256_add_pd(acc0, acc1));
+  for (; i < size; i++) total += left[i] * right[i];
+  return total;
+}
+
+LOXALONE_AVX auto min_avx(const double* values, size_t size) -> double {
+  __m256d acc = _mm256_set1_pd(values[0]);
+  __m256d nan = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256d vector = _mm256_loadu_pd(values + i);
+    acc = _mm256_min_pd(acc, vector);
+    nan = _mm256_or_pd(nan, _mm256_cmp_pd(vector, vector, _CMP_UNORD_Q));
+  }
+  if (_mm256_movemask_pd(nan) != 0) return NaN;
+  __m128d half = _mm_min_pd(_mm256_castpd256_pd128(acc),
+                            _mm256_extractf128_pd(acc, 1));
+  double result = _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+  return min_from(values, i, size, result);
+}
+
+LOXALONE_AVX auto max_avx(const double* values, size_t size) -> double {
+  __m256d acc = _mm256_set1_pd(values[0]);
+  __m256d nan = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256d vector = _mm256_loadu_pd(values + i);
+    acc = _mm256_max_pd(acc, vector);
+    nan = _mm256_or_pd(nan, _mm256_cmp_pd(vector, vector, _CMP_UNORD_Q));
+  }
+  if (_mm256_movemask_pd(nan) != 0) return NaN;
+  __m128d half = _mm_max_pd(_mm256_castpd256_pd128(acc),
+                            _mm256_extractf128_pd(acc, 1));
+  double result = _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+  return max_from(values, i, size, result);
+}
+
+LOXALONE_AVX auto scale_avx(double* out, const double* values, double factor,
+                            size_t size) -> void {
+  __m256d k = _mm256_set1_pd(factor);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(values + i), k));
+  for (; i < size; i++) out[i] = values[i] * factor;
+}
+
+LOXALONE_AVX auto add_avx(double* out, const double* left,
+                          const double* right, size_t size) -> void {
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(left + i),
+                                            _mm256_loadu_pd(right + i)));
+  for (; i < size; i++) out[i] = left[i] + right[i];
+}
+
+LOXALONE_AVX auto fill_avx(double* out, double value, size_t size) -> void {
+  __m256d v = _mm256_set1_pd(value);
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) _mm256_storeu_pd(out + i, v);
+  for (; i < size; i++) out[i] = value;
+}
+
+#undef LOXALONE_AVX
+
+constexpr ArrayKernels AVX{"avx",    &sum_avx,   &dot_avx,
+                           &min_avx, &max_avx,   &scale_avx,
+                           &add_avx, &fill_avx};
+
+#endif
+
+}  // namespace
+
+auto array_kernels() -> const ArrayKernels& {
+  static const ArrayKernels& kernels = *supported_array_kernels().back();
+  return kernels;
+}
+
+auto supported_array_kernels() -> std::vector<const ArrayKernels*> {
+  std::vector<const ArrayKernels*> kernels{&SCALAR};
+#if defined(__x86_64__)
+  kernels.push_back(&SSE2);
+  if (__builtin_cpu_supports("avx")) kernels.push_back(&AVX);
+#endif
+  return kernels;
+}
+
+}  // namespace loxalone
@@ -0,0 +1,46 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_ARRAYKERNELS_H
+#define LOXALONE_ARRAYKERNELS_H
+
+#include <cstddef>
+#include <vector>
+
+namespace loxalone {
+
+/*
+ * ArrayKernels are the bulk operations on arrays of doubles. There is a plain
+ * C++ version of every kernel, and on x86-64 an SSE2 and an AVX version too.
+ * The fastest set the CPU supports is picked the first time the kernels are
+ * used, so the binary still runs on CPUs without AVX.
+ *
+ * The vectorized sums add the elements in a few interleaved running totals,
+ * so the result may differ from a left to right sum in the last bits. A NaN
+ * among the elements makes `min` and `max` NaN, like it makes the sum NaN.
+ * */
+struct ArrayKernels {
+  const char* name;
+
+  double (*sum)(const double* values, size_t size);
+  double (*dot)(const double* left, const double* right, size_t size);
+  // Both of these require at least one element
+  double (*min)(const double* values, size_t size);
+  double (*max)(const double* values, size_t size);
+
+  // `out` may be the same as one of the inputs
+  void (*scale)(double* out, const double* values, double factor, size_t size);
+  void (*add)(double* out, const double* left, const double* right,
+              size_t size);
+  void (*fill)(double* out, double value, size_t size);
+};
+
+// Returns the kernels for the running CPU
+auto array_kernels() -> const ArrayKernels&;
+// Returns every set of kernels the running CPU supports, slowest first
+auto supported_array_kernels() -> std::vector<const ArrayKernels*>;
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_ARRAYKERNELS_H
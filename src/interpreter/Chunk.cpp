@@ -0,0 +1,34 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Chunk.h"
+
+namespace loxalone {
+
+auto Chunk::write(uint8_t byte, int line) -> void {
+  code.push_back(byte);
+  lines.push_back(line);
+}
+
+auto Chunk::write(OpCode op, int line) -> void {
+  write(static_cast<uint8_t>(op), line);
+}
+
+auto Chunk::add_constant(Value value) -> int {
+  constants.emplace_back(std::move(value));
+  return static_cast<int>(constants.size() - 1);
+}
+
+auto Chunk::add_function(std::shared_ptr<const VmFunction> function) -> int {
+  functions.emplace_back(std::move(function));
+  return static_cast<int>(functions.size() - 1);
+}
+
+auto Chunk::add_cache() -> int {
+  caches.emplace_back();
+  method_caches.emplace_back();
+  return static_cast<int>(caches.size() - 1);
+}
+
+}  // namespace loxalone
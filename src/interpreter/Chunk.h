@@ -0,0 +1,132 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_CHUNK_H
+#define LOXALONE_CHUNK_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Memo.h"
+#include "Shape.h"
+#include "Token.h"
+
+namespace loxalone {
+
+// Instruction set of the bytecode VM. Operands follow the opcode in the
+// instruction stream, multi-byte operands are stored in big-endian order.
+enum class OpCode : uint8_t {
+  CONSTANT,       // u16 constant index
+  NIL,
+  TRUE,
+  FALSE,
+  POP,
+  GET_LOCAL,      // u8 stack slot
+  SET_LOCAL,      // u8 stack slot
+  GET_GLOBAL,     // u16 global index
+  DEFINE_GLOBAL,  // u16 global index
+  SET_GLOBAL,     // u16 global index
+  GET_UPVALUE,    // u8 upvalue index
+  SET_UPVALUE,    // u8 upvalue index
+  EQUAL,
+  NOT_EQUAL,
+  GREATER,
+  GREATER_EQUAL,
+  LESS,
+  LESS_EQUAL,
+  ADD,
+  SUBTRACT,
+  MULTIPLY,
+  DIVIDE,
+  NOT,
+  NEGATE,
+  PRINT,
+  JUMP,           // u16 forward offset
+  JUMP_IF_FALSE,  // u8 Condition, u16 forward offset, pops the condition
+  AND,            // u16 forward offset, jumps if the operand is false
+  OR,             // u16 forward offset, jumps if the operand is true
+  LOOP,           // u16 backward offset
+  CALL,           // u8 argument count
+  TAIL_CALL,      // u8 argument count, reuses the frame of the caller
+  CLOSURE,        // u16 function index, then (u8 UpvalueFrom, u8 index) pairs
+  CLOSE_UPVALUE,
+  RETURN,
+  CLASS,          // u16 constant index of the class name
+  GET_PROPERTY,   // u16 constant index of the name, u16 cache index
+  SET_PROPERTY,   // u16 constant index of the name, u16 cache index
+  GET_INDEX,
+  SET_INDEX,
+  BUILD_LIST,     // u16 element count
+  BUILD_MAP,      // u16 entry count, the keys and values are interleaved
+  ITERATE,        // pushes the position and version of a for-in loop
+  FOR_IN,         // u8 stack slot of the iterable, u16 forward offset
+  INVOKE,         // u16 constant index of the name, u16 cache index, u8 argc
+  TAIL_INVOKE,    // same as INVOKE, reuses the frame of the caller
+  INHERIT,        // copies the superclass methods into the class on top
+  METHOD,         // u16 constant index of the method name
+  GET_SUPER,      // u16 constant index of the name, u16 cache index
+  SUPER_INVOKE,   // u16 constant index of the name, u16 cache index, u8 argc
+  IMPORT,         // u16 function index of the module, runs it the first time
+};
+
+// Where a closure created by CLOSURE gets each of its upvalues from, either
+// a stack slot of the current frame or an upvalue of the current closure.
+// NONE leaves the upvalue empty, it's the place the compiler keeps for a
+// local function in case it has to capture the variable holding itself.
+enum class UpvalueFrom : uint8_t { ENCLOSING, LOCAL, NONE };
+
+// The kind of statement a conditional jump belongs to, only used to report
+// the same runtime errors as the tree-walking interpreter.
+enum class Condition : uint8_t { IF, WHILE };
+
+class Module;
+struct VmFunction;
+
+// Chunk is a sequence of bytecode together with its constant pool. The line
+// of the source code is recorded for every byte for error reporting.
+class Chunk {
+ public:
+  auto write(uint8_t byte, int line) -> void;
+  auto write(OpCode op, int line) -> void;
+
+  // Adds a value to the constant pool and returns its index
+  auto add_constant(Value value) -> int;
+  // Adds a compiled function to the chunk and returns its index
+  auto add_function(std::shared_ptr<const VmFunction> function) -> int;
+  // Adds the inline caches for a property access and returns their index,
+  // the same index is used for both kinds of caches
+  auto add_cache() -> int;
+
+  std::vector<uint8_t> code;
+  std::vector<int> lines;
+  std::vector<Value> constants;
+  std::vector<std::shared_ptr<const VmFunction>> functions;
+
+  // Inline caches are updated while the chunk runs, even though compiled
+  // functions are otherwise immutable
+  mutable std::vector<PropertyCache> caches;
+  mutable std::vector<MethodCache> method_caches;
+};
+
+// VmFunction is the compiled form of a lox function declaration (or of the
+// top-level script). It's immutable once compiled and shared by all closures
+// created from it.
+struct VmFunction {
+  std::string name;
+  int arity = 0;
+  int upvalue_count = 0;
+  Chunk chunk;
+  // Set for pure functions whose results are cached, owned by the arena of
+  // the declaration
+  MemoTable* memo = nullptr;
+  // The imported module the function is compiled from, null for the main
+  // script
+  const Module* module = nullptr;
+};
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_CHUNK_H
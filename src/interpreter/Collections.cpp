@@ -0,0 +1,236 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Collections.h"
+
+#include <fmt/format.h>
+
+#include "Array.h"
+#include "Native.h"
+
+namespace loxalone {
+
+auto MapObj::find(const StringObj* key) const -> const Value* {
+  if (table.empty()) return nullptr;
+
+  int32_t entry = table[probe(key)].entry;
+  if (entry == -1) return nullptr;
+  return &items[entry].value;
+}
+
+auto MapObj::set(const Value& key, Value value) -> void {
+  StringObj* string = key.as_string_obj();
+  size_t bucket = 0;
+  if (!table.empty()) {
+    bucket = probe(string);
+    if (int32_t entry = table[bucket].entry; entry != -1) {
+      items[entry].value = std::move(value);
+      return;
+    }
+  }
+
+  // Removed entries keep their buckets until the table grows, so they count
+  // towards the load
+  if ((items.size() + 1) * 4 > table.size() * 3) {
+    grow();
+    bucket = probe(string);
+  }
+
+  table[bucket] = Bucket{static_cast<int32_t>(items.size()), string->hash};
+  items.emplace_back(Entry{Value{string}, std::move(value)});
+  live++;
+  version++;
+}
+
+auto MapObj::remove(const StringObj* key) -> bool {
+  if (table.empty()) return false;
+
+  int32_t entry = table[probe(key)].entry;
+  if (entry == -1) return false;
+
+  // The bucket still points to the entry, so probing continues past it
+  items[entry] = Entry{};
+  live--;
+  version++;
+  return true;
+}
+
+auto MapObj::probe(const StringObj* key) const -> size_t {
+  size_t mask = table.size() - 1;
+  for (size_t i = key->hash & mask;; i = (i + 1) & mask) {
+    const Bucket& bucket = table[i];
+    if (bucket.entry == -1) return i;
+    if (bucket.hash != key->hash) continue;
+
+    const Value& existing = items[bucket.entry].key;
+    if (existing.is_string() && existing.as<StringObj>() == key) return i;
+  }
+}
+
+auto MapObj::grow() -> void {
+  size_t capacity = table.empty() ? 8 : table.size();
+  while ((live + 1) * 2 > capacity) capacity *= 2;
+
+  std::vector<Entry> compacted{};
+  compacted.reserve(live + 1);
+  for (auto& entry : items) {
+    if (!entry.key.is_nil()) compacted.emplace_back(std::move(entry));
+  }
+  items = std::move(compacted);
+
+  table.assign(capacity, Bucket{-1, 0});
+  for (size_t i = 0; i < items.size(); i++) {
+    const auto* key = items[i].key.as<StringObj>();
+    table[probe(key)] = Bucket{static_cast<int32_t>(i), key->hash};
+  }
+}
+
+namespace {
+
+// Returns the position of `index` in an array or list of the given size
+auto position(const Value& index, size_t size) -> size_t {
+  if (!index.is_number()) throw NativeError{"Index must be a number."};
+
+  double value = index.as_number();
+  if (!(value >= 0 && value < static_cast<double>(size)))
+    throw NativeError{"Index out of bounds."};
+  if (value != static_cast<double>(static_cast<size_t>(value)))
+    throw NativeError{"Index must be an integer."};
+  return static_cast<size_t>(value);
+}
+
+auto key_of(const Value& index) -> const StringObj* {
+  if (!index.is_string()) throw NativeError{"Map keys must be strings."};
+  return index.as_string_obj();
+}
+
+}  // namespace
+
+auto get_element(const Value& object, const Value& index) -> Value {
+  if (object.is_array()) {
+    const auto& values = object.as<ArrayObj>()->values;
+    return values[position(index, values.size())];
+  }
+  if (object.is_list()) {
+    const auto& values = object.as<ListObj>()->values;
+    return values[position(index, values.size())];
+  }
+  if (object.is_map()) {
+    const auto* key = key_of(index);
+    if (const auto* value = object.as<MapObj>()->find(key)) return *value;
+    throw NativeError{fmt::format("Undefined key '{}'.", key->value)};
+  }
+  throw NativeError{"Only arrays, lists and maps can be indexed."};
+}
+
+auto set_element(const Value& object, const Value& index, Value value)
+    -> void {
+  if (object.is_array()) {
+    auto& values = object.as<ArrayObj>()->values;
+    size_t i = position(index, values.size());
+    if (!value.is_number())
+      throw NativeError{"Array elements must be numbers."};
+    values[i] = value.as_number();
+    return;
+  }
+  if (object.is_list()) {
+    auto& values = object.as<ListObj>()->values;
+    values[position(index, values.size())] = std::move(value);
+    return;
+  }
+  if (object.is_map()) {
+    key_of(index);
+    object.as<MapObj>()->set(index, std::move(value));
+    return;
+  }
+  throw NativeError{"Only arrays, lists and maps can be indexed."};
+}
+
+auto begin_iteration(const Value& iterable) -> uint32_t {
+  if (iterable.is_map()) return iterable.as<MapObj>()->version;
+  if (iterable.is_array() || iterable.is_list()) return 0;
+  throw NativeError{"Can only iterate over arrays, lists and maps."};
+}
+
+auto next_element(const Value& iterable, size_t& position, uint32_t version,
+                  Value& element) -> bool {
+  if (iterable.is_array()) {
+    const auto& values = iterable.as<ArrayObj>()->values;
+    if (position >= values.size()) return false;
+    element = Value{values[position++]};
+    return true;
+  }
+  if (iterable.is_list()) {
+    const auto& values = iterable.as<ListObj>()->values;
+    if (position >= values.size()) return false;
+    element = values[position++];
+    return true;
+  }
+
+  const auto* map = iterable.as<MapObj>();
+  if (map->version != version)
+    throw NativeError{"Map keys changed during iteration."};
+
+  const auto& entries = map->entries();
+  while (position < entries.size() && entries[position].key.is_nil())
+    position++;
+  if (position >= entries.size()) return false;
+  element = entries[position++].key;
+  return true;
+}
+
+namespace {
+
+auto length(const Value& value) -> double {
+  if (value.is_array())
+    return static_cast<double>(value.as<ArrayObj>()->values.size());
+  if (value.is_list())
+    return static_cast<double>(value.as<ListObj>()->values.size());
+  if (value.is_map()) return static_cast<double>(value.as<MapObj>()->size());
+  if (value.is_string())
+    return static_cast<double>(value.as_string_view().size());
+  throw NativeError{"Argument 1 must be an array, list, map or string."};
+}
+
+// Appends the value to the end of the list
+auto push(ListObj& list, Value value) -> void {
+  list.values.emplace_back(std::move(value));
+}
+
+// Removes the last element of the list and returns it
+auto pop(ListObj& list) -> Value {
+  if (list.values.empty()) throw NativeError{"List must not be empty."};
+  Value last = std::move(list.values.back());
+  list.values.pop_back();
+  return last;
+}
+
+auto has(const MapObj& map, const StringObj& key) -> bool {
+  return map.find(&key) != nullptr;
+}
+
+auto remove_key(MapObj& map, const StringObj& key) -> bool {
+  return map.remove(&key);
+}
+
+// A new list of the keys of the map, in insertion order
+auto keys(const MapObj& map) -> Value {
+  auto list = make_ref<ListObj>();
+  list->values.reserve(map.size());
+  for (const auto& entry : map.entries()) {
+    if (!entry.key.is_nil()) list->values.emplace_back(entry.key);
+  }
+  return list;
+}
+
+}  // namespace
+
+auto collection_natives() -> std::vector<Ref<NativeCallable>> {
+  return {make_native<&length>("len"),     make_native<&push>("push"),
+          make_native<&pop>("pop"),        make_native<&has>("has"),
+          make_native<&remove_key>("remove"),
+          make_native<&keys>("keys")};
+}
+
+}  // namespace loxalone
@@ -0,0 +1,112 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_COLLECTIONS_H
+#define LOXALONE_COLLECTIONS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "LoxCallable.h"
+#include "Value.h"
+
+namespace loxalone {
+
+// ListObj is a growable list of any values, created by a `[a, b, c]` literal
+class ListObj : public Obj {
+ public:
+  ListObj() : Obj{ObjType::LIST} {}
+  explicit ListObj(std::vector<Value> values)
+      : Obj{ObjType::LIST}, values{std::move(values)} {}
+
+  std::vector<Value> values;
+};
+
+/*
+ * MapObj maps strings to values, created by a `{"key": value}` literal. The
+ * entries are kept in insertion order in one vector, and an open addressing
+ * table with linear probing maps the keys to their position in it. A bucket
+ * stores the hash of its key next to the position, so probing past other keys
+ * rarely has to look at the entries. Strings are interned and hash themselves
+ * once, so a lookup costs no hashing and compares keys by address.
+ *
+ * Removing a key only clears its entry, the entries are compacted the next
+ * time the table grows.
+ * */
+class MapObj : public Obj {
+ public:
+  // A key and its value, `key` is nil once the entry was removed
+  struct Entry {
+    Value key;
+    Value value;
+  };
+
+  MapObj() : Obj{ObjType::MAP}, table{}, items{}, live{0} {}
+
+  // Returns the value of the key, or nullptr if the map doesn't have it
+  auto find(const StringObj* key) const -> const Value*;
+
+  // Sets the value of the key, which must be a string. A new key is added after
+  // all the others.
+  auto set(const Value& key, Value value) -> void;
+
+  // Removes the key, returns false if the map didn't have it
+  auto remove(const StringObj* key) -> bool;
+
+  auto size() const -> size_t { return live; }
+
+  // The entries in insertion order, including the removed ones
+  auto entries() const -> const std::vector<Entry>& { return items; }
+
+  // Changes whenever a key is added or removed, to detect changes while the
+  // map is iterated
+  uint32_t version = 0;
+
+ private:
+  // `entry` is the position of the entry in `items`, or -1 if it's empty
+  struct Bucket {
+    int32_t entry;
+    uint32_t hash;
+  };
+
+  // Returns the bucket of the key, or the empty bucket it would go into
+  auto probe(const StringObj* key) const -> size_t;
+  auto grow() -> void;
+
+  std::vector<Bucket> table;
+  std::vector<Entry> items;
+  size_t live;
+};
+
+// Returns `object[index]`. Throws a NativeError if the object can't be
+// indexed or doesn't have the index.
+auto get_element(const Value& object, const Value& index) -> Value;
+
+// Sets `object[index]` to the value, adding the key if `object` is a map.
+// Throws a NativeError like `get_element`.
+auto set_element(const Value& object, const Value& index, Value value)
+    -> void;
+
+// A for-in loop visits the elements of arrays and lists by position, so the
+// elements added to a list by the loop itself are visited too, and the keys of
+// maps in insertion order. Adding or removing keys of a map while it's
+// iterated is an error.
+//
+// Checks that the value can be iterated, and returns the version to pass to
+// `next_element`. Throws a NativeError otherwise.
+auto begin_iteration(const Value& iterable) -> uint32_t;
+
+// Stores the element at `position` or after it in `element` and moves
+// `position` past it. Returns false once there are no more elements.
+auto next_element(const Value& iterable, size_t& position, uint32_t version,
+                  Value& element) -> bool;
+
+// The natives working on lists and maps, and `len`
+auto collection_natives() -> std::vector<Ref<NativeCallable>>;
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_COLLECTIONS_H
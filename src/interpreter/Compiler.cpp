@@ -0,0 +1,765 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Compiler.h"
+
+#include <utility>
+
+#include "Error.h"
+
+namespace loxalone {
+
+static constexpr int MAX_LOCALS = 256;
+static constexpr int MAX_UPVALUES = 256;
+static constexpr int MAX_SHORT = 65535;
+
+auto Compiler::compile(List<Stmt> stmts)
+    -> std::shared_ptr<const VmFunction> {
+  FunctionState state{nullptr, std::make_shared<VmFunction>(),
+                      FunctionType::SCRIPT, {}, {}, 0};
+  state.function->name = "script";
+  state.function->module = module;
+  // Slot zero of every call frame holds the function being called
+  state.locals.emplace_back(Local{"", 0, false});
+  current = &state;
+
+  for (const auto &stmt : stmts) {
+    compile(stmt);
+  }
+  emit(OpCode::NIL);
+  emit(OpCode::RETURN);
+
+  current = nullptr;
+  return state.function;
+}
+
+auto Compiler::compile(const Stmt &stmt) -> void {
+  if (!stmt_is_null(stmt)) visit(*this, stmt);
+}
+
+auto Compiler::compile(const Expr &expr) -> void {
+  if (expr_is_null(expr)) {
+    emit(OpCode::NIL);
+  } else {
+    visit(*this, expr);
+  }
+}
+
+auto Compiler::operator()(const BinaryPtr &expr) -> void {
+  compile(expr->left_m);
+  compile(expr->right_m);
+
+  line_m = expr->oper_m.line;
+  switch (expr->oper_m.type) {
+    case TokenType::MINUS:
+      emit(OpCode::SUBTRACT);
+      break;
+    case TokenType::PLUS:
+      emit(OpCode::ADD);
+      break;
+    case TokenType::SLASH:
+      emit(OpCode::DIVIDE);
+      break;
+    case TokenType::STAR:
+      emit(OpCode::MULTIPLY);
+      break;
+    case TokenType::GREATER:
+      emit(OpCode::GREATER);
+      break;
+    case TokenType::GREATER_EQUAL:
+      emit(OpCode::GREATER_EQUAL);
+      break;
+    case TokenType::LESS:
+      emit(OpCode::LESS);
+      break;
+    case TokenType::LESS_EQUAL:
+      emit(OpCode::LESS_EQUAL);
+      break;
+    case TokenType::EQUAL_EQUAL:
+      emit(OpCode::EQUAL);
+      break;
+    case TokenType::BANG_EQUAL:
+      emit(OpCode::NOT_EQUAL);
+      break;
+    default:
+      // Mirrors the interpreter, unknown operators evaluate to nil
+      emit(OpCode::POP);
+      emit(OpCode::POP);
+      emit(OpCode::NIL);
+  }
+}
+
+auto Compiler::operator()(const GroupingPtr &expr) -> void {
+  compile(expr->expression_m);
+}
+
+auto Compiler::operator()(const LiteralPtr &expr) -> void {
+  if (expr->value_m.is_nil()) {
+    emit(OpCode::NIL);
+  } else if (expr->value_m.is_bool()) {
+    emit(expr->value_m.as_bool() ? OpCode::TRUE : OpCode::FALSE);
+  } else {
+    emit_constant(expr->value_m);
+  }
+}
+
+auto Compiler::operator()(const UnaryPtr &expr) -> void {
+  compile(expr->right_m);
+
+  line_m = expr->oper_m.line;
+  switch (expr->oper_m.type) {
+    case TokenType::MINUS:
+      emit(OpCode::NEGATE);
+      break;
+    case TokenType::BANG:
+      emit(OpCode::NOT);
+      break;
+    default:
+      emit(OpCode::POP);
+      emit(OpCode::NIL);
+  }
+}
+
+auto Compiler::operator()(const VariablePtr &expr) -> void {
+  emit_get(expr->name_m);
+}
+
+auto Compiler::emit_get(const Token &name) -> void {
+  line_m = name.line;
+
+  if (int slot = resolve_local(*current, name); slot != -1) {
+    emit(OpCode::GET_LOCAL);
+    emit(static_cast<uint8_t>(slot));
+  } else if (Local *local = find_self(*current, name)) {
+    local->self_uses.emplace_back(
+        SelfUse{&chunk(), chunk().code.size(), false});
+    emit(OpCode::GET_LOCAL);
+    emit(static_cast<uint8_t>(0));
+  } else if (int index = resolve_upvalue(*current, name, false); index != -1) {
+    emit(OpCode::GET_UPVALUE);
+    emit(static_cast<uint8_t>(index));
+  } else {
+    emit(OpCode::GET_GLOBAL);
+    emit_short(global(name));
+  }
+}
+
+auto Compiler::operator()(const AssignPtr &expr) -> void {
+  compile(expr->value_m);
+
+  const Token &name = expr->name_m;
+  line_m = name.line;
+
+  if (int slot = resolve_local(*current, name); slot != -1) {
+    current->locals[slot].assigned = true;
+    emit(OpCode::SET_LOCAL);
+    emit(static_cast<uint8_t>(slot));
+  } else if (int index = resolve_upvalue(*current, name, true); index != -1) {
+    emit(OpCode::SET_UPVALUE);
+    emit(static_cast<uint8_t>(index));
+  } else {
+    emit(OpCode::SET_GLOBAL);
+    emit_short(global(name));
+  }
+}
+
+auto Compiler::operator()(const LogicalPtr &expr) -> void {
+  compile(expr->left_m);
+
+  // The left operand stays on the stack as the result if it short-circuits,
+  // otherwise it's popped and the right operand becomes the result
+  line_m = expr->oper_m.line;
+  size_t end = emit_jump(expr->oper_m.type == TokenType::OR ? OpCode::OR
+                                                            : OpCode::AND);
+  compile(expr->right_m);
+  patch_jump(end);
+}
+
+auto Compiler::operator()(const CallPtr &expr) -> void {
+  // Only this call is in tail position, not the ones in its operands
+  bool tail = std::exchange(tail_call_m, false);
+
+  // Methods called right away are invoked without creating a bound method,
+  // the receiver takes the place of the callee on the stack
+  if (const auto *get = std::get_if<GetPtr>(&expr->callee_m); get && *get) {
+    compile((*get)->object_m);
+    for (const auto &arg : expr->arguments_m) {
+      compile(arg);
+    }
+
+    line_m = (*get)->name_m.line;
+    emit(tail ? OpCode::TAIL_INVOKE : OpCode::INVOKE);
+    emit_short(make_constant(Value{(*get)->name_m.lexeme}));
+    emit_short(make_cache());
+    emit(static_cast<uint8_t>(expr->arguments_m.size()));
+    return;
+  }
+
+  // Same for the methods of the superclass, which is pushed last
+  if (const auto *super = std::get_if<SuperPtr>(&expr->callee_m);
+      super && *super) {
+    const Token &keyword = (*super)->keyword_m;
+    check_super(keyword);
+    emit_get(Token{TokenType::THIS, "this", keyword.line});
+    for (const auto &arg : expr->arguments_m) {
+      compile(arg);
+    }
+    emit_get(keyword);
+
+    line_m = (*super)->method_m.line;
+    emit(OpCode::SUPER_INVOKE);
+    emit_short(make_constant(Value{(*super)->method_m.lexeme}));
+    emit_short(make_cache());
+    emit(static_cast<uint8_t>(expr->arguments_m.size()));
+    return;
+  }
+
+  compile(expr->callee_m);
+  for (const auto &arg : expr->arguments_m) {
+    compile(arg);
+  }
+
+  line_m = expr->paren_m.line;
+  emit(tail ? OpCode::TAIL_CALL : OpCode::CALL);
+  emit(static_cast<uint8_t>(expr->arguments_m.size()));
+}
+
+auto Compiler::operator()(const GetPtr &expr) -> void {
+  compile(expr->object_m);
+
+  line_m = expr->name_m.line;
+  emit(OpCode::GET_PROPERTY);
+  emit_short(make_constant(Value{expr->name_m.lexeme}));
+  emit_short(make_cache());
+}
+
+auto Compiler::operator()(const SetPtr &expr) -> void {
+  compile(expr->object_m);
+  compile(expr->value_m);
+
+  line_m = expr->name_m.line;
+  emit(OpCode::SET_PROPERTY);
+  emit_short(make_constant(Value{expr->name_m.lexeme}));
+  emit_short(make_cache());
+}
+
+auto Compiler::operator()(const IndexPtr &expr) -> void {
+  compile(expr->object_m);
+  compile(expr->index_m);
+
+  line_m = expr->bracket_m.line;
+  emit(OpCode::GET_INDEX);
+}
+
+auto Compiler::operator()(const SetIndexPtr &expr) -> void {
+  compile(expr->object_m);
+  compile(expr->index_m);
+  compile(expr->value_m);
+
+  line_m = expr->bracket_m.line;
+  emit(OpCode::SET_INDEX);
+}
+
+auto Compiler::operator()(const ListLiteralPtr &expr) -> void {
+  if (expr->elements_m.size() > MAX_SHORT)
+    throw RuntimeError{expr->bracket_m, "Too many elements in list literal."};
+  for (const auto &element : expr->elements_m) {
+    compile(element);
+  }
+
+  line_m = expr->bracket_m.line;
+  emit(OpCode::BUILD_LIST);
+  emit_short(static_cast<int>(expr->elements_m.size()));
+}
+
+auto Compiler::operator()(const MapLiteralPtr &expr) -> void {
+  if (expr->keys_m.size() > MAX_SHORT)
+    throw RuntimeError{expr->brace_m, "Too many entries in map literal."};
+  for (size_t i = 0; i < expr->keys_m.size(); i++) {
+    compile(expr->keys_m[i]);
+    compile(expr->values_m[i]);
+  }
+
+  line_m = expr->brace_m.line;
+  emit(OpCode::BUILD_MAP);
+  emit_short(static_cast<int>(expr->keys_m.size()));
+}
+
+auto Compiler::operator()(const SuperPtr &expr) -> void {
+  check_super(expr->keyword_m);
+  emit_get(Token{TokenType::THIS, "this", expr->keyword_m.line});
+  emit_get(expr->keyword_m);
+
+  line_m = expr->method_m.line;
+  emit(OpCode::GET_SUPER);
+  emit_short(make_constant(Value{expr->method_m.lexeme}));
+  emit_short(make_cache());
+}
+
+auto Compiler::operator()(const ThisPtr &expr) -> void {
+  if (current_class == nullptr)
+    throw RuntimeError{expr->keyword_m,
+                       "Can't use 'this' outside of a class."};
+  emit_get(expr->keyword_m);
+}
+
+auto Compiler::operator()(const BlockPtr &stmt) -> void {
+  begin_scope();
+  for (const auto &statement : stmt->statements_m) {
+    compile(statement);
+  }
+  end_scope();
+}
+
+auto Compiler::operator()(const ExpressionPtr &stmt) -> void {
+  compile(stmt->expression_m);
+  emit(OpCode::POP);
+}
+
+auto Compiler::operator()(const FunctionPtr &stmt) -> void {
+  declare(stmt->name_m);
+  // Functions can refer to themselves, so the name is usable right away
+  mark_initialized();
+  compile_function(stmt, FunctionType::FUNCTION);
+  define(stmt->name_m);
+}
+
+auto Compiler::operator()(const PrintPtr &stmt) -> void {
+  compile(stmt->expression_m);
+  emit(OpCode::PRINT);
+}
+
+auto Compiler::operator()(const VarPtr &stmt) -> void {
+  declare(stmt->name_m);
+  compile(stmt->initializer_m);
+  define(stmt->name_m);
+}
+
+auto Compiler::operator()(const IfPtr &stmt) -> void {
+  compile(stmt->expression_m);
+
+  line_m = stmt->token_m.line;
+  size_t then_jump = emit_jump(OpCode::JUMP_IF_FALSE);
+  compile(stmt->then_branch_m);
+
+  if (stmt_is_null(stmt->else_branch_m)) {
+    patch_jump(then_jump);
+    return;
+  }
+
+  size_t else_jump = emit_jump(OpCode::JUMP);
+  patch_jump(then_jump);
+  compile(stmt->else_branch_m);
+  patch_jump(else_jump);
+}
+
+auto Compiler::operator()(const WhilePtr &stmt) -> void {
+  size_t loop_start = chunk().code.size();
+  compile(stmt->condition_m);
+
+  line_m = stmt->token_m.line;
+  size_t exit_jump = emit_jump(OpCode::JUMP_IF_FALSE);
+  // JUMP_IF_FALSE carries the kind of the statement for error reporting
+  chunk().code[exit_jump - 1] = static_cast<uint8_t>(Condition::WHILE);
+
+  compile(stmt->body_m);
+  emit_loop(loop_start);
+  patch_jump(exit_jump);
+}
+
+auto Compiler::operator()(const ForInPtr &stmt) -> void {
+  begin_scope();
+  compile(stmt->iterable_m);
+  line_m = stmt->token_m.line;
+  emit(OpCode::ITERATE);
+
+  // The iterable and the state of the loop live in hidden locals, their names
+  // can't be written in lox
+  if (current->locals.size() + 3 > MAX_LOCALS)
+    throw RuntimeError{stmt->name_m, "Too many local variables in function."};
+  for (std::string_view name : {" iterable", " position", " version"}) {
+    current->locals.emplace_back(Local{name, current->scope_depth, false});
+  }
+  auto slot = static_cast<uint8_t>(current->locals.size() - 3);
+
+  size_t loop_start = chunk().code.size();
+  emit(OpCode::FOR_IN);
+  emit(slot);
+  emit_short(0xffff);
+  size_t exit_jump = chunk().code.size() - 2;
+
+  // The loop variable gets its own scope, so closures capture a fresh
+  // variable in every iteration
+  begin_scope();
+  declare(stmt->name_m);
+  mark_initialized();
+  compile(stmt->body_m);
+  end_scope();
+
+  emit_loop(loop_start);
+  patch_jump(exit_jump);
+  end_scope();
+}
+
+auto Compiler::operator()(const ReturnPtr &stmt) -> void {
+  if (current->type == FunctionType::SCRIPT)
+    throw RuntimeError{stmt->keyword_m, "Can't return from top-level code."};
+
+  if (current->type == FunctionType::INITIALIZER) {
+    if (!expr_is_null(stmt->value_m))
+      throw RuntimeError{stmt->keyword_m,
+                         "Can't return a value from an initializer."};
+    // Initializers always return `this`
+    emit(OpCode::GET_LOCAL);
+    emit(static_cast<uint8_t>(0));
+  } else {
+    // A call in tail position replaces the frame of the current function
+    // instead of pushing a new one, so tail recursion runs in constant space
+    const auto *call = std::get_if<CallPtr>(&stmt->value_m);
+    tail_call_m = call != nullptr && *call != nullptr;
+    compile(stmt->value_m);
+  }
+  line_m = stmt->keyword_m.line;
+  emit(OpCode::RETURN);
+}
+
+auto Compiler::operator()(const ClassPtr &stmt) -> void {
+  declare(stmt->name_m);
+  line_m = stmt->name_m.line;
+  emit(OpCode::CLASS);
+  emit_short(make_constant(Value{stmt->name_m.lexeme}));
+  define(stmt->name_m);
+
+  ClassState state{current_class, false};
+  current_class = &state;
+
+  // The superclass stays on the stack as the local `super` while the methods
+  // are compiled, so the methods using it capture it as an upvalue
+  if (!expr_is_null(stmt->superclass_m)) {
+    const auto &superclass = std::get<VariablePtr>(stmt->superclass_m);
+    if (superclass->name_m.lexeme == stmt->name_m.lexeme)
+      throw RuntimeError{superclass->name_m,
+                         "A class can't inherit from itself."};
+
+    compile(stmt->superclass_m);
+    begin_scope();
+    if (current->locals.size() >= MAX_LOCALS)
+      throw RuntimeError{stmt->name_m,
+                         "Too many local variables in function."};
+    current->locals.emplace_back(Local{"super", current->scope_depth, false});
+
+    emit_get(stmt->name_m);
+    line_m = superclass->name_m.line;
+    emit(OpCode::INHERIT);
+    state.has_superclass = true;
+  }
+
+  // The method table is filled while the class is on top of the stack
+  emit_get(stmt->name_m);
+  for (const auto &method : stmt->methods_m) {
+    compile_function(method, method->name_m.lexeme == "init"
+                                 ? FunctionType::INITIALIZER
+                                 : FunctionType::METHOD);
+    emit(OpCode::METHOD);
+    emit_short(make_constant(Value{method->name_m.lexeme}));
+  }
+  emit(OpCode::POP);
+
+  if (state.has_superclass) end_scope();
+  current_class = state.enclosing;
+}
+
+auto Compiler::operator()(const ImportPtr &stmt) -> void {
+  if (stmt->module_m == nullptr)
+    throw RuntimeError{stmt->keyword_m, "Module was not loaded."};
+
+  line_m = stmt->keyword_m.line;
+  emit(OpCode::IMPORT);
+  emit_short(chunk().add_function(vm.compile_module(*stmt->module_m)));
+  emit(OpCode::POP);
+}
+
+auto Compiler::compile_function(const FunctionPtr &stmt, FunctionType type)
+    -> void {
+  FunctionState state{current, std::make_shared<VmFunction>(), type, {}, {},
+                      0};
+  state.function->name = stmt->name_m.lexeme;
+  state.function->arity = static_cast<int>(stmt->params_m.size());
+  state.function->memo = stmt->memo_m;
+  state.function->module = module;
+  // The variable of a local function is declared right before it's compiled
+  if (type == FunctionType::FUNCTION && current->scope_depth > 0)
+    state.self = static_cast<int>(current->locals.size() - 1);
+  // Methods get `this` in the slot of the function being called
+  state.locals.emplace_back(
+      Local{type == FunctionType::FUNCTION ? "" : "this", 0, false});
+  current = &state;
+
+  // Parameters and the body share a scope, like in the resolver
+  begin_scope();
+  for (const auto &param : stmt->params_m) {
+    declare(param);
+    define(param);
+  }
+  for (const auto &statement : stmt->body_m) {
+    compile(statement);
+  }
+  if (type == FunctionType::INITIALIZER) {
+    emit(OpCode::GET_LOCAL);
+    emit(static_cast<uint8_t>(0));
+  } else {
+    emit(OpCode::NIL);
+  }
+  emit(OpCode::RETURN);
+
+  // The locals don't need to be popped, returning discards the whole frame.
+  // The local functions assigned after they were compiled still have to
+  // capture their variables though.
+  for (size_t i = 0; i < state.locals.size(); i++) {
+    Local &local = state.locals[i];
+    if (local.assigned && local.self_upvalue != -1)
+      capture_self(local, static_cast<int>(i));
+  }
+
+  // A function reading itself by its name either captures its variable now
+  // if it's assigned already, or keeps an upvalue for it in case it's
+  // assigned later
+  Local *self = state.self != -1 ? &current->enclosing->locals[state.self]
+                                 : nullptr;
+  bool keep_self = false;
+  if (self != nullptr && !self->self_uses.empty()) {
+    if (self->assigned) {
+      self->captured = true;
+      patch_self_uses(*self, add_upvalue(state,
+                                         static_cast<uint8_t>(state.self),
+                                         true));
+    } else {
+      keep_self = true;
+    }
+  }
+
+  current = state.enclosing;
+  int upvalue_count = static_cast<int>(state.upvalues.size()) + keep_self;
+  state.function->upvalue_count = upvalue_count;
+
+  line_m = stmt->name_m.line;
+  emit(OpCode::CLOSURE);
+  emit_short(chunk().add_function(state.function));
+  for (const auto &upvalue : state.upvalues) {
+    if (upvalue.is_self) {
+      auto &local = current->enclosing->locals[current->self];
+      local.self_uses.emplace_back(
+          SelfUse{&chunk(), chunk().code.size(), true});
+    }
+    emit(static_cast<uint8_t>(upvalue.is_local ? UpvalueFrom::LOCAL
+                                               : UpvalueFrom::ENCLOSING));
+    emit(upvalue.index);
+  }
+  if (keep_self) {
+    self->self_capture = chunk().code.size();
+    self->self_upvalue = upvalue_count - 1;
+    emit(static_cast<uint8_t>(UpvalueFrom::NONE));
+    emit(static_cast<uint8_t>(0));
+  }
+}
+
+auto Compiler::check_super(const Token &keyword) -> void {
+  if (current_class == nullptr)
+    throw RuntimeError{keyword, "Can't use 'super' outside of a class."};
+  if (!current_class->has_superclass)
+    throw RuntimeError{keyword,
+                       "Can't use 'super' in a class with no superclass."};
+}
+
+auto Compiler::declare(const Token &token) -> void {
+  if (current->scope_depth == 0) return;
+
+  for (auto it = current->locals.rbegin(); it != current->locals.rend();
+       ++it) {
+    if (it->depth != -1 && it->depth < current->scope_depth) break;
+    if (it->name == token.lexeme)
+      throw RuntimeError{token,
+                         "Already a variable with this name in this scope"};
+  }
+
+  if (current->locals.size() >= MAX_LOCALS)
+    throw RuntimeError{token, "Too many local variables in function."};
+  current->locals.emplace_back(Local{token.lexeme, -1, false});
+}
+
+auto Compiler::define(const Token &token) -> void {
+  if (current->scope_depth > 0) {
+    mark_initialized();
+    return;
+  }
+
+  line_m = token.line;
+  emit(OpCode::DEFINE_GLOBAL);
+  emit_short(global(token));
+}
+
+auto Compiler::mark_initialized() -> void {
+  if (current->scope_depth == 0) return;
+  current->locals.back().depth = current->scope_depth;
+}
+
+auto Compiler::resolve_local(FunctionState &state, const Token &name) -> int {
+  for (int i = static_cast<int>(state.locals.size()) - 1; i >= 0; i--) {
+    if (state.locals[i].name == name.lexeme) {
+      if (state.locals[i].depth == -1)
+        throw RuntimeError{name,
+                           "Can't read local variable in its own initializer."};
+      return i;
+    }
+  }
+  return -1;
+}
+
+auto Compiler::resolve_upvalue(FunctionState &state, const Token &name,
+                               bool assign) -> int {
+  if (state.enclosing == nullptr) return -1;
+
+  if (int local = resolve_local(*state.enclosing, name); local != -1) {
+    state.enclosing->locals[local].captured = true;
+    state.enclosing->locals[local].assigned |= assign;
+    return add_upvalue(state, static_cast<uint8_t>(local), true);
+  }
+
+  // A closure reading the function it's in captures the running closure
+  if (!assign && find_self(*state.enclosing, name) != nullptr)
+    return add_upvalue(state, 0, true, true);
+
+  if (int upvalue = resolve_upvalue(*state.enclosing, name, assign);
+      upvalue != -1) {
+    return add_upvalue(state, static_cast<uint8_t>(upvalue), false);
+  }
+
+  return -1;
+}
+
+auto Compiler::add_upvalue(FunctionState &state, uint8_t index, bool is_local,
+                           bool is_self) -> int {
+  for (int i = 0; i < state.upvalues.size(); i++) {
+    if (state.upvalues[i].index == index &&
+        state.upvalues[i].is_local == is_local &&
+        state.upvalues[i].is_self == is_self)
+      return i;
+  }
+
+  if (state.upvalues.size() >= MAX_UPVALUES)
+    throw RuntimeError{Token{TokenType::EOF_, "", line_m},
+                       "Too many closure variables in function."};
+  state.upvalues.emplace_back(UpvalueRef{index, is_local, is_self});
+  return static_cast<int>(state.upvalues.size() - 1);
+}
+
+auto Compiler::find_self(FunctionState &state, const Token &name) -> Local * {
+  if (state.self == -1) return nullptr;
+  Local &local = state.enclosing->locals[state.self];
+  if (local.assigned || local.name != name.lexeme) return nullptr;
+  return &local;
+}
+
+auto Compiler::patch_self_uses(Local &local, int index) -> void {
+  for (const auto &use : local.self_uses) {
+    auto &code = use.chunk->code;
+    code[use.offset] = use.is_capture
+                           ? static_cast<uint8_t>(UpvalueFrom::ENCLOSING)
+                           : static_cast<uint8_t>(OpCode::GET_UPVALUE);
+    code[use.offset + 1] = static_cast<uint8_t>(index);
+  }
+  local.self_uses.clear();
+}
+
+auto Compiler::capture_self(Local &local, int slot) -> void {
+  auto &code = chunk().code;
+  code[local.self_capture] = static_cast<uint8_t>(UpvalueFrom::LOCAL);
+  code[local.self_capture + 1] = static_cast<uint8_t>(slot);
+  patch_self_uses(local, local.self_upvalue);
+  local.self_upvalue = -1;
+  local.captured = true;
+}
+
+auto Compiler::begin_scope() -> void { current->scope_depth++; }
+
+auto Compiler::end_scope() -> void {
+  current->scope_depth--;
+
+  auto &locals = current->locals;
+  while (!locals.empty() && locals.back().depth > current->scope_depth) {
+    if (locals.back().assigned && locals.back().self_upvalue != -1)
+      capture_self(locals.back(), static_cast<int>(locals.size() - 1));
+    emit(locals.back().captured ? OpCode::CLOSE_UPVALUE : OpCode::POP);
+    locals.pop_back();
+  }
+}
+
+auto Compiler::chunk() -> Chunk & { return current->function->chunk; }
+
+auto Compiler::emit(OpCode op) -> void { chunk().write(op, line_m); }
+
+auto Compiler::emit(uint8_t byte) -> void { chunk().write(byte, line_m); }
+
+auto Compiler::emit_short(int value) -> void {
+  emit(static_cast<uint8_t>((value >> 8) & 0xff));
+  emit(static_cast<uint8_t>(value & 0xff));
+}
+
+auto Compiler::emit_constant(Value value) -> void {
+  emit(OpCode::CONSTANT);
+  emit_short(make_constant(std::move(value)));
+}
+
+// Emits a jump instruction with a placeholder offset and returns the position
+// of the offset, so it can be patched once the target is known
+auto Compiler::emit_jump(OpCode op) -> size_t {
+  emit(op);
+  if (op == OpCode::JUMP_IF_FALSE) emit(static_cast<uint8_t>(Condition::IF));
+  emit_short(0xffff);
+  return chunk().code.size() - 2;
+}
+
+auto Compiler::emit_loop(size_t start) -> void {
+  emit(OpCode::LOOP);
+
+  size_t offset = chunk().code.size() - start + 2;
+  if (offset > MAX_SHORT)
+    throw RuntimeError{Token{TokenType::EOF_, "", line_m},
+                       "Loop body too large."};
+  emit_short(static_cast<int>(offset));
+}
+
+auto Compiler::patch_jump(size_t offset) -> void {
+  size_t jump = chunk().code.size() - offset - 2;
+  if (jump > MAX_SHORT)
+    throw RuntimeError{Token{TokenType::EOF_, "", line_m},
+                       "Too much code to jump over."};
+
+  chunk().code[offset] = static_cast<uint8_t>((jump >> 8) & 0xff);
+  chunk().code[offset + 1] = static_cast<uint8_t>(jump & 0xff);
+}
+
+auto Compiler::make_constant(Value value) -> int {
+  int index = chunk().add_constant(std::move(value));
+  if (index > MAX_SHORT)
+    throw RuntimeError{Token{TokenType::EOF_, "", line_m},
+                       "Too many constants in one chunk."};
+  return index;
+}
+
+auto Compiler::global(const Token &name) -> int {
+  int index = vm.global_index(name.lexeme);
+  if (index > MAX_SHORT) throw RuntimeError{name, "Too many global variables."};
+  return index;
+}
+
+auto Compiler::make_cache() -> int {
+  int index = chunk().add_cache();
+  if (index > MAX_SHORT)
+    throw RuntimeError{Token{TokenType::EOF_, "", line_m},
+                       "Too many property accesses in one chunk."};
+  return index;
+}
+
+}  // namespace loxalone
@@ -0,0 +1,193 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_COMPILER_H
+#define LOXALONE_COMPILER_H
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "Chunk.h"
+#include "Expr.h"
+#include "Stmt.h"
+#include "Token.h"
+#include "VM.h"
+
+namespace loxalone {
+
+/*
+ * Compiler translates the statements produced by the parser into bytecode for
+ * the VM. Like the `Resolver`, it walks the tree once ahead of execution and
+ * reports the same static errors, but instead of recording scope distances it
+ * assigns every local variable a stack slot and every captured variable an
+ * upvalue index.
+ * */
+class Compiler {
+ public:
+  // `module` is the imported module being compiled, null for the main script
+  explicit Compiler(VM &vm, const Module *module = nullptr)
+      : vm{vm},
+        module{module},
+        current{nullptr},
+        current_class{nullptr},
+        tail_call_m{false},
+        line_m{0} {}
+
+  // Compiles the top-level statements into a function that takes no
+  // arguments, ready to be run by the VM
+  auto compile(List<Stmt>) -> std::shared_ptr<const VmFunction>;
+
+  // Expression visitor
+  auto operator()(const BinaryPtr &expr) -> void;
+  auto operator()(const GroupingPtr &expr) -> void;
+  auto operator()(const IndexPtr &expr) -> void;
+  auto operator()(const ListLiteralPtr &expr) -> void;
+  auto operator()(const LiteralPtr &expr) -> void;
+  auto operator()(const MapLiteralPtr &expr) -> void;
+  auto operator()(const UnaryPtr &expr) -> void;
+  auto operator()(const VariablePtr &expr) -> void;
+  auto operator()(const AssignPtr &expr) -> void;
+  auto operator()(const LogicalPtr &expr) -> void;
+  auto operator()(const CallPtr &expr) -> void;
+  auto operator()(const GetPtr &expr) -> void;
+  auto operator()(const SetPtr &expr) -> void;
+  auto operator()(const SetIndexPtr &expr) -> void;
+  auto operator()(const SuperPtr &expr) -> void;
+  auto operator()(const ThisPtr &expr) -> void;
+
+  // Statement visitors
+  auto operator()(const BlockPtr &stmt) -> void;
+  auto operator()(const ExpressionPtr &stmt) -> void;
+  auto operator()(const FunctionPtr &stmt) -> void;
+  auto operator()(const PrintPtr &stmt) -> void;
+  auto operator()(const VarPtr &stmt) -> void;
+  auto operator()(const IfPtr &stmt) -> void;
+  auto operator()(const WhilePtr &stmt) -> void;
+  auto operator()(const ForInPtr &stmt) -> void;
+  auto operator()(const ReturnPtr &stmt) -> void;
+  auto operator()(const ClassPtr &stmt) -> void;
+  auto operator()(const ImportPtr &stmt) -> void;
+
+ private:
+  enum class FunctionType { SCRIPT, FUNCTION, METHOD, INITIALIZER };
+
+  // A local function reading itself by its name, compiled as a read of the
+  // running closure in slot zero so that it doesn't capture the variable
+  // holding it, which would keep both alive forever. `offset` is where the
+  // two bytes of the read are in `chunk`, either a GET_LOCAL or the pair of a
+  // closure inside the function capturing slot zero.
+  //
+  // If the variable turns out to be assigned, the reads are patched to the
+  // upvalue of the function capturing the variable instead.
+  struct SelfUse {
+    Chunk *chunk;
+    size_t offset;
+    bool is_capture;
+  };
+
+  // A local variable living in a stack slot of the current function. `depth`
+  // is -1 while the variable initializer is being compiled.
+  //
+  // The variable of a local function keeps the reads of the function by its
+  // name. If it's assigned after the function is compiled, `self_capture` is
+  // the offset of the CLOSURE pair kept for capturing it, and `self_upvalue`
+  // the index of that upvalue.
+  struct Local {
+    std::string_view name;
+    int depth;
+    bool captured;
+    bool assigned = false;
+    std::vector<SelfUse> self_uses{};
+    size_t self_capture = 0;
+    int self_upvalue = -1;
+  };
+
+  struct UpvalueRef {
+    uint8_t index;
+    bool is_local;
+    // Slot zero of the enclosing function, which is the function itself
+    bool is_self = false;
+  };
+
+  // Compilation state of a single function, functions declared inside of it
+  // get their own state linked through `enclosing`
+  struct FunctionState {
+    FunctionState *enclosing;
+    std::shared_ptr<VmFunction> function;
+    FunctionType type;
+    std::vector<Local> locals;
+    std::vector<UpvalueRef> upvalues;
+    int scope_depth;
+    // Local of the enclosing function holding this one, -1 for the functions
+    // that aren't declared in a local scope
+    int self = -1;
+  };
+
+  // Compilation state of the class whose methods are being compiled
+  struct ClassState {
+    ClassState *enclosing;
+    bool has_superclass;
+  };
+
+  auto compile(const Stmt &) -> void;
+  auto compile(const Expr &) -> void;
+  auto compile_function(const FunctionPtr &, FunctionType) -> void;
+
+  // Variable resolution
+  auto emit_get(const Token &) -> void;
+  auto declare(const Token &) -> void;
+  auto define(const Token &) -> void;
+  auto mark_initialized() -> void;
+  auto resolve_local(FunctionState &, const Token &) -> int;
+  auto resolve_upvalue(FunctionState &, const Token &, bool assign) -> int;
+  auto add_upvalue(FunctionState &, uint8_t index, bool is_local,
+                   bool is_self = false) -> int;
+  // Returns the local of the enclosing function holding the current one if
+  // the name refers to it and it's never assigned so far
+  auto find_self(FunctionState &, const Token &) -> Local *;
+  // Turns the reads of a local function by its name into reads of the
+  // upvalue `index`
+  auto patch_self_uses(Local &, int index) -> void;
+  // Patches the CLOSURE pair kept for a local function that turned out to be
+  // assigned, so that it captures the variable in `slot`
+  auto capture_self(Local &, int slot) -> void;
+  auto check_super(const Token &keyword) -> void;
+
+  auto begin_scope() -> void;
+  auto end_scope() -> void;
+
+  // Bytecode emitting helpers
+  auto chunk() -> Chunk &;
+  auto emit(OpCode) -> void;
+  auto emit(uint8_t) -> void;
+  auto emit_short(int) -> void;
+  auto emit_constant(Value) -> void;
+  auto emit_jump(OpCode) -> size_t;
+  auto emit_loop(size_t start) -> void;
+  auto patch_jump(size_t offset) -> void;
+  auto make_constant(Value) -> int;
+  // Returns the index of the global variable, which must fit in an operand
+  auto global(const Token &name) -> int;
+  auto make_cache() -> int;
+
+  VM &vm;
+  const Module *module;
+  FunctionState *current;
+  ClassState *current_class;
+
+  // Set while the call of a return statement is compiled, the call is then
+  // compiled as a tail call
+  bool tail_call_m;
+
+  // Line of the last token seen, recorded with every emitted byte
+  int line_m;
+};
+
+static_assert(ExprVisitor<Compiler, void>);
+static_assert(StmtVisitor<Compiler, void>);
+}  // namespace loxalone
+
+#endif  // LOXALONE_COMPILER_H
@@ -5,41 +5,57 @@
 #ifndef LOXALONE_ENVIRONMENT_H
 #define LOXALONE_ENVIRONMENT_H
 
-#include <optional>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 
 #include "Token.h"
+#include "Value.h"
 
 namespace loxalone {
 
+// Hashes strings and string views alike, so a map keyed by strings can be
+// searched with the lexeme of a token without copying it
+struct StringHash {
+  using is_transparent = void;
+
+  auto operator()(std::string_view key) const -> size_t {
+    return std::hash<std::string_view>{}(key);
+  }
+};
+
+template <typename T>
+using StringMap =
+    std::unordered_map<std::string, T, StringHash, std::equal_to<>>;
+
 /*
- * Environment class represents the state of the interpreter. The variables
- * defined will be stored in this as a map.
+ * Environment class holds the global variables of the interpreter. Globals are
+ * late bound, so they are stored in a map keyed by their names. Local
+ * variables are resolved ahead of time and live in the call frames of the
+ * interpreter instead.
  * */
 class Environment {
  public:
-  explicit Environment(Environment *enclosing)
-      : values{}, enclosing{enclosing} {}
-  Environment() : Environment{nullptr} {}
+  Environment() : values{} {}
 
-  auto define(std::string_view key, lox_literal value) -> void;
-
-  auto get(const Token &) const -> const lox_literal &;
-  auto get_at(const Token &, int) const -> const lox_literal &;
-
-  auto assign(const Token &, lox_literal) -> void;
-  auto assign_at(const Token &token, int distance, lox_literal &&value) -> void;
+  auto define(std::string_view key, Value value) -> void;
+  auto get(const Token &) const -> const Value &;
+  auto assign(const Token &, Value) -> void;
 
  private:
-  // Returns the ancestor at the given distance
-  auto ancestor(int distance) const -> const Environment *;
+  StringMap<Value> values;
+};
 
-  mutable std::unordered_map<std::string, lox_literal> values;
+// Cell holds a local variable captured by a closure. The frame of the
+// declaring function and every closure capturing the variable share the same
+// cell, so an assignment made by any of them is seen by all of the others.
+class Cell : public Obj {
+ public:
+  explicit Cell(Value value) : Obj{ObjType::CELL}, value{std::move(value)} {}
 
-  // It's okay to use a pointer for the enclosing environment as the parent
-  // environment will ALWAYS be alive when the current scope is active.
-  Environment *enclosing;
+  Value value;
 };
 
 }
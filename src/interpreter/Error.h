@@ -8,7 +8,9 @@
 #include <fmt/format.h>
 
 #include <exception>
+#include <iterator>
 #include <string>
+#include <utility>
 
 #include "Token.h"
 
@@ -23,13 +25,56 @@ class RuntimeError : std::exception {
   const Token token;
 };
 
+// NativeError is thrown by native functions, which don't know where they are
+// called from. The engine making the call turns it into a RuntimeError.
+class NativeError : std::exception {
+ public:
+  explicit NativeError(std::string msg) : msg{std::move(msg)} {}
+
+  std::string msg;
+};
+
+// Where the errors reported on this thread go instead of stderr, if set
+inline thread_local std::string* captured_errors = nullptr;
+
+// ErrorCapture collects the errors reported on the current thread while it's
+// alive. Modules are scanned and parsed on several threads at once, their
+// errors are printed in order once all of them are loaded.
+class ErrorCapture {
+ public:
+  explicit ErrorCapture(std::string& errors)
+      : previous{std::exchange(captured_errors, &errors)} {}
+  ErrorCapture(const ErrorCapture&) = delete;
+  auto operator=(const ErrorCapture&) -> ErrorCapture& = delete;
+  ~ErrorCapture() { captured_errors = previous; }
+
+ private:
+  std::string* previous;
+};
+
 static auto report(int line, std::string_view where,
                    const std::string_view& msg) {
+  if (captured_errors != nullptr) {
+    fmt::format_to(std::back_inserter(*captured_errors),
+                   "[line {}] Error{}: {}\n", line, where, msg);
+    return;
+  }
   fmt::print(stderr, "[line {}] Error{}: {}\n", line, where, msg);
 }
 
 static auto error(int line, std::string_view msg) { report(line, "", msg); }
 
+// Report runtime error by printing to stderr, `module` is the path of the
+// imported module the error was raised in
+static auto report_error(const RuntimeError& err, std::string_view module = {})
+    -> void {
+  if (module.empty()) {
+    fmt::print(stderr, "{}\n[line {}]", err.msg, err.token.line);
+    return;
+  }
+  fmt::print(stderr, "{}\n[line {}] in {}", err.msg, err.token.line, module);
+}
+
 }
 
 #endif  // LOXALONE_ERROR_H
@@ -1,45 +1,63 @@
 #ifndef LOXALONE_Expr_H
 #define LOXALONE_Expr_H
 
-#include <memory>
 #include <vector>
 #include <string>
 #include <variant>
 
+#include "Arena.h"
 #include "Token.h"
 
+#include "Shape.h"
+#include "Slot.h"
 
 namespace loxalone {
 
 class Assign;
 class Binary;
 class Call;
+class Get;
 class Grouping;
+class Index;
+class ListLiteral;
 class Literal;
 class Logical;
+class MapLiteral;
+class Set;
+class SetIndex;
+class Super;
+class This;
 class Unary;
 class Variable;
 
-using AssignPtr = std::unique_ptr<Assign>;
-using BinaryPtr = std::unique_ptr<Binary>;
-using CallPtr = std::unique_ptr<Call>;
-using GroupingPtr = std::unique_ptr<Grouping>;
-using LiteralPtr = std::unique_ptr<Literal>;
-using LogicalPtr = std::unique_ptr<Logical>;
-using UnaryPtr = std::unique_ptr<Unary>;
-using VariablePtr = std::unique_ptr<Variable>;
-
-using Expr = std::variant<AssignPtr,BinaryPtr,CallPtr,GroupingPtr,LiteralPtr,LogicalPtr,UnaryPtr,VariablePtr>;
+using AssignPtr = Assign*;
+using BinaryPtr = Binary*;
+using CallPtr = Call*;
+using GetPtr = Get*;
+using GroupingPtr = Grouping*;
+using IndexPtr = Index*;
+using ListLiteralPtr = ListLiteral*;
+using LiteralPtr = Literal*;
+using LogicalPtr = Logical*;
+using MapLiteralPtr = MapLiteral*;
+using SetPtr = Set*;
+using SetIndexPtr = SetIndex*;
+using SuperPtr = Super*;
+using ThisPtr = This*;
+using UnaryPtr = Unary*;
+using VariablePtr = Variable*;
+
+using Expr = std::variant<AssignPtr,BinaryPtr,CallPtr,GetPtr,GroupingPtr,IndexPtr,ListLiteralPtr,LiteralPtr,LogicalPtr,MapLiteralPtr,SetPtr,SetIndexPtr,SuperPtr,ThisPtr,UnaryPtr,VariablePtr>;
 
 static auto expr_is_null(const Expr& expr) {
   return visit([](auto&& arg) -> bool { return arg == nullptr; }, expr);
 }
 
 template <typename T>
-concept IsExpr = std::same_as<T, AssignPtr> || std::same_as<T, BinaryPtr> || std::same_as<T, CallPtr> || std::same_as<T, GroupingPtr> || std::same_as<T, LiteralPtr> || std::same_as<T, LogicalPtr> || std::same_as<T, UnaryPtr> || std::same_as<T, VariablePtr>;
+concept IsExpr = std::same_as<T, AssignPtr> || std::same_as<T, BinaryPtr> || std::same_as<T, CallPtr> || std::same_as<T, GetPtr> || std::same_as<T, GroupingPtr> || std::same_as<T, IndexPtr> || std::same_as<T, ListLiteralPtr> || std::same_as<T, LiteralPtr> || std::same_as<T, LogicalPtr> || std::same_as<T, MapLiteralPtr> || std::same_as<T, SetPtr> || std::same_as<T, SetIndexPtr> || std::same_as<T, SuperPtr> || std::same_as<T, ThisPtr> || std::same_as<T, UnaryPtr> || std::same_as<T, VariablePtr>;
 
 template <typename V, typename Out>
-concept ExprVisitor = requires (V v, const AssignPtr& arg_0, const BinaryPtr& arg_1, const CallPtr& arg_2, const GroupingPtr& arg_3, const LiteralPtr& arg_4, const LogicalPtr& arg_5, const UnaryPtr& arg_6, const VariablePtr& arg_7) { 
+concept ExprVisitor = requires (V v, const AssignPtr& arg_0, const BinaryPtr& arg_1, const CallPtr& arg_2, const GetPtr& arg_3, const GroupingPtr& arg_4, const IndexPtr& arg_5, const ListLiteralPtr& arg_6, const LiteralPtr& arg_7, const LogicalPtr& arg_8, const MapLiteralPtr& arg_9, const SetPtr& arg_10, const SetIndexPtr& arg_11, const SuperPtr& arg_12, const ThisPtr& arg_13, const UnaryPtr& arg_14, const VariablePtr& arg_15) { 
   { v(arg_0) } -> std::convertible_to<Out>;
   { v(arg_1) } -> std::convertible_to<Out>;
   { v(arg_2) } -> std::convertible_to<Out>;
@@ -48,22 +66,31 @@ concept ExprVisitor = requires (V v, const AssignPtr& arg_0, const BinaryPtr& ar
   { v(arg_5) } -> std::convertible_to<Out>;
   { v(arg_6) } -> std::convertible_to<Out>;
   { v(arg_7) } -> std::convertible_to<Out>;
+  { v(arg_8) } -> std::convertible_to<Out>;
+  { v(arg_9) } -> std::convertible_to<Out>;
+  { v(arg_10) } -> std::convertible_to<Out>;
+  { v(arg_11) } -> std::convertible_to<Out>;
+  { v(arg_12) } -> std::convertible_to<Out>;
+  { v(arg_13) } -> std::convertible_to<Out>;
+  { v(arg_14) } -> std::convertible_to<Out>;
+  { v(arg_15) } -> std::convertible_to<Out>;
 };
 
 class Assign {
  public:
   const Token name_m;
   const Expr value_m;
+  Slot slot_m{};
 
   Assign(Token&& name, Expr&& value): name_m{std::move(name)}, value_m{std::move(value)} {}
   ~Assign() = default;
 
-  static auto create(Token&& name, Expr&& value) -> AssignPtr {
-    return std::make_unique<Assign>(std::move(name), std::move(value));
+  static auto create(Arena& arena, Token&& name, Expr&& value) -> AssignPtr {
+    return arena.make<Assign>(std::move(name), std::move(value));
   }
 
   static auto empty() -> Expr {
-    return std::unique_ptr<Assign>(nullptr);
+    return static_cast<AssignPtr>(nullptr);
   }
 
 };
@@ -77,12 +104,12 @@ class Binary {
   Binary(Expr&& left, Token&& oper, Expr&& right): left_m{std::move(left)}, oper_m{std::move(oper)}, right_m{std::move(right)} {}
   ~Binary() = default;
 
-  static auto create(Expr&& left, Token&& oper, Expr&& right) -> BinaryPtr {
-    return std::make_unique<Binary>(std::move(left), std::move(oper), std::move(right));
+  static auto create(Arena& arena, Expr&& left, Token&& oper, Expr&& right) -> BinaryPtr {
+    return arena.make<Binary>(std::move(left), std::move(oper), std::move(right));
   }
 
   static auto empty() -> Expr {
-    return std::unique_ptr<Binary>(nullptr);
+    return static_cast<BinaryPtr>(nullptr);
   }
 
 };
@@ -91,17 +118,37 @@ class Call {
  public:
   const Expr callee_m;
   const Token paren_m;
-  const std::vector<Expr> arguments_m;
+  const List<Expr> arguments_m;
 
-  Call(Expr&& callee, Token&& paren, std::vector<Expr>&& arguments): callee_m{std::move(callee)}, paren_m{std::move(paren)}, arguments_m{std::move(arguments)} {}
+  Call(Expr&& callee, Token&& paren, List<Expr>&& arguments): callee_m{std::move(callee)}, paren_m{std::move(paren)}, arguments_m{std::move(arguments)} {}
   ~Call() = default;
 
-  static auto create(Expr&& callee, Token&& paren, std::vector<Expr>&& arguments) -> CallPtr {
-    return std::make_unique<Call>(std::move(callee), std::move(paren), std::move(arguments));
+  static auto create(Arena& arena, Expr&& callee, Token&& paren, std::vector<Expr>&& arguments) -> CallPtr {
+    return arena.make<Call>(std::move(callee), std::move(paren), arena.list(std::move(arguments)));
+  }
+
+  static auto empty() -> Expr {
+    return static_cast<CallPtr>(nullptr);
+  }
+
+};
+
+class Get {
+ public:
+  const Expr object_m;
+  const Token name_m;
+  PropertyCache cache_m{};
+  MethodCache method_cache_m{};
+
+  Get(Expr&& object, Token&& name): object_m{std::move(object)}, name_m{std::move(name)} {}
+  ~Get() = default;
+
+  static auto create(Arena& arena, Expr&& object, Token&& name) -> GetPtr {
+    return arena.make<Get>(std::move(object), std::move(name));
   }
 
   static auto empty() -> Expr {
-    return std::unique_ptr<Call>(nullptr);
+    return static_cast<GetPtr>(nullptr);
   }
 
 };
@@ -113,29 +160,66 @@ class Grouping {
   explicit Grouping(Expr&& expression): expression_m{std::move(expression)} {}
   ~Grouping() = default;
 
-  static auto create(Expr&& expression) -> GroupingPtr {
-    return std::make_unique<Grouping>(std::move(expression));
+  static auto create(Arena& arena, Expr&& expression) -> GroupingPtr {
+    return arena.make<Grouping>(std::move(expression));
+  }
+
+  static auto empty() -> Expr {
+    return static_cast<GroupingPtr>(nullptr);
+  }
+
+};
+
+class Index {
+ public:
+  const Expr object_m;
+  const Token bracket_m;
+  const Expr index_m;
+
+  Index(Expr&& object, Token&& bracket, Expr&& index): object_m{std::move(object)}, bracket_m{std::move(bracket)}, index_m{std::move(index)} {}
+  ~Index() = default;
+
+  static auto create(Arena& arena, Expr&& object, Token&& bracket, Expr&& index) -> IndexPtr {
+    return arena.make<Index>(std::move(object), std::move(bracket), std::move(index));
   }
 
   static auto empty() -> Expr {
-    return std::unique_ptr<Grouping>(nullptr);
+    return static_cast<IndexPtr>(nullptr);
+  }
+
+};
+
+class ListLiteral {
+ public:
+  const Token bracket_m;
+  const List<Expr> elements_m;
+
+  ListLiteral(Token&& bracket, List<Expr>&& elements): bracket_m{std::move(bracket)}, elements_m{std::move(elements)} {}
+  ~ListLiteral() = default;
+
+  static auto create(Arena& arena, Token&& bracket, std::vector<Expr>&& elements) -> ListLiteralPtr {
+    return arena.make<ListLiteral>(std::move(bracket), arena.list(std::move(elements)));
+  }
+
+  static auto empty() -> Expr {
+    return static_cast<ListLiteralPtr>(nullptr);
   }
 
 };
 
 class Literal {
  public:
-  const lox_literal value_m;
+  const Value value_m;
 
-  explicit Literal(lox_literal&& value): value_m{std::move(value)} {}
+  explicit Literal(Value&& value): value_m{std::move(value)} {}
   ~Literal() = default;
 
-  static auto create(lox_literal&& value) -> LiteralPtr {
-    return std::make_unique<Literal>(std::move(value));
+  static auto create(Arena& arena, Value&& value) -> LiteralPtr {
+    return arena.make<Literal>(std::move(value));
   }
 
   static auto empty() -> Expr {
-    return std::unique_ptr<Literal>(nullptr);
+    return static_cast<LiteralPtr>(nullptr);
   }
 
 };
@@ -149,12 +233,110 @@ class Logical {
   Logical(Expr&& left, Token&& oper, Expr&& right): left_m{std::move(left)}, oper_m{std::move(oper)}, right_m{std::move(right)} {}
   ~Logical() = default;
 
-  static auto create(Expr&& left, Token&& oper, Expr&& right) -> LogicalPtr {
-    return std::make_unique<Logical>(std::move(left), std::move(oper), std::move(right));
+  static auto create(Arena& arena, Expr&& left, Token&& oper, Expr&& right) -> LogicalPtr {
+    return arena.make<Logical>(std::move(left), std::move(oper), std::move(right));
+  }
+
+  static auto empty() -> Expr {
+    return static_cast<LogicalPtr>(nullptr);
+  }
+
+};
+
+class MapLiteral {
+ public:
+  const Token brace_m;
+  const List<Expr> keys_m;
+  const List<Expr> values_m;
+
+  MapLiteral(Token&& brace, List<Expr>&& keys, List<Expr>&& values): brace_m{std::move(brace)}, keys_m{std::move(keys)}, values_m{std::move(values)} {}
+  ~MapLiteral() = default;
+
+  static auto create(Arena& arena, Token&& brace, std::vector<Expr>&& keys, std::vector<Expr>&& values) -> MapLiteralPtr {
+    return arena.make<MapLiteral>(std::move(brace), arena.list(std::move(keys)), arena.list(std::move(values)));
+  }
+
+  static auto empty() -> Expr {
+    return static_cast<MapLiteralPtr>(nullptr);
+  }
+
+};
+
+class Set {
+ public:
+  const Expr object_m;
+  const Token name_m;
+  const Expr value_m;
+  PropertyCache cache_m{};
+
+  Set(Expr&& object, Token&& name, Expr&& value): object_m{std::move(object)}, name_m{std::move(name)}, value_m{std::move(value)} {}
+  ~Set() = default;
+
+  static auto create(Arena& arena, Expr&& object, Token&& name, Expr&& value) -> SetPtr {
+    return arena.make<Set>(std::move(object), std::move(name), std::move(value));
+  }
+
+  static auto empty() -> Expr {
+    return static_cast<SetPtr>(nullptr);
+  }
+
+};
+
+class SetIndex {
+ public:
+  const Expr object_m;
+  const Token bracket_m;
+  const Expr index_m;
+  const Expr value_m;
+
+  SetIndex(Expr&& object, Token&& bracket, Expr&& index, Expr&& value): object_m{std::move(object)}, bracket_m{std::move(bracket)}, index_m{std::move(index)}, value_m{std::move(value)} {}
+  ~SetIndex() = default;
+
+  static auto create(Arena& arena, Expr&& object, Token&& bracket, Expr&& index, Expr&& value) -> SetIndexPtr {
+    return arena.make<SetIndex>(std::move(object), std::move(bracket), std::move(index), std::move(value));
+  }
+
+  static auto empty() -> Expr {
+    return static_cast<SetIndexPtr>(nullptr);
+  }
+
+};
+
+class Super {
+ public:
+  const Token keyword_m;
+  const Token method_m;
+  Slot slot_m{};
+  Slot receiver_m{};
+  MethodCache cache_m{};
+
+  Super(Token&& keyword, Token&& method): keyword_m{std::move(keyword)}, method_m{std::move(method)} {}
+  ~Super() = default;
+
+  static auto create(Arena& arena, Token&& keyword, Token&& method) -> SuperPtr {
+    return arena.make<Super>(std::move(keyword), std::move(method));
+  }
+
+  static auto empty() -> Expr {
+    return static_cast<SuperPtr>(nullptr);
+  }
+
+};
+
+class This {
+ public:
+  const Token keyword_m;
+  Slot slot_m{};
+
+  explicit This(Token&& keyword): keyword_m{std::move(keyword)} {}
+  ~This() = default;
+
+  static auto create(Arena& arena, Token&& keyword) -> ThisPtr {
+    return arena.make<This>(std::move(keyword));
   }
 
   static auto empty() -> Expr {
-    return std::unique_ptr<Logical>(nullptr);
+    return static_cast<ThisPtr>(nullptr);
   }
 
 };
@@ -167,12 +349,12 @@ class Unary {
   Unary(Token&& oper, Expr&& right): oper_m{std::move(oper)}, right_m{std::move(right)} {}
   ~Unary() = default;
 
-  static auto create(Token&& oper, Expr&& right) -> UnaryPtr {
-    return std::make_unique<Unary>(std::move(oper), std::move(right));
+  static auto create(Arena& arena, Token&& oper, Expr&& right) -> UnaryPtr {
+    return arena.make<Unary>(std::move(oper), std::move(right));
   }
 
   static auto empty() -> Expr {
-    return std::unique_ptr<Unary>(nullptr);
+    return static_cast<UnaryPtr>(nullptr);
   }
 
 };
@@ -180,16 +362,17 @@ class Unary {
 class Variable {
  public:
   const Token name_m;
+  Slot slot_m{};
 
   explicit Variable(Token&& name): name_m{std::move(name)} {}
   ~Variable() = default;
 
-  static auto create(Token&& name) -> VariablePtr {
-    return std::make_unique<Variable>(std::move(name));
+  static auto create(Arena& arena, Token&& name) -> VariablePtr {
+    return arena.make<Variable>(std::move(name));
   }
 
   static auto empty() -> Expr {
-    return std::unique_ptr<Variable>(nullptr);
+    return static_cast<VariablePtr>(nullptr);
   }
 
 };
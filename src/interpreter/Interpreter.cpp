@@ -4,216 +4,322 @@
 
 #include "Interpreter.h"
 
-#include <chrono>
-#include <memory>
+#include <algorithm>
 
+#include "Collections.h"
 #include "LiteralFormatter.h"
 #include "LoxCallable.h"
 #include "LoxClass.h"
+#include "LoxInstance.h"
+#include "Module.h"
+#include "NativeStack.h"
 
 namespace loxalone {
 
-Interpreter::Interpreter() : globals{}, env{&globals}, locals{} {
-  globals.define("clock", std::make_shared<NativeCallable>(
-                              "clock", 0, [](const auto& args) -> lox_literal {
-                                using namespace std::chrono;
-
-                                auto time =
-                                    system_clock::now().time_since_epoch();
-                                auto to_s = duration_cast<seconds>(time);
-                                return 1.0 * static_cast<double>(to_s.count());
-                              }));
-}
-
-// Report runtime scanner_error by printing to stderr
-auto report_error(const RuntimeError& err) -> void {
-  fmt::print(stderr, "{}\n[line {}]", err.msg, err.token.line);
-}
-
-auto is_equal(const lox_literal& left, const lox_literal& right) -> bool {
-  if (std::holds_alternative<double>(left) &&
-      std::holds_alternative<double>(right)) {
-    return std::get<double>(left) == std::get<double>(right);
-  } else if (std::holds_alternative<std::string>(left) &&
-             std::holds_alternative<std::string>(right)) {
-    return std::get<std::string>(left) == std::get<std::string>(right);
-  } else if (std::holds_alternative<bool>(left) &&
-             std::holds_alternative<bool>(right)) {
-    return std::get<bool>(left) == std::get<bool>(right);
-  } else if (std::holds_alternative<std::monostate>(left)) {
-    return std::holds_alternative<std::monostate>(right);
+static constexpr size_t STACK_SIZE = 4096;
+
+Interpreter::Interpreter(size_t max_call_depth)
+    : globals{},
+      stack(STACK_SIZE),
+      frame_base{0},
+      frame_top{0},
+      closure{nullptr},
+      module{nullptr},
+      call_depth{0},
+      max_call_depth{std::min(max_call_depth, MAX_NATIVE_CALL_DEPTH)},
+      stack_limit{0},
+      tail_call_m{false},
+      tail_function_m{},
+      tail_base_m{0} {
+  for (auto& global : standard_globals()) {
+    globals.define(global.name, std::move(global.value));
   }
+}
 
-  return false;
+auto is_equal(const Value& left, const Value& right) -> bool {
+  return left == right;
 }
 
-auto Interpreter::operator()(const BinaryPtr& expr) -> lox_literal {
-  if (!expr) return std::monostate{};
+auto Interpreter::operator()(const BinaryPtr& expr) -> Value {
+  if (!expr) return {};
 
-  auto left = visit<lox_literal>(*this, expr->left_m);
-  auto right = visit<lox_literal>(*this, expr->right_m);
+  auto left = visit<Value>(*this, expr->left_m);
+  auto right = visit<Value>(*this, expr->right_m);
 
   switch (expr->oper_m.type) {
     case TokenType::MINUS:
       check_are_numbers(expr->oper_m, left, right);
-      return std::get<double>(left) - std::get<double>(right);
+      return left.as_number() - right.as_number();
     case TokenType::PLUS:
-      if (std::holds_alternative<double>(left) &&
-          std::holds_alternative<double>(right))
-        return std::get<double>(left) + std::get<double>(right);
-      else if (std::holds_alternative<std::string>(left) &&
-               std::holds_alternative<std::string>(right))
-        return std::get<std::string>(left) + std::get<std::string>(right);
+      if (left.is_number() &&
+          right.is_number())
+        return left.as_number() + right.as_number();
+      else if (left.is_string() &&
+               right.is_string())
+        return concatenate(left, right);
       else
         throw RuntimeError{expr->oper_m,
                            "Operands must be either strings or numbers."};
     case TokenType::SLASH:
       check_are_numbers(expr->oper_m, left, right);
-      return std::get<double>(left) / std::get<double>(right);
+      return left.as_number() / right.as_number();
     case TokenType::STAR:
       check_are_numbers(expr->oper_m, left, right);
-      return std::get<double>(left) * std::get<double>(right);
+      return left.as_number() * right.as_number();
     case TokenType::GREATER:
       check_are_numbers(expr->oper_m, left, right);
-      return std::get<double>(left) > std::get<double>(right);
+      return left.as_number() > right.as_number();
     case TokenType::GREATER_EQUAL:
       check_are_numbers(expr->oper_m, left, right);
-      return std::get<double>(left) >= std::get<double>(right);
+      return left.as_number() >= right.as_number();
     case TokenType::LESS:
       check_are_numbers(expr->oper_m, left, right);
-      return std::get<double>(left) < std::get<double>(right);
+      return left.as_number() < right.as_number();
     case TokenType::LESS_EQUAL:
       check_are_numbers(expr->oper_m, left, right);
-      return std::get<double>(left) <= std::get<double>(right);
+      return left.as_number() <= right.as_number();
     case TokenType::EQUAL_EQUAL:
       return left == right;
     case TokenType::BANG_EQUAL:
       return left != right;
     default:
-      return std::monostate{};
+      return {};
   }
 }
 
-auto Interpreter::operator()(const GroupingPtr& expr) -> lox_literal {
-  if (!expr) return std::monostate{};
+auto Interpreter::operator()(const GroupingPtr& expr) -> Value {
+  if (!expr) return {};
 
-  return visit<lox_literal>(*this, expr->expression_m);
+  return visit<Value>(*this, expr->expression_m);
 }
 
-auto Interpreter::operator()(const LiteralPtr& expr) -> lox_literal {
-  if (!expr) return std::monostate{};
+auto Interpreter::operator()(const LiteralPtr& expr) -> Value {
+  if (!expr) return {};
 
   return expr->value_m;
 }
 
-auto Interpreter::operator()(const UnaryPtr& expr) -> lox_literal {
-  if (!expr) return std::monostate{};
+auto Interpreter::operator()(const ListLiteralPtr& expr) -> Value {
+  if (!expr) return {};
+
+  auto list = make_ref<ListObj>();
+  list->values.reserve(expr->elements_m.size());
+  for (const auto& element : expr->elements_m) {
+    list->values.emplace_back(visit(*this, element));
+  }
+  return list;
+}
+
+auto Interpreter::operator()(const MapLiteralPtr& expr) -> Value {
+  if (!expr) return {};
+
+  auto map = make_ref<MapObj>();
+  for (size_t i = 0; i < expr->keys_m.size(); i++) {
+    Value key = visit(*this, expr->keys_m[i]);
+    Value value = visit(*this, expr->values_m[i]);
+    if (!key.is_string())
+      throw RuntimeError{expr->brace_m, "Map keys must be strings."};
+    map->set(key, std::move(value));
+  }
+  return map;
+}
+
+auto Interpreter::operator()(const UnaryPtr& expr) -> Value {
+  if (!expr) return {};
 
-  auto right = visit<lox_literal>(*this, expr->right_m);
+  auto right = visit<Value>(*this, expr->right_m);
 
   switch (expr->oper_m.type) {
     case TokenType::MINUS:
       check_is_number(expr->oper_m, right);
-      return -(std::get<double>(right));
+      return -(right.as_number());
     case TokenType::BANG:
       check_is_boolean(expr->oper_m, right);
-      return !(std::get<bool>(right));
+      return !(right.as_bool());
     default:
-      return std::monostate{};
+      return {};
   }
 }
 
-auto Interpreter::operator()(const VariablePtr& expr) -> lox_literal {
-  if (!expr) return std::monostate{};
-  return lookup_variable(expr->name_m, expr);
-}
+auto Interpreter::operator()(const VariablePtr& expr) -> Value {
+  if (!expr) return {};
 
-auto Interpreter::operator()(const AssignPtr& expr) -> lox_literal {
-  if (!expr) return std::monostate{};
+  // The resolver stored where the variable lives in the node
+  return read(expr->slot_m, expr->name_m);
+}
 
-  lox_literal value = visit(*this, expr->value_m);
-  void* ptr = static_cast<void*>(expr.get());
-  auto find = locals.find(ptr);
-  if (find != locals.end()) {
-    env->assign_at(expr->name_m, find->second, lox_literal{value});
-  } else {
-    globals.assign(expr->name_m, value);
+auto Interpreter::operator()(const AssignPtr& expr) -> Value {
+  if (!expr) return {};
+
+  Value value = visit(*this, expr->value_m);
+  const auto& slot = expr->slot_m;
+  switch (slot.kind) {
+    case Slot::Kind::GLOBAL:
+      globals.assign(expr->name_m, value);
+      break;
+    case Slot::Kind::LOCAL:
+      stack[frame_base + slot.index] = value;
+      break;
+    case Slot::Kind::CELL:
+      stack[frame_base + slot.index].as<Cell>()->value = value;
+      break;
+    case Slot::Kind::UPVALUE:
+      closure->upvalues[slot.index]->value = value;
+      break;
+    case Slot::Kind::SELF:
+      // Assigned functions are captured instead
+      break;
   }
 
   return value;
 }
 
-auto Interpreter::operator()(const LogicalPtr& expr) -> lox_literal {
-  if (!expr) return std::monostate{};
+auto Interpreter::operator()(const LogicalPtr& expr) -> Value {
+  if (!expr) return {};
 
-  lox_literal left = visit(*this, expr->left_m);
+  Value left = visit(*this, expr->left_m);
   check_is_boolean(expr->oper_m, left);
   if (expr->oper_m.type == TokenType::OR) {
-    if (std::get<bool>(left)) return true;
+    if (left.as_bool()) return true;
   } else {
-    if (!std::get<bool>(left)) return false;
+    if (!left.as_bool()) return false;
   }
   return visit(*this, expr->right_m);
 }
 
-auto Interpreter::operator()(const CallPtr& expr) -> lox_literal {
-  if (!expr) return std::monostate{};
+auto Interpreter::operator()(const CallPtr& expr) -> Value {
+  if (!expr) return {};
+
+  // Only this call is in tail position, not the ones in its operands
+  bool tail = std::exchange(tail_call_m, false);
+
+  // Methods called right away don't need a bound method
+  if (const auto* get = std::get_if<GetPtr>(&expr->callee_m); get && *get)
+    return invoke(expr, *get, tail);
+  if (const auto* super = std::get_if<SuperPtr>(&expr->callee_m);
+      super && *super)
+    return invoke(expr, *super, tail);
 
   // The interpreter needs to interpret this expression into a callable object
-  lox_literal callee = visit(*this, expr->callee_m);
-  std::vector<lox_literal> args{};
+  Value callee = visit(*this, expr->callee_m);
+
+  // The arguments are evaluated right above the current frame, which is
+  // where the frame of the callee starts, so they become its parameters
+  // without being copied
+  size_t base = frame_top;
   for (const auto& arg : expr->arguments_m) {
-    args.emplace_back(visit(*this, arg));
+    push(visit(*this, arg));
   }
 
-  if (!std::holds_alternative<LoxCallablePtr>(callee)) {
-    throw RuntimeError{expr->paren_m, "Can only call functions and classes"};
+  if (tail && callee.is_callable()) {
+    if (auto* function = dynamic_cast<LoxFunction*>(callee.as<LoxCallable>())) {
+      check_arity(expr->paren_m, *function, frame_top - base);
+      return tail_call(*function, base);
+    }
   }
 
-  auto& ptr = std::get<LoxCallablePtr>(callee);
-  if (args.size() != ptr->arity()) {
-    throw RuntimeError{expr->paren_m,
-                       fmt::format("Expected {} arguments but got {}.",
-                                   ptr->arity(), args.size())};
-  }
+  Value result = call_value(callee, expr->paren_m, base);
+  pop_to(base);
+  return result;
+}
 
-  return ptr->execute(*this, args);
+auto Interpreter::operator()(const GetPtr& expr) -> Value {
+  if (!expr) return {};
+
+  Value object = visit(*this, expr->object_m);
+  if (!object.is_instance())
+    throw RuntimeError{expr->name_m, "Only instances have properties."};
+
+  // The inline cache of the node knows where the field is for the shapes
+  // seen here before
+  auto* instance = object.as<LoxInstance>();
+  int index = instance->find(expr->cache_m, expr->name_m.lexeme);
+  if (index != -1) return instance->fields[index];
+
+  auto* method =
+      instance->cls->find_method(expr->method_cache_m, expr->name_m.lexeme);
+  if (method == nullptr)
+    throw RuntimeError{expr->name_m, fmt::format("Undefined property '{}'.",
+                                                 expr->name_m.lexeme)};
+  return make_ref<LoxBoundMethod>(std::move(object),
+                                  Ref<LoxCallable>{method});
 }
 
-auto Interpreter::operator()(const BlockPtr& stmt) -> void {
-  if (!stmt) return;
+auto Interpreter::operator()(const SetPtr& expr) -> Value {
+  if (!expr) return {};
 
-  Environment* previous = env;
+  Value object = visit(*this, expr->object_m);
+  if (!object.is_instance())
+    throw RuntimeError{expr->name_m, "Only instances have fields."};
 
-  // Dumb RAII handler to restore the parent's scope after exit
-  std::shared_ptr<std::monostate> cleaner{
-      nullptr, [&](std::monostate* ptr) { env = previous; }};
+  Value value = visit(*this, expr->value_m);
+  object.as<LoxInstance>()->set(expr->cache_m, expr->name_m.lexeme, value);
+  return value;
+}
 
-  Environment new_env = Environment{previous};
-  env = &new_env;
-  for (const auto& statement : stmt->statements_m) {
-    visit(*this, statement);
+auto Interpreter::operator()(const IndexPtr& expr) -> Value {
+  if (!expr) return {};
+
+  Value object = visit(*this, expr->object_m);
+  Value index = visit(*this, expr->index_m);
+  try {
+    return get_element(object, index);
+  } catch (const NativeError& err) {
+    throw RuntimeError{expr->bracket_m, err.msg};
   }
 }
 
-auto Interpreter::operator()(const ExpressionPtr& stmt) -> void {
-  if (!stmt) return;
+auto Interpreter::operator()(const SetIndexPtr& expr) -> Value {
+  if (!expr) return {};
 
-  visit(*this, stmt->expression_m);
+  Value object = visit(*this, expr->object_m);
+  Value index = visit(*this, expr->index_m);
+  Value value = visit(*this, expr->value_m);
+  try {
+    set_element(object, index, value);
+  } catch (const NativeError& err) {
+    throw RuntimeError{expr->bracket_m, err.msg};
+  }
+  return value;
+}
+
+auto Interpreter::operator()(const SuperPtr& expr) -> Value {
+  if (!expr) return {};
+
+  // `super` always holds a class, it's checked when the subclass is defined
+  Value superclass = read(expr->slot_m, expr->keyword_m);
+  auto* method = superclass.as<LoxClass>()->find_method(expr->cache_m,
+                                                        expr->method_m.lexeme);
+  if (method == nullptr)
+    throw RuntimeError{expr->method_m, fmt::format("Undefined property '{}'.",
+                                                   expr->method_m.lexeme)};
+  return make_ref<LoxBoundMethod>(read(expr->receiver_m, expr->keyword_m),
+                                  Ref<LoxCallable>{method});
+}
+
+auto Interpreter::operator()(const ThisPtr& expr) -> Value {
+  if (!expr) return {};
+  return read(expr->slot_m, expr->keyword_m);
 }
 
-auto Interpreter::operator()(const FunctionPtr& stmt) -> void {
-  // This feels hacky const casting away stuffs :\
-  // But I think this should be fine since the parsed statements are not
-  // used after being interpreted. Another way to achieve this would be to
-  // use non-const stmt or fields, but I don't want to lose the nice-ity of
-  // having const values everywhere.
-  auto& ptr = const_cast<FunctionPtr&>(stmt);
+auto Interpreter::operator()(const BlockPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
 
-  // The current environment is captured as a closure so that the created
-  // function object still have access to current environment. Otherwise,
-  // the variables defined could be lost if this function object is escaped
-  // from the current scope. e.g.
+  // The variables of the block already have their own slots in the frame
+  return execute(stmt->statements_m);
+}
+
+auto Interpreter::operator()(const ExpressionPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
+
+  visit(*this, stmt->expression_m);
+  return Completion::NORMAL;
+}
+
+auto Interpreter::operator()(const FunctionPtr& stmt) -> Completion {
+  // The variables the function uses from the enclosing functions are
+  // captured as cells, so that the created function object still has access
+  // to them after the frame declaring them is gone. e.g.
   //
   // fun makeFn() {
   //   var i = 1;
@@ -221,123 +327,534 @@ auto Interpreter::operator()(const FunctionPtr& stmt) -> void {
   //   return returnI;
   // }
   //
-  // var fn = makeFn(); fn(); <- undefined variable i
+  // var fn = makeFn(); fn(); <- i is still alive in its cell
   //
-  LoxFunction function{
-      Function::create(
-          Token{ptr->name_m},
-          std::move(const_cast<std::vector<Token>&>(ptr->params_m)),
-          std::move(const_cast<std::vector<Stmt>&>(ptr->body_m))),
-      *env};
-  env->define(stmt->name_m.lexeme,
-              std::make_shared<LoxFunction>(std::move(function)));
+  // The declaration itself lives in the arena, so it's shared by every
+  // function object created from it.
+  const auto& slot = stmt->slot_m;
+
+  // A function referring to itself doesn't capture its own cell unless it's
+  // assigned, but a closure inside of it may still capture it. The cell must
+  // exist before the captures are collected.
+  Ref<Cell> cell{};
+  if (slot.kind == Slot::Kind::CELL) {
+    cell = make_ref<Cell>(Value{});
+    local(slot.index) = Value{cell};
+  }
+
+  auto function = make_function(stmt, false);
+  if (cell) {
+    cell->value = Value{function};
+  } else {
+    define(slot, stmt->name_m, std::move(function));
+  }
+  return Completion::NORMAL;
 }
 
-auto Interpreter::operator()(const PrintPtr& stmt) -> void {
-  if (!stmt) return;
+auto Interpreter::operator()(const PrintPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
 
-  lox_literal value = visit(*this, stmt->expression_m);
+  Value value = visit(*this, stmt->expression_m);
   fmt::print("{}", value);
+  return Completion::NORMAL;
 }
 
-auto Interpreter::operator()(const VarPtr& stmt) -> void {
-  if (!stmt) return;
+auto Interpreter::operator()(const VarPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
 
-  lox_literal val = visit(*this, stmt->initializer_m);
-  env->define(stmt->name_m.lexeme, val);
+  Value val = visit(*this, stmt->initializer_m);
+  define(stmt->slot_m, stmt->name_m, std::move(val));
+  return Completion::NORMAL;
 }
 
-auto Interpreter::operator()(const IfPtr& stmt) -> void {
-  if (!stmt) return;
+auto Interpreter::operator()(const IfPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
 
-  lox_literal condition = visit(*this, stmt->expression_m);
-  if (!std::holds_alternative<bool>(condition))
+  Value condition = visit(*this, stmt->expression_m);
+  if (!condition.is_bool())
     throw RuntimeError{stmt->token_m,
                        "If condition must be a boolean expression."};
 
-  if (std::get<bool>(condition)) {
-    visit(*this, stmt->then_branch_m);
+  if (condition.as_bool()) {
+    return visit(*this, stmt->then_branch_m);
   } else {
-    visit(*this, stmt->else_branch_m);
+    return visit(*this, stmt->else_branch_m);
   }
 }
 
-auto Interpreter::operator()(const WhilePtr& stmt) -> void {
-  if (!stmt) return;
+auto Interpreter::operator()(const WhilePtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
 
-  lox_literal condition = std::visit(*this, stmt->condition_m);
-  if (!std::holds_alternative<bool>(condition))
+  Value condition = std::visit(*this, stmt->condition_m);
+  if (!condition.is_bool())
     throw RuntimeError{stmt->token_m,
                        "While condition must be a boolean expression."};
 
-  while (std::get<bool>(condition)) {
-    visit(*this, stmt->body_m);
+  while (condition.as_bool()) {
+    if (auto completion = visit(*this, stmt->body_m);
+        completion != Completion::NORMAL)
+      return completion;
     condition = std::visit(*this, stmt->condition_m);
-    if (!std::holds_alternative<bool>(condition))
+    if (!condition.is_bool())
       throw RuntimeError{stmt->token_m,
                          "While condition must be a boolean expression."};
   }
+  return Completion::NORMAL;
+}
+
+auto Interpreter::operator()(const ForInPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
+
+  Value iterable = visit(*this, stmt->iterable_m);
+  uint32_t version = 0;
+  try {
+    version = begin_iteration(iterable);
+  } catch (const NativeError& err) {
+    throw RuntimeError{stmt->token_m, err.msg};
+  }
+
+  size_t position = 0;
+  Value element{};
+  auto next = [&]() {
+    try {
+      return next_element(iterable, position, version, element);
+    } catch (const NativeError& err) {
+      throw RuntimeError{stmt->token_m, err.msg};
+    }
+  };
+
+  while (next()) {
+    define(stmt->slot_m, stmt->name_m, std::move(element));
+    if (auto completion = visit(*this, stmt->body_m);
+        completion != Completion::NORMAL)
+      return completion;
+  }
+  return Completion::NORMAL;
 }
 
-auto Interpreter::operator()(const ReturnPtr& stmt) -> void {
-  if (!stmt) return;
+auto Interpreter::operator()(const ReturnPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
+
+  // A call in tail position is run in the frame of the current function
+  // instead of a new one, so tail recursion runs in constant stack space
+  const auto* call = std::get_if<CallPtr>(&stmt->value_m);
+  tail_call_m = call != nullptr && *call != nullptr;
 
-  lox_literal value = visit(*this, stmt->value_m);
-  if (!std::holds_alternative<std::monostate>(value)) throw ReturnObject{value};
+  return_value_m = visit(*this, stmt->value_m);
+  return tail_function_m ? Completion::TAIL_CALL : Completion::RETURN;
 }
 
-auto Interpreter::operator()(const ClassPtr& stmt) -> void {
-  env->define(stmt->name_m.lexeme, std::monostate{});
-  auto ptr = std::make_unique<LoxClass>(stmt->name_m.lexeme);
-  env->assign(stmt->name_m, std::move(ptr));
+auto Interpreter::operator()(const ClassPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
+
+  // Like functions, the methods may capture the cell of the class itself
+  const auto& slot = stmt->slot_m;
+  Ref<Cell> cell{};
+  if (slot.kind == Slot::Kind::CELL) {
+    cell = make_ref<Cell>(Value{});
+    local(slot.index) = Value{cell};
+  }
+
+  // The method table is flattened here once, the inherited methods are
+  // copied first so the class's own methods override them
+  auto cls = make_ref<LoxClass>(std::string{stmt->name_m.lexeme});
+  if (!expr_is_null(stmt->superclass_m)) {
+    Value superclass = visit(*this, stmt->superclass_m);
+    if (!superclass.is_callable() ||
+        dynamic_cast<LoxClass*>(superclass.as<LoxCallable>()) == nullptr)
+      throw RuntimeError{std::get<VariablePtr>(stmt->superclass_m)->name_m,
+                         "Superclass must be a class."};
+
+    cls->inherit(*superclass.as<LoxClass>());
+    define(stmt->super_slot_m, stmt->name_m, std::move(superclass));
+  }
+
+  for (const auto& method : stmt->methods_m) {
+    bool initializer = method->name_m.lexeme == "init";
+    cls->add_method(method->name_m.lexeme,
+                    make_function(method, initializer));
+  }
+
+  if (cell) {
+    cell->value = Value{cls};
+  } else {
+    define(slot, stmt->name_m, std::move(cls));
+  }
+  return Completion::NORMAL;
+}
+
+auto Interpreter::operator()(const ImportPtr& stmt) -> Completion {
+  if (!stmt) return Completion::NORMAL;
+  if (stmt->module_m == nullptr)
+    throw RuntimeError{stmt->keyword_m, "Module was not loaded."};
+
+  // Imports are only allowed at the top level, so the module runs at the top
+  // level too and defines its globals
+  if (imported.insert(stmt->module_m).second) {
+    const Module* importer = module;
+    module = stmt->module_m;
+    execute(stmt->module_m->statements);
+    module = importer;
+  }
+  return Completion::NORMAL;
 }
 
-auto Interpreter::interpret(const std::vector<Stmt>& stmts) -> bool {
+auto Interpreter::interpret(List<Stmt> stmts) -> bool {
+  // The stack is the one of the thread running the statements, which isn't
+  // always the one that created the interpreter
+  stack_limit = native_stack_limit();
+  bool ok = true;
   try {
     for (const auto& stmt : stmts) {
       visit(*this, stmt);
     }
-    return true;
   } catch (const RuntimeError& err) {
-    report_error(err);
-    return false;
+    // The frames aren't left on errors, so this is where the error was raised
+    const Module* at = closure != nullptr ? closure->module : module;
+    report_error(err, at != nullptr ? display(at->path) : "");
+    ok = false;
   }
+
+  // Nothing is left on the stack between two runs, and an error may have
+  // left the frames of the calls it unwound behind
+  pop_to(0);
+  frame_base = 0;
+  closure = nullptr;
+  module = nullptr;
+  call_depth = 0;
+  tail_call_m = false;
+  tail_function_m = {};
+  return ok;
 }
 
-auto Interpreter::execute_block(const std::vector<Stmt>& stmts,
-                                Environment* environment) -> void {
-  Environment* previous = env;
+auto Interpreter::execute(List<Stmt> stmts) -> Completion {
+  for (const auto& statement : stmts) {
+    if (auto completion = visit(*this, statement);
+        completion != Completion::NORMAL)
+      return completion;
+  }
+  return Completion::NORMAL;
+}
 
-  // Dumb RAII handler to restore the parent's scope after exit
-  std::shared_ptr<std::monostate> cleaner{
-      nullptr, [&](std::monostate* ptr) { env = previous; }};
+auto Interpreter::call(const LoxFunction& function, Args args) -> Value {
+  size_t caller_base = frame_base;
+  const LoxFunction* caller = closure;
+
+  // The parameters are the first slots of the frame, so arguments already on
+  // top of the stack are used as they are
+  size_t base = frame_top - args.size();
+  bool on_stack = args.data() == stack.data() + base;
+
+  // Pure functions return the cached result for arguments seen before. Tail
+  // calls to other pure functions aren't looked up, the result is only cached
+  // for this call.
+  MemoTable::Ticket ticket{};
+  if (auto* memo = function.declaration->memo_m) {
+    if (const Value* hit = memo->find(args, ticket)) {
+      Value result = *hit;
+      if (on_stack) pop_to(base);
+      return result;
+    }
+  }
 
-  env = environment;
-  for (const auto& statement : stmts) {
-    visit(*this, statement);
+  if (!on_stack) {
+    base = frame_top;
+    for (const auto& arg : args) push(arg);
+  }
+  frame_base = base;
+  call_depth++;
+
+  // Tail calls replace the running function, which is then only kept alive
+  // by `tail`
+  const LoxFunction* running = &function;
+  Ref<LoxFunction> tail{};
+  Value result{};
+  while (true) {
+    closure = running;
+
+    // Captured parameters are moved into cells
+    const auto& params = running->declaration->layout_m.params;
+    for (size_t i = 0; i < params.size(); i++) {
+      if (params[i].kind == Slot::Kind::CELL)
+        stack[base + i] = Value{make_ref<Cell>(std::move(stack[base + i]))};
+    }
+
+    auto completion = execute(running->declaration->body_m);
+    if (completion != Completion::TAIL_CALL) {
+      if (completion == Completion::RETURN) result = std::move(return_value_m);
+      break;
+    }
+
+    // The frame of the tail call is moved down to replace this one
+    size_t size = frame_top - tail_base_m;
+    if (tail_base_m != base) {
+      std::move(stack.begin() + tail_base_m, stack.begin() + frame_top,
+                stack.begin() + base);
+      pop_to(base + size);
+    }
+    tail = std::move(tail_function_m);
+    running = tail.get();
+  }
+
+  // Initializers return `this` even if they return early
+  if (running->initializer) {
+    const auto& receiver = running->declaration->layout_m.params[0];
+    result = receiver.kind == Slot::Kind::CELL ? stack[base].as<Cell>()->value
+                                               : stack[base];
+  }
+
+  MemoTable::store(ticket, result);
+
+  // Release the locals and the arguments before handing the stack back to
+  // the caller
+  pop_to(base);
+  frame_base = caller_base;
+  closure = caller;
+  call_depth--;
+  return result;
+}
+
+auto Interpreter::call(const LoxFunction& method, const Value& receiver,
+                       Args args) -> Value {
+  // `this` is the first slot of the frame, so arguments already on top of
+  // the stack are moved up by a slot to make room for it
+  size_t base = frame_top - args.size();
+  if (args.data() == stack.data() + base) {
+    push(Value{});
+    std::move_backward(stack.begin() + base, stack.begin() + frame_top - 1,
+                       stack.begin() + frame_top);
+    stack[base] = receiver;
+  } else {
+    base = frame_top;
+    push(receiver);
+    for (const auto& arg : args) push(arg);
+  }
+  return call(method, Args{stack.data() + base, frame_top - base});
+}
+
+auto Interpreter::call_value(const Value& callee, const Token& paren,
+                             size_t base) -> Value {
+  if (!callee.is_callable()) {
+    throw RuntimeError{paren, "Can only call functions and classes"};
+  }
+
+  auto* ptr = callee.as<LoxCallable>();
+  size_t argc = frame_top - base;
+  check_arity(paren, *ptr, argc);
+  check_depth(paren);
+  try {
+    return ptr->execute(*this, Args{stack.data() + base, argc});
+  } catch (const NativeError& err) {
+    throw RuntimeError{paren, err.msg};
+  }
+}
+
+auto Interpreter::call_back(LoxCallable& callee, Args args) -> Value {
+  // Errors are reported at the call of the native
+  if (args.size() != callee.arity())
+    throw NativeError{fmt::format("Expected {} arguments but got {}.",
+                                  callee.arity(), args.size())};
+  if (call_depth >= max_call_depth || out_of_stack())
+    throw NativeError{"Stack overflow."};
+  return callee.execute(*this, args);
+}
+
+auto Interpreter::tail_call(LoxFunction& function, size_t base) -> Value {
+  tail_function_m = Ref<LoxFunction>{&function};
+  tail_base_m = base;
+  return {};
+}
+
+auto Interpreter::check_arity(const Token& paren, const LoxCallable& callee,
+                              size_t argc) -> void {
+  if (argc != callee.arity()) {
+    throw RuntimeError{paren, fmt::format("Expected {} arguments but got {}.",
+                                          callee.arity(), argc)};
+  }
+}
+
+auto Interpreter::check_depth(const Token& paren) -> void {
+  // Lox calls nest C++ calls too, so running out of the C++ stack is
+  // reported before it happens
+  if (call_depth >= max_call_depth || out_of_stack())
+    throw RuntimeError{paren, "Stack overflow."};
+}
+
+auto Interpreter::out_of_stack() const -> bool {
+  // The stack grows down, so the address of a local is how far it got
+  char here{};
+  return reinterpret_cast<uintptr_t>(&here) < stack_limit;
+}
+
+auto Interpreter::invoke(const CallPtr& expr, const GetPtr& get, bool tail)
+    -> Value {
+  Value object = visit(*this, get->object_m);
+  if (!object.is_instance())
+    throw RuntimeError{get->name_m, "Only instances have properties."};
+
+  // The instance is pushed right below the arguments, where the method
+  // expects `this` to be
+  size_t base = frame_top;
+  push(object);
+  for (const auto& arg : expr->arguments_m) {
+    push(visit(*this, arg));
+  }
+
+  // A field holding a function shadows the methods with the same name
+  auto* instance = object.as<LoxInstance>();
+  if (int index = instance->find(get->cache_m, get->name_m.lexeme);
+      index != -1) {
+    // Copied, the call may assign to the field while the function runs
+    Value callee = instance->fields[index];
+    if (tail && callee.is_callable()) {
+      if (auto* fn = dynamic_cast<LoxFunction*>(callee.as<LoxCallable>())) {
+        check_arity(expr->paren_m, *fn, frame_top - base - 1);
+        return tail_call(*fn, base + 1);
+      }
+    }
+    Value result = call_value(callee, expr->paren_m, base + 1);
+    pop_to(base);
+    return result;
+  }
+
+  auto* method =
+      instance->cls->find_method(get->method_cache_m, get->name_m.lexeme);
+  if (method == nullptr)
+    throw RuntimeError{get->name_m, fmt::format("Undefined property '{}'.",
+                                                get->name_m.lexeme)};
+
+  size_t argc = frame_top - base - 1;
+  check_arity(expr->paren_m, *method, argc);
+
+  // Methods of classes defined by the interpreter are always lox functions
+  auto* function = static_cast<LoxFunction*>(method);
+  if (tail) return tail_call(*function, base);
+  check_depth(expr->paren_m);
+  Value result = call(*function, Args{stack.data() + base, argc + 1});
+  pop_to(base);
+  return result;
+}
+
+auto Interpreter::invoke(const CallPtr& expr, const SuperPtr& super, bool tail)
+    -> Value {
+  Value superclass = read(super->slot_m, super->keyword_m);
+
+  size_t base = frame_top;
+  push(read(super->receiver_m, super->keyword_m));
+  for (const auto& arg : expr->arguments_m) {
+    push(visit(*this, arg));
+  }
+
+  auto* method = superclass.as<LoxClass>()->find_method(super->cache_m,
+                                                        super->method_m.lexeme);
+  if (method == nullptr)
+    throw RuntimeError{super->method_m,
+                       fmt::format("Undefined property '{}'.",
+                                   super->method_m.lexeme)};
+
+  size_t argc = frame_top - base - 1;
+  check_arity(expr->paren_m, *method, argc);
+
+  auto* function = static_cast<LoxFunction*>(method);
+  if (tail) return tail_call(*function, base);
+  check_depth(expr->paren_m);
+  Value result = call(*function, Args{stack.data() + base, argc + 1});
+  pop_to(base);
+  return result;
+}
+
+auto Interpreter::make_function(const FunctionPtr& stmt, bool initializer)
+    -> Ref<LoxFunction> {
+  auto function = make_ref<LoxFunction>(stmt, initializer);
+  function->module = closure != nullptr ? closure->module : module;
+  for (const auto& capture : stmt->layout_m.captures) {
+    if (capture.is_self) {
+      function->upvalues.emplace_back(make_ref<Cell>(
+          Value{Ref<LoxFunction>{const_cast<LoxFunction*>(closure)}}));
+      continue;
+    }
+    function->upvalues.emplace_back(
+        capture.is_local ? Ref<Cell>{local(capture.index).as<Cell>()}
+                         : closure->upvalues[capture.index]);
   }
+  return function;
 }
 
 auto Interpreter::get_globals() const -> const Environment& {
   return this->globals;
 }
 
-auto Interpreter::check_is_number(const Token& oper, const lox_literal& operand)
+auto Interpreter::read(const Slot& slot, const Token& name) -> Value {
+  switch (slot.kind) {
+    case Slot::Kind::GLOBAL:
+      return globals.get(name);
+    case Slot::Kind::LOCAL:
+      return stack[frame_base + slot.index];
+    case Slot::Kind::CELL:
+      return stack[frame_base + slot.index].as<Cell>()->value;
+    case Slot::Kind::UPVALUE:
+      return closure->upvalues[slot.index]->value;
+    case Slot::Kind::SELF:
+      return Value{Ref<LoxFunction>{const_cast<LoxFunction*>(closure)}};
+  }
+  return {};
+}
+
+auto Interpreter::define(const Slot& slot, const Token& name, Value value)
+    -> void {
+  switch (slot.kind) {
+    case Slot::Kind::GLOBAL:
+      globals.define(name.lexeme, std::move(value));
+      break;
+    case Slot::Kind::LOCAL:
+      local(slot.index) = std::move(value);
+      break;
+    case Slot::Kind::CELL:
+      // Every declaration gets a fresh cell, so closures created in different
+      // iterations of a loop don't share their variables
+      local(slot.index) = Value{make_ref<Cell>(std::move(value))};
+      break;
+    case Slot::Kind::UPVALUE:
+    case Slot::Kind::SELF:
+      // Declarations are always in the frame of the declaring function
+      break;
+  }
+}
+
+auto Interpreter::local(int index) -> Value& {
+  size_t i = frame_base + index;
+  if (i >= stack.size())
+    stack.resize(std::max<size_t>(i + 1, stack.size() * 2));
+  frame_top = std::max(frame_top, i + 1);
+  return stack[i];
+}
+
+auto Interpreter::push(Value value) -> void {
+  if (frame_top == stack.size()) stack.resize(stack.size() * 2);
+  stack[frame_top++] = std::move(value);
+}
+
+auto Interpreter::pop_to(size_t top) -> void {
+  for (size_t i = top; i < frame_top; i++) stack[i] = Value{};
+  frame_top = top;
+}
+
+auto Interpreter::check_is_number(const Token& oper, const Value& operand)
     -> void {
-  if (!std::holds_alternative<double>(operand))
+  if (!operand.is_number())
     throw RuntimeError{oper, "Operand must be a number."};
 }
 
 auto Interpreter::check_is_boolean(const Token& oper,
-                                   const lox_literal& operand) -> void {
-  if (!std::holds_alternative<bool>(operand))
+                                   const Value& operand) -> void {
+  if (!operand.is_bool())
     throw RuntimeError{oper, "Operand must be a boolean."};
 }
 
-auto Interpreter::check_are_numbers(const Token& oper, const lox_literal& left,
-                                    const lox_literal& right) -> void {
-  if (!std::holds_alternative<double>(left) ||
-      !std::holds_alternative<double>(right))
+auto Interpreter::check_are_numbers(const Token& oper, const Value& left,
+                                    const Value& right) -> void {
+  if (!left.is_number() ||
+      !right.is_number())
     throw RuntimeError{oper, "Operands must be numbers."};
 }
 
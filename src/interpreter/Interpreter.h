@@ -5,7 +5,8 @@
 #ifndef LOXALONE_INTERPRETER_H
 #define LOXALONE_INTERPRETER_H
 
-#include <unordered_map>
+#include <cstdint>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -13,83 +14,155 @@
 #include "Error.h"
 #include "Expr.h"
 #include "LoxCallable.h"
+#include "Native.h"
 #include "Stmt.h"
 #include "Token.h"
 
 namespace loxalone {
-class Interpreter {
+
+// Completion tells how the execution of a statement ended. Anything other
+// than `NORMAL` stops the enclosing statements from running the rest of their
+// bodies and is passed up until a statement that handles it, e.g. `RETURN` is
+// handled by the function call. `TAIL_CALL` is a return of a call whose frame
+// is ready on top of the stack, the function call runs it in place of its own
+// frame.
+enum class Completion { NORMAL, RETURN, TAIL_CALL };
+
+class Interpreter : public Engine {
  public:
-  Interpreter();
+  explicit Interpreter(size_t max_call_depth = DEFAULT_MAX_CALL_DEPTH);
 
   // Expression visitor
-  auto operator()(const BinaryPtr &expr) -> lox_literal;
-  auto operator()(const GroupingPtr &expr) -> lox_literal;
-  auto operator()(const LiteralPtr &expr) -> lox_literal;
-  auto operator()(const UnaryPtr &expr) -> lox_literal;
-  auto operator()(const VariablePtr &expr) -> lox_literal;
-  auto operator()(const AssignPtr &expr) -> lox_literal;
-  auto operator()(const LogicalPtr &expr) -> lox_literal;
-  auto operator()(const CallPtr &expr) -> lox_literal;
+  auto operator()(const BinaryPtr &expr) -> Value;
+  auto operator()(const GroupingPtr &expr) -> Value;
+  auto operator()(const IndexPtr &expr) -> Value;
+  auto operator()(const ListLiteralPtr &expr) -> Value;
+  auto operator()(const LiteralPtr &expr) -> Value;
+  auto operator()(const MapLiteralPtr &expr) -> Value;
+  auto operator()(const UnaryPtr &expr) -> Value;
+  auto operator()(const VariablePtr &expr) -> Value;
+  auto operator()(const AssignPtr &expr) -> Value;
+  auto operator()(const LogicalPtr &expr) -> Value;
+  auto operator()(const CallPtr &expr) -> Value;
+  auto operator()(const GetPtr &expr) -> Value;
+  auto operator()(const SetPtr &expr) -> Value;
+  auto operator()(const SetIndexPtr &expr) -> Value;
+  auto operator()(const SuperPtr &expr) -> Value;
+  auto operator()(const ThisPtr &expr) -> Value;
 
   // Statement visitors
-  auto operator()(const BlockPtr &stmt) -> void;
-  auto operator()(const ExpressionPtr &stmt) -> void;
-  auto operator()(const FunctionPtr &stmt) -> void;
-  auto operator()(const PrintPtr &stmt) -> void;
-  auto operator()(const VarPtr &stmt) -> void;
-  auto operator()(const IfPtr &stmt) -> void;
-  auto operator()(const WhilePtr &stmt) -> void;
-  auto operator()(const ReturnPtr &stmt) -> void;
-  auto operator()(const ClassPtr &stmt) -> void;
+  auto operator()(const BlockPtr &stmt) -> Completion;
+  auto operator()(const ExpressionPtr &stmt) -> Completion;
+  auto operator()(const FunctionPtr &stmt) -> Completion;
+  auto operator()(const PrintPtr &stmt) -> Completion;
+  auto operator()(const VarPtr &stmt) -> Completion;
+  auto operator()(const IfPtr &stmt) -> Completion;
+  auto operator()(const WhilePtr &stmt) -> Completion;
+  auto operator()(const ForInPtr &stmt) -> Completion;
+  auto operator()(const ReturnPtr &stmt) -> Completion;
+  auto operator()(const ClassPtr &stmt) -> Completion;
+  auto operator()(const ImportPtr &stmt) -> Completion;
 
   // Entry point for interpreter, returns true if it's successful
   // or false if there's a runtime error
-  auto interpret(const std::vector<Stmt> &) -> bool;
+  auto interpret(List<Stmt>) -> bool;
 
-  // Resolver related methods
-  template <IsExpr T>
-  auto resolve(const T &expr, int depth) -> void {
-    locals[static_cast<void *>(expr.get())] = depth;
-  }
-
-  template <IsExpr T>
-  auto lookup_variable(const Token &token, const T &expr) -> lox_literal {
-    void *ptr = static_cast<void *>(expr.get());
-    auto find = locals.find(ptr);
-    if (find != locals.end()) {
-      return env->get_at(token, find->second);
-    } else {
-      return globals.get(token);
-    }
+  // Defines a global native function calling the C++ function `Fn`, the
+  // arity and the argument checks come from its signature
+  template <auto Fn>
+  auto register_native(std::string_view name) -> void {
+    globals.define(name, make_native<Fn>(name));
   }
 
   // Other helper methods
-  auto execute_block(const std::vector<Stmt> &, Environment *) -> void;
   auto get_globals() const -> const Environment &;
 
+  // Calls the lox function in a new frame on top of the current one. The
+  // arguments are used in place if they are the values on top of the stack.
+  auto call(const LoxFunction &, Args args) -> Value;
+
+  // Calls the method with `this` bound to the receiver
+  auto call(const LoxFunction &, const Value &receiver, Args args) -> Value;
+
+  auto call_back(LoxCallable &callee, Args args) -> Value override;
+
  private:
-  auto check_is_number(const Token &, const lox_literal &) -> void;
-  auto check_is_boolean(const Token &, const lox_literal &) -> void;
-  auto check_are_numbers(const Token &, const lox_literal &,
-                         const lox_literal &) -> void;
+  auto execute(List<Stmt>) -> Completion;
 
-  Environment *env;
-  Environment globals;
-  std::unordered_map<void *, int> locals;
-};
+  // Calls the callee with the arguments from `base` to the top of the stack
+  auto call_value(const Value &callee, const Token &paren, size_t base)
+      -> Value;
 
-static_assert(ExprVisitor<Interpreter, lox_literal>);
-static_assert(StmtVisitor<Interpreter, void>);
+  // Calls a method right away, without creating a bound method for it
+  auto invoke(const CallPtr &, const GetPtr &, bool tail) -> Value;
+  auto invoke(const CallPtr &, const SuperPtr &, bool tail) -> Value;
 
-// `ReturnObject` encapsulates a literal value and used as a return object
-// from lox functions. The interpreter will throw `ReturnObject` which should
-// be caught by the function object and return the literal value from inside.
-class ReturnObject : public std::exception {
- public:
-  lox_literal value;
+  // Leaves the frame from `base` to the top of the stack for the enclosing
+  // function call to run the function in
+  auto tail_call(LoxFunction &, size_t base) -> Value;
 
-  explicit ReturnObject(lox_literal value) : std::exception{}, value{value} {}
+  auto check_arity(const Token &paren, const LoxCallable &, size_t argc)
+      -> void;
+  auto check_depth(const Token &paren) -> void;
+  // Whether a call would run out of the C++ stack of the running thread
+  auto out_of_stack() const -> bool;
+
+  // Creates the function object, capturing the variables it uses
+  auto make_function(const FunctionPtr &, bool initializer) -> Ref<LoxFunction>;
+
+  // Reads and defines the variable in the slot given by the resolver
+  auto read(const Slot &, const Token &) -> Value;
+  auto define(const Slot &, const Token &, Value) -> void;
+
+  // Returns the frame slot with the given index, growing the stack if needed
+  auto local(int index) -> Value &;
+
+  // Pushes the value right above the slots of the current frame
+  auto push(Value) -> void;
+  // Releases the values from `top` upwards and makes it the top again
+  auto pop_to(size_t top) -> void;
+
+  auto check_is_number(const Token &, const Value &) -> void;
+  auto check_is_boolean(const Token &, const Value &) -> void;
+  auto check_are_numbers(const Token &, const Value &,
+                         const Value &) -> void;
+
+  Environment globals;
+
+  // Local variables of every active call, the current frame starts at
+  // `frame_base` and every slot below `frame_top` may hold a live value. The
+  // stack is allocated up front and only grows for deep recursion.
+  std::vector<Value> stack;
+  size_t frame_base;
+  size_t frame_top;
+
+  // Function being called, its upvalues are the variables captured by it
+  const LoxFunction *closure;
+  // Module whose top-level statements are running, null for the main script
+  const Module *module;
+
+  // Number of active calls, a call nested deeper than `max_call_depth` or
+  // below `stack_limit` on the C++ stack is a stack overflow
+  size_t call_depth;
+  size_t max_call_depth;
+  uintptr_t stack_limit;
+
+  // `tail_call_m` is set while the call of a return statement is evaluated.
+  // If it ends up as a tail call, the function and the start of its frame
+  // are left here.
+  bool tail_call_m;
+  Ref<LoxFunction> tail_function_m;
+  size_t tail_base_m;
+
+  // Value of the return statement being completed
+  Value return_value_m;
+
+  // The modules that ran, a module only runs at the first import of it
+  std::unordered_set<const Module *> imported;
 };
+
+static_assert(ExprVisitor<Interpreter, Value>);
+static_assert(StmtVisitor<Interpreter, Completion>);
 }  // namespace loxalone
 
 #endif  // LOXALONE_INTERPRETER_H
@@ -6,32 +6,23 @@
 #define LOXALONE_LITERALFORMATTER_H
 
 #include <fmt/format.h>
+#include <fmt/ranges.h>
 
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+#include "Array.h"
+#include "Collections.h"
 #include "LoxCallable.h"
 #include "LoxClass.h"
 #include "LoxInstance.h"
 #include "Token.h"
 
-// This file implements LiteralFormatter and other related methods for
-// fmt::format to work with lox_literal values. This is required for
-// `print` statements in the interpreter.
+// This file implements the formatters for fmt::format to work with Value
+// values. This is required for `print` statements in the interpreter.
 
-// Formatter implementation for std::monostate
-template <>
-struct fmt::formatter<std::monostate> {
-  constexpr auto parse(fmt::format_parse_context& ctx)
-      -> decltype(ctx.begin()) {
-    return ctx.end();
-  }
-
-  template <typename FormatContext>
-  auto format(const std::monostate& token, FormatContext& ctx) const
-      -> decltype(ctx.out()) {
-    return fmt::format_to(ctx.out(), "std::monostate");
-  }
-};
-
-// Formatter implementation for std::shared_ptr<LoxCallable>
+// Formatter implementation for Ref<LoxCallable>
 template <>
 struct fmt::formatter<loxalone::LoxCallablePtr> {
   constexpr auto parse(fmt::format_parse_context& ctx)
@@ -51,7 +42,7 @@ struct fmt::formatter<loxalone::LoxCallablePtr> {
   }
 };
 
-// Formatter implementation for std::shared_ptr<LoxInstance>
+// Formatter implementation for Ref<LoxInstance>
 template <>
 struct fmt::formatter<loxalone::LoxInstancePtr> {
   constexpr auto parse(fmt::format_parse_context& ctx)
@@ -61,35 +52,118 @@ struct fmt::formatter<loxalone::LoxInstancePtr> {
 
   template <typename FormatContext>
   auto format(const loxalone::LoxInstancePtr& token, FormatContext& ctx) const {
-    return fmt::format_to(ctx.out(), "<instance {}.class>", token.get()->cls.name());
+    return fmt::format_to(ctx.out(), "<instance {}.class>", token->cls->name());
   }
 };
 
-template <typename FormatContext>
-class LiteralFormatter {
- private:
-  FormatContext& ctx;
-
- public:
-  auto operator()(const auto& arg) -> decltype(ctx.out()) {
-    return fmt::format_to(ctx.out(), "{}\n", arg);
-  }
-
-  LiteralFormatter(FormatContext& ctx) : ctx{ctx} {}
-};
-
-// Formatter implementation for lox_literal
+// Formatter implementation for Value
 template <>
-struct fmt::formatter<loxalone::lox_literal> {
+struct fmt::formatter<loxalone::Value> {
   constexpr auto parse(fmt::format_parse_context& ctx)
       -> decltype(ctx.begin()) {
     return ctx.end();
   }
 
   template <typename FormatContext>
-  auto format(const loxalone::lox_literal& val, FormatContext& ctx) const
+  auto format(const loxalone::Value& val, FormatContext& ctx) const
       -> decltype(ctx.out()) {
-    return std::visit(LiteralFormatter(ctx), val);
+    return fmt::format_to(write(ctx.out(), val), "\n");
+  }
+
+ private:
+  // A list or map being written, `next` is the position of the element or
+  // entry to write next
+  struct Open {
+    const loxalone::Obj* obj;
+    size_t next;
+    bool first;
+  };
+
+  // Writes the value without the newline. The elements of lists and maps are
+  // written the same way, a list or map inside of itself is written as `[...]`
+  // or `{...}` instead of recursing forever. Lists and maps can nest as deep
+  // as memory allows, so the ones being written are kept on a stack of their
+  // own rather than on the C++ stack.
+  template <typename Out>
+  static auto write(Out out, const loxalone::Value& val) -> Out {
+    using namespace loxalone;
+
+    std::vector<Open> stack{};
+    std::unordered_set<const Obj*> open{};
+    out = write_one(out, val, stack, open);
+    while (!stack.empty()) {
+      Open& top = stack.back();
+      if (top.obj->type == ObjType::LIST) {
+        const auto& values = static_cast<const ListObj*>(top.obj)->values;
+        if (top.next == values.size()) {
+          out = fmt::format_to(out, "]");
+          open.erase(top.obj);
+          stack.pop_back();
+          continue;
+        }
+        if (top.next > 0) out = fmt::format_to(out, ", ");
+        out = write_one(out, values[top.next++], stack, open);
+        continue;
+      }
+
+      const auto& entries = static_cast<const MapObj*>(top.obj)->entries();
+      while (top.next < entries.size() && entries[top.next].key.is_nil())
+        top.next++;
+      if (top.next == entries.size()) {
+        out = fmt::format_to(out, "}}");
+        open.erase(top.obj);
+        stack.pop_back();
+        continue;
+      }
+      if (!top.first) out = fmt::format_to(out, ", ");
+      top.first = false;
+      const auto& entry = entries[top.next++];
+      out = fmt::format_to(out, "{}: ", entry.key.as_string());
+      out = write_one(out, entry.value, stack, open);
+    }
+    return out;
+  }
+
+  // Writes the value, or the start of it if it's a list or map, which is then
+  // pushed on `stack` for its elements to be written
+  template <typename Out>
+  static auto write_one(Out out, const loxalone::Value& val,
+                        std::vector<Open>& stack,
+                        std::unordered_set<const loxalone::Obj*>& open)
+      -> Out {
+    using namespace loxalone;
+
+    if (val.is_nil()) return fmt::format_to(out, "nil");
+    if (val.is_bool()) return fmt::format_to(out, "{}", val.as_bool());
+    if (val.is_number()) return fmt::format_to(out, "{}", val.as_number());
+
+    switch (val.as_obj()->type) {
+      case ObjType::STRING:
+        return fmt::format_to(out, "{}", val.as_string());
+      case ObjType::BUILDER:
+        return fmt::format_to(out, "{}", val.as_string_view());
+      case ObjType::CALLABLE:
+        return fmt::format_to(out, "{}", LoxCallablePtr{val.as<LoxCallable>()});
+      case ObjType::INSTANCE:
+        return fmt::format_to(out, "{}", LoxInstancePtr{val.as<LoxInstance>()});
+      case ObjType::CELL:
+        // Cells are never handed out as values, only shown when debugging
+        return fmt::format_to(out, "<cell>");
+      case ObjType::ARRAY:
+        return fmt::format_to(out, "[{}]",
+                              fmt::join(val.as<ArrayObj>()->values, ", "));
+      case ObjType::LIST:
+        if (!open.insert(val.as_obj()).second)
+          return fmt::format_to(out, "[...]");
+        stack.push_back(Open{val.as_obj(), 0, true});
+        return fmt::format_to(out, "[");
+      case ObjType::MAP:
+        if (!open.insert(val.as_obj()).second)
+          return fmt::format_to(out, "{{...}}");
+        stack.push_back(Open{val.as_obj(), 0, true});
+        return fmt::format_to(out, "{{");
+    }
+    return out;
   }
 };
 
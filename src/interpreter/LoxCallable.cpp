@@ -4,7 +4,13 @@
 
 #include "LoxCallable.h"
 
+#include <chrono>
+
+#include "Array.h"
+#include "Collections.h"
 #include "Interpreter.h"
+#include "Native.h"
+#include "Perf.h"
 
 namespace loxalone {
 
@@ -12,24 +18,42 @@ auto LoxFunction::arity() const -> int {
   return static_cast<int>(declaration->params_m.size());
 }
 
-auto LoxFunction::execute(Interpreter& interpreter,
-                          const std::vector<lox_literal>& args) -> lox_literal {
-  Environment env{&closure};
-  for (int i = 0; i < declaration->params_m.size(); i++) {
-    env.define(declaration->params_m[i].lexeme, args[i]);
-  }
-
-  try {
-    interpreter.execute_block(declaration->body_m, &env);
-  } catch (ReturnObject& ret) {
-    return ret.value;
-  }
-
-  return std::monostate{};
+auto LoxFunction::execute(Interpreter& interpreter, Args args) -> Value {
+  return interpreter.call(*this, args);
 }
 
 auto LoxFunction::name() const -> std::string_view {
   return declaration->name_m.lexeme;
 }
 
+auto NativeCallable::execute(Interpreter& interpreter, Args args) -> Value {
+  return fun_m(interpreter, args);
+}
+
+namespace {
+
+// Seconds since the epoch, for timing scripts. `perf.now()` is the better
+// clock for measuring short intervals.
+auto clock_seconds() -> double {
+  using namespace std::chrono;
+
+  auto time = system_clock::now().time_since_epoch();
+  return duration<double>(time).count();
+}
+
+}  // namespace
+
+auto standard_globals() -> std::vector<StandardGlobal> {
+  std::vector<StandardGlobal> globals{};
+  // The name is a view on the native, which the global keeps alive
+  auto add = [&](Ref<NativeCallable> native) {
+    globals.emplace_back(StandardGlobal{native->name(), std::move(native)});
+  };
+  for (auto& native : array_natives()) add(std::move(native));
+  for (auto& native : collection_natives()) add(std::move(native));
+  add(make_native<&clock_seconds>("clock"));
+  globals.emplace_back(StandardGlobal{"perf", perf_module()});
+  return globals;
+}
+
 }  // namespace loxalone
@@ -5,6 +5,8 @@
 #ifndef LOXALONE_LOXCALLABLE_H
 #define LOXALONE_LOXCALLABLE_H
 
+#include <span>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -16,54 +18,100 @@ namespace loxalone {
 
 class Interpreter;
 
-class LoxCallable {
+// Arguments of a call. They are a view on the value stack of the engine
+// making the call, so passing them around doesn't copy or allocate.
+using Args = std::span<const Value>;
+
+// Calls nested deeper than this fail with a stack overflow error, unless the
+// engine is given another limit. Tail calls don't nest.
+static constexpr size_t DEFAULT_MAX_CALL_DEPTH = 4096;
+
+class LoxCallable : public Obj {
  public:
+  LoxCallable() : Obj{ObjType::CALLABLE} {}
+
   virtual auto arity() const -> int = 0;
-  virtual auto execute(Interpreter&, const std::vector<lox_literal>&)
-      -> lox_literal = 0;
+  virtual auto execute(Interpreter&, Args args) -> Value = 0;
   virtual auto name() const -> std::string_view = 0;
 };
 
-// LoxFunction implements a function object for loxalone
-class LoxFunction : public LoxCallable {
- private:
-  FunctionPtr declaration;
-  Environment closure;
+using LoxCallablePtr = Ref<LoxCallable>;
 
+// Engine is what natives see of the engine running them, both the
+// tree-walking interpreter and the VM implement it
+class Engine {
  public:
-  explicit LoxFunction(FunctionPtr&& declaration, Environment closure)
-      : declaration{std::move(declaration)}, closure{std::move(closure)} {}
+  virtual ~Engine() = default;
+
+  // Calls any callable with the arguments from a native, e.g. a function
+  // passed to it. Runtime errors of the callee are thrown as RuntimeError.
+  virtual auto call_back(LoxCallable& callee, Args args) -> Value = 0;
+};
+
+// LoxFunction implements a function object for loxalone. Only the variables
+// the function uses from its enclosing functions are captured, each of them
+// through the cell it shares with the declaring frame. Methods are lox
+// functions too, they get `this` in the first slot of their frame.
+class LoxFunction : public LoxCallable {
+ public:
+  explicit LoxFunction(FunctionPtr declaration, bool initializer = false)
+      : declaration{declaration}, initializer{initializer}, upvalues{} {}
 
   auto arity() const -> int override;
-  auto execute(Interpreter&, const std::vector<lox_literal>& args)
-      -> lox_literal override;
+  auto execute(Interpreter&, Args args) -> Value override;
   auto name() const -> std::string_view override;
-};
 
-// NativeCallable is a helper class that bridges the C++ callables with the
-// lox interpreter
-class NativeCallable : public LoxCallable {
- private:
-  using func = std::function<lox_literal(const std::vector<lox_literal>&)>;
+  const FunctionPtr declaration;
 
-  const std::string name_m;
-  int arity_m;
-  func fun_m;
+  // Initializers always return `this`
+  const bool initializer;
+
+  // The imported module declaring the function, null for the main script
+  const Module* module = nullptr;
+
+  // Captured cells, in the order of the declaration's `layout_m.captures`
+  std::vector<Ref<Cell>> upvalues;
+};
 
+// NativeCallable is a helper class that bridges the C++ functions with the
+// lox interpreter. The function is a plain pointer, natives are usually made
+// by `make_native` (see Native.h), which checks the arguments before passing
+// them on to the C++ function.
+class NativeCallable : public LoxCallable {
  public:
-  NativeCallable(std::string_view name, int arity, func&& fun)
-      : name_m{name}, arity_m{arity}, fun_m{std::move(fun)} {}
+  using Function = Value (*)(Engine&, Args);
+
+  NativeCallable(std::string_view name, int arity, Function fun)
+      : name_m{name}, arity_m{arity}, fun_m{fun} {}
 
   auto arity() const -> int override { return arity_m; }
 
-  auto execute(Interpreter&, const std::vector<lox_literal>& args)
-      -> lox_literal override {
-    return fun_m(args);
+  auto execute(Interpreter&, Args args) -> Value override;
+
+  // Natives are called the same way by every engine, only the few calling
+  // back into lox use the engine
+  auto call(Engine& engine, Args args) const -> Value {
+    return fun_m(engine, args);
   }
 
   auto name() const -> std::string_view override { return name_m; }
+
+ private:
+  const std::string name_m;
+  const int arity_m;
+  const Function fun_m;
 };
 
+// A global defined by every engine before the script runs
+struct StandardGlobal {
+  std::string_view name;
+  Value value;
+};
+
+// Returns the native functions and modules that are defined as globals in
+// every engine
+auto standard_globals() -> std::vector<StandardGlobal>;
+
 }  // namespace loxalone
 
 #endif  // LOXALONE_LOXCALLABLE_H
@@ -4,18 +4,61 @@
 
 #include "LoxClass.h"
 
+#include "Interpreter.h"
 #include "LoxInstance.h"
 
 namespace loxalone {
 
+// Ids start from 1, an empty method cache has the id 0
+static uint64_t next_class_id = 1;
+
+LoxClass::LoxClass(std::string name)
+    : name_m{std::move(name)},
+      id{next_class_id++},
+      methods{},
+      initializer_m{nullptr} {}
+
 auto LoxClass::name() const -> std::string_view { return name_m; }
 
-// TODO: Arity of this?
-int LoxClass::arity() const { return 0; }
+auto LoxClass::arity() const -> int {
+  return initializer_m != nullptr ? initializer_m->arity() : 0;
+}
+
+auto LoxClass::execute(Interpreter& interpreter, Args args) -> Value {
+  auto instance = make_ref<LoxInstance>(Ref<LoxClass>{this});
+  if (initializer_m != nullptr) {
+    // Classes run by the interpreter only have lox functions as methods
+    interpreter.call(*static_cast<LoxFunction*>(initializer_m),
+                     Value{instance}, args);
+  }
+  return instance;
+}
+
+auto LoxClass::inherit(const LoxClass& superclass) -> void {
+  methods = superclass.methods;
+  initializer_m = superclass.initializer_m;
+}
+
+auto LoxClass::add_method(std::string_view name, Ref<LoxCallable> method)
+    -> void {
+  if (name == "init") initializer_m = method.get();
+  methods.insert_or_assign(StringObj::intern(name), std::move(method));
+}
+
+auto LoxClass::find_method(MethodCache& cache, std::string_view name) const
+    -> LoxCallable* {
+  if (cache.class_id == id) return cache.method;
+
+  auto find = methods.find(StringObj::intern(name));
+  if (find == methods.end()) return nullptr;
+  cache = MethodCache{id, find->second.get()};
+  return cache.method;
+}
 
-lox_literal LoxClass::execute(Interpreter& interpreter,
-                              const std::vector<lox_literal>& vector) {
-  return std::make_unique<LoxInstance>(*this);
+auto LoxBoundMethod::execute(Interpreter& interpreter, Args args) -> Value {
+  // The VM calls its bound methods by itself, only lox functions get here
+  return interpreter.call(*static_cast<LoxFunction*>(method.get()), receiver,
+                          args);
 }
 
 }  // namespace loxalone
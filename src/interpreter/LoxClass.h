@@ -5,24 +5,67 @@
 #ifndef LOXALONE_LOXCLASS_H
 #define LOXALONE_LOXCLASS_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 
 #include "LoxCallable.h"
 
 namespace loxalone {
 
+// LoxClass is a lox class. Its method table is flattened when the class is
+// defined, it has the methods inherited from the superclass as well as its
+// own, so finding a method never walks the superclass chain.
 class LoxClass: public LoxCallable {
  private:
+  struct NameHash {
+    auto operator()(const Ref<StringObj>& name) const -> size_t {
+      return name->hash;
+    }
+  };
+
   const std::string name_m;
+  const uint64_t id;
+  std::unordered_map<Ref<StringObj>, Ref<LoxCallable>, NameHash> methods;
+  LoxCallable* initializer_m;
 
  public:
-  explicit LoxClass(std::string name): name_m{std::move(name)} {}
+  explicit LoxClass(std::string name);
   auto name() const -> std::string_view override;
 
   auto arity() const -> int override;
-  auto execute(Interpreter& interpreter, const std::vector<lox_literal>& vector)
-      -> lox_literal override;
+  auto execute(Interpreter& interpreter, Args args) -> Value override;
+
+  // Copies the methods of the superclass, the methods added afterwards
+  // override them
+  auto inherit(const LoxClass& superclass) -> void;
+  auto add_method(std::string_view name, Ref<LoxCallable> method) -> void;
+
+  // Returns the method with the given name, or nullptr if there's no such
+  // method. The cache belongs to the site calling the method.
+  auto find_method(MethodCache& cache, std::string_view name) const
+      -> LoxCallable*;
+
+  // The `init` method, or nullptr if the class doesn't have one
+  auto initializer() const -> LoxCallable* { return initializer_m; }
+};
+
+// LoxBoundMethod is a method accessed through an instance without being
+// called right away, e.g. `var fn = instance.method;`. It remembers the
+// instance to use as `this` once it's called.
+class LoxBoundMethod : public LoxCallable {
+ public:
+  LoxBoundMethod(Value receiver, Ref<LoxCallable> method)
+      : receiver{std::move(receiver)}, method{std::move(method)} {}
+
+  auto arity() const -> int override { return method->arity(); }
+  auto execute(Interpreter& interpreter, Args args) -> Value override;
+  auto name() const -> std::string_view override { return method->name(); }
+
+  const Value receiver;
+  const Ref<LoxCallable> method;
 };
 
 }
@@ -4,4 +4,36 @@
 
 #include "LoxInstance.h"
 
-namespace loxalone {}  // namespace loxalone
\ No newline at end of file
+namespace loxalone {
+
+auto LoxInstance::find(PropertyCache& cache, std::string_view name) const
+    -> int {
+  if (auto* entry = cache.find(shape); entry != nullptr && entry->next == shape)
+    return entry->index;
+
+  // Misses are cached as well, method calls look for a field first
+  int index = shape->find(StringObj::intern(name).get());
+  cache.add({shape, shape, index});
+  return index;
+}
+
+auto LoxInstance::set(PropertyCache& cache, std::string_view name, Value value)
+    -> void {
+  auto* entry = cache.find(shape);
+  if (entry == nullptr) {
+    auto key = StringObj::intern(name);
+    int index = shape->find(key.get());
+    entry = index != -1 ? cache.add({shape, shape, index})
+                        : cache.add({shape, shape->with(key), shape->size()});
+  }
+
+  if (entry->next == shape) {
+    fields[entry->index] = std::move(value);
+  } else {
+    // The new field always goes right after the existing ones
+    shape = entry->next;
+    fields.emplace_back(std::move(value));
+  }
+}
+
+}  // namespace loxalone
\ No newline at end of file
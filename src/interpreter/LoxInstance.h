@@ -5,17 +5,41 @@
 #ifndef LOXALONE_LOXINSTANCE_H
 #define LOXALONE_LOXINSTANCE_H
 
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include "LoxClass.h"
+#include "Shape.h"
 
 namespace loxalone {
 
-class LoxInstance {
+// LoxInstance is an instance of a lox class. The names of its fields are
+// described by its shape, the instance itself only keeps their values.
+class LoxInstance : public Obj {
  public:
-  explicit LoxInstance(const LoxClass& cls) : cls{cls} {}
+  explicit LoxInstance(Ref<LoxClass> cls)
+      : Obj{ObjType::INSTANCE},
+        cls{std::move(cls)},
+        shape{Shape::root()},
+        fields{} {}
+
+  // Returns the index of the field with the given name in `fields`, or -1 if
+  // the instance doesn't have such a field. The cache belongs to the site
+  // accessing the field.
+  auto find(PropertyCache &cache, std::string_view name) const -> int;
 
-  const LoxClass& cls;
+  // Sets the field with the given name, adding it if the instance doesn't
+  // have it yet
+  auto set(PropertyCache &cache, std::string_view name, Value value) -> void;
+
+  const Ref<LoxClass> cls;
+  const Shape *shape;
+  std::vector<Value> fields;
 };
 
+using LoxInstancePtr = Ref<LoxInstance>;
+
 }  // namespace loxalone
 
 #endif  // LOXALONE_LOXINSTANCE_H
@@ -0,0 +1,73 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Memo.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace loxalone {
+
+MemoTable::MemoTable(std::string name, size_t arity)
+    : name_m{std::move(name)},
+      arity{arity},
+      keys(CAPACITY * arity),
+      entries(CAPACITY),
+      next_stamp{0},
+      hits_m{0},
+      misses_m{0} {}
+
+auto MemoTable::find(std::span<const Value> args, Ticket& ticket)
+    -> const Value* {
+  ticket = Ticket{};
+
+  uint64_t hash = 0;
+  for (const auto& arg : args) {
+    if (arg.is_obj()) return nullptr;
+    hash = (hash ^ arg.raw()) * 0x9e3779b97f4a7c15;
+  }
+
+  // Small integers only differ in the high bits of their doubles, they are
+  // folded into the low bits that pick the entry (the finalizer of MurmurHash3)
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccd;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53;
+  hash ^= hash >> 33;
+
+  auto index = static_cast<uint32_t>(hash & (CAPACITY - 1));
+  Entry& entry = entries[index];
+  uint64_t* key = keys.data() + index * arity;
+
+  bool same = std::equal(args.begin(), args.end(), key,
+                         [](const Value& arg, uint64_t bits) {
+                           return arg.raw() == bits;
+                         });
+  if (entry.filled && same) {
+    hits_m++;
+    return &entry.result;
+  }
+
+  misses_m++;
+  for (size_t i = 0; i < arity; i++) key[i] = args[i].raw();
+  entry.result = Value{};
+  entry.filled = false;
+  // Stamp 0 means the entry was never claimed, so it's skipped on overflow
+  if (++next_stamp == 0) next_stamp = 1;
+  entry.stamp = next_stamp;
+
+  ticket = Ticket{this, index, entry.stamp};
+  return nullptr;
+}
+
+auto MemoTable::store(const Ticket& ticket, const Value& result) -> void {
+  if (ticket.table == nullptr) return;
+
+  Entry& entry = ticket.table->entries[ticket.index];
+  if (entry.stamp != ticket.stamp) return;
+  entry.result = result;
+  entry.filled = true;
+}
+
+}  // namespace loxalone
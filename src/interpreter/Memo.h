@@ -0,0 +1,79 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_MEMO_H
+#define LOXALONE_MEMO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Value.h"
+
+namespace loxalone {
+
+/*
+ * MemoTable caches the results of a pure function by its arguments. Only
+ * calls whose arguments are all numbers, booleans or nil are cached, objects
+ * may be mutable and are never used as keys.
+ *
+ * The table is direct-mapped with a fixed number of entries, each key has a
+ * single entry it can live in and a newer key evicts the older one, so the
+ * memory used by the table is bounded no matter how many distinct arguments
+ * the function is called with.
+ *
+ * A lookup that misses claims the entry for the arguments and hands out a
+ * ticket for it, the result is stored with the ticket once the call returns.
+ * If a nested call claimed the same entry in the meantime, the ticket is
+ * stale and the result is dropped.
+ * */
+class MemoTable {
+ public:
+  static constexpr size_t CAPACITY = 1024;
+
+  struct Ticket {
+    MemoTable* table = nullptr;
+    uint32_t index = 0;
+    uint32_t stamp = 0;
+  };
+
+  MemoTable(std::string name, size_t arity);
+
+  // Returns the cached result for the arguments, or nullptr on a miss. The
+  // ticket is filled in if the result of the call can be cached.
+  auto find(std::span<const Value> args, Ticket& ticket) -> const Value*;
+
+  // Caches the result of the call the ticket was handed out for
+  static auto store(const Ticket& ticket, const Value& result) -> void;
+
+  auto name() const -> std::string_view { return name_m; }
+  auto hits() const -> size_t { return hits_m; }
+  auto misses() const -> size_t { return misses_m; }
+
+ private:
+  struct Entry {
+    Value result;
+    // Stamp of the last ticket for this entry, 0 if it was never claimed
+    uint32_t stamp = 0;
+    bool filled = false;
+  };
+
+  const std::string name_m;
+  const size_t arity;
+
+  // The arguments of every entry, `arity` encoded values each
+  std::vector<uint64_t> keys;
+  std::vector<Entry> entries;
+
+  uint32_t next_stamp;
+  size_t hits_m;
+  size_t misses_m;
+};
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_MEMO_H
@@ -4,13 +4,16 @@
 
 #include "Misc.h"
 
+#include <algorithm>
+#include <cctype>
+
 namespace loxalone {
 auto to_lowercase(const std::string_view& source) -> std::string {
-  return transform_chars(source, tolower);
+  return transform_chars(source, ::tolower);
 }
 
 auto to_uppercase(const std::string_view& source) -> std::string {
-  return transform_chars(source, toupper);
+  return transform_chars(source, ::toupper);
 }
 
 auto split(const std::string_view& source, char delim)
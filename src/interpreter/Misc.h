@@ -5,6 +5,7 @@
 #ifndef LOXALONE_MISC_H
 #define LOXALONE_MISC_H
 
+#include <functional>
 #include <string>
 #include <vector>
 
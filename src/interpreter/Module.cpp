@@ -0,0 +1,211 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Module.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <variant>
+
+#include "Error.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Scanner.h"
+#include "SourceFile.h"
+
+namespace loxalone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+auto normalize(const fs::path& path) -> fs::path {
+  std::error_code error{};
+  fs::path result = fs::weakly_canonical(path, error);
+  return error ? path.lexically_normal() : result;
+}
+
+}  // namespace
+
+auto display(const fs::path& path) -> std::string {
+  std::error_code error{};
+  fs::path result = fs::proximate(path, error);
+  return error ? path.string() : result.string();
+}
+
+ModuleLoader::ModuleLoader(const fs::path& script, size_t threads)
+    : threads{std::max<size_t>(threads, 1)} {
+  std::error_code error{};
+  if (script.empty()) {
+    directory = fs::current_path(error);
+    return;
+  }
+
+  fs::path path = normalize(fs::absolute(script, error));
+  directory = path.parent_path();
+  auto& module = modules[path.string()];
+  module = std::make_unique<Module>(path);
+  module->ok = true;
+  main = module.get();
+}
+
+ModuleLoader::~ModuleLoader() {
+  {
+    std::lock_guard guard{lock};
+    stopping = true;
+  }
+  changed.notify_all();
+  for (auto& worker : workers) worker.join();
+}
+
+auto ModuleLoader::load(List<Stmt> statements)
+    -> std::optional<std::vector<Module*>> {
+  std::vector<ImportPtr> imports{};
+  for (const auto& statement : statements) {
+    const auto* import = std::get_if<ImportPtr>(&statement);
+    if (import != nullptr && *import != nullptr) imports.push_back(*import);
+  }
+  if (imports.empty()) return std::vector<Module*>{};
+
+  for (const auto& import : imports) link(directory, *import);
+  drain();
+
+  // The modules are ordered starting from the script, so the errors are
+  // reported in the same order however the threads went
+  std::vector<Module*> path{};
+  if (main != nullptr) path.push_back(main);
+  std::vector<Module*> loaded{};
+  bool ok = true;
+  for (const auto& import : imports)
+    ok = order(*import->module_m, path, loaded) && ok;
+
+  // None of the modules are kept after an error, so they are loaded again by
+  // the next import of them
+  if (!ok) {
+    for (const auto* module : fresh) modules.erase(module->path.string());
+  }
+  fresh.clear();
+  if (!ok) return std::nullopt;
+  return loaded;
+}
+
+auto ModuleLoader::link(const fs::path& from, Import& import) -> void {
+  // The lexeme of the path still has its quotes
+  std::string_view lexeme = import.path_m.lexeme;
+  fs::path path = normalize(from / lexeme.substr(1, lexeme.size() - 2));
+
+  std::lock_guard guard{lock};
+  auto& module = modules[path.string()];
+  if (module == nullptr) {
+    module = std::make_unique<Module>(std::move(path));
+    fresh.push_back(module.get());
+    queue.push_back(module.get());
+    pending++;
+    changed.notify_all();
+  }
+  import.module_m = module.get();
+}
+
+auto ModuleLoader::load_module(Module& module) -> void {
+  ErrorCapture capture{module.errors};
+
+  std::string error{};
+  auto source = SourceFile::load(module.path.string(), error);
+  if (!source.has_value()) {
+    module.errors = fmt::format("{}\n", error);
+    return;
+  }
+
+  std::string_view text =
+      module.arena.make<SourceFile>(std::move(*source))->text();
+  Scanner scanner{text};
+  Parser parser{scanner, module.arena};
+  std::vector<Stmt> statements = parser.parse();
+  if (!parser.well_formed()) return;
+  module.statements = module.arena.list(std::move(statements));
+
+  try {
+    Resolver resolver{};
+    resolver.resolve(module.statements);
+  } catch (const RuntimeError& err) {
+    report(err.token.line, "", err.msg);
+    return;
+  }
+
+  module.ok = true;
+  for (const auto& statement : module.statements) {
+    const auto* import = std::get_if<ImportPtr>(&statement);
+    if (import == nullptr) continue;
+    module.imports.push_back(*import);
+    link(module.path.parent_path(), **import);
+  }
+}
+
+auto ModuleLoader::drain() -> void {
+  std::unique_lock guard{lock};
+  // The calling thread loads modules too, the others start with the first
+  // import
+  while (workers.size() + 1 < threads)
+    workers.emplace_back([this] { work(); });
+
+  while (true) {
+    changed.wait(guard, [this] { return pending == 0 || !queue.empty(); });
+    if (queue.empty()) return;
+    load_next(guard);
+  }
+}
+
+auto ModuleLoader::work() -> void {
+  std::unique_lock guard{lock};
+  while (true) {
+    changed.wait(guard, [this] { return stopping || !queue.empty(); });
+    if (stopping) return;
+    load_next(guard);
+  }
+}
+
+auto ModuleLoader::load_next(std::unique_lock<std::mutex>& guard) -> void {
+  Module* module = queue.front();
+  queue.pop_front();
+  guard.unlock();
+  load_module(*module);
+  guard.lock();
+  if (--pending == 0) changed.notify_all();
+}
+
+auto ModuleLoader::order(Module& module, std::vector<Module*>& path,
+                         std::vector<Module*>& loaded) -> bool {
+  auto cycle = std::find(path.begin(), path.end(), &module);
+  if (cycle != path.end()) {
+    std::string modules{};
+    for (auto it = cycle; it != path.end(); ++it)
+      modules += fmt::format("{} -> ", display((*it)->path));
+    fmt::print(stderr, "Circular import: {}{}\n", modules,
+               display(module.path));
+    return false;
+  }
+  if (module.ordered) return true;
+  module.ordered = true;
+
+  if (!module.ok) {
+    fmt::print(stderr, "Could not import {}:\n{}", display(module.path),
+               module.errors);
+    return false;
+  }
+
+  path.push_back(&module);
+  bool ok = true;
+  for (const auto& import : module.imports)
+    ok = order(*import->module_m, path, loaded) && ok;
+  path.pop_back();
+
+  loaded.push_back(&module);
+  return ok;
+}
+
+}  // namespace loxalone
@@ -0,0 +1,119 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_MODULE_H
+#define LOXALONE_MODULE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Arena.h"
+#include "Stmt.h"
+
+namespace loxalone {
+
+// Module is a script loaded by an `import`. Its syntax tree lives in its own
+// arena, so modules can be parsed on several threads at once.
+class Module {
+ public:
+  explicit Module(std::filesystem::path path) : path{std::move(path)} {}
+
+  // The canonical path of the script
+  const std::filesystem::path path;
+  Arena arena{};
+  // Replaced by the optimized statements before the module runs
+  List<Stmt> statements{};
+  // The imports among the statements, in order
+  std::vector<ImportPtr> imports{};
+  // The errors found while loading it, printed once all modules are loaded
+  std::string errors{};
+  bool ok = false;
+  // Set once the loader has put it in dependency order
+  bool ordered = false;
+};
+
+// Returns the path of a module as it's reported, relative to the working
+// directory
+auto display(const std::filesystem::path& path) -> std::string;
+
+/*
+ * ModuleLoader loads the modules imported by a script and caches them by their
+ * canonical path, so a module is loaded once however many scripts import it.
+ * Import paths are relative to the directory of the importing script.
+ *
+ * Imports are only allowed at the top level, so the modules a script imports
+ * are known as soon as it's parsed. Loading runs on a pool of threads: a
+ * module is read, scanned, parsed and resolved on one thread, so its errors
+ * are reported before anything runs whichever engine runs it. The modules
+ * it imports in turn are queued as soon as it's loaded, so the rest of the
+ * imports are discovered while the first modules are still being parsed.
+ *
+ * Nothing runs while loading. A module runs at the first import of it that
+ * runs, which runs the modules it imports first, so the engines define the
+ * globals of the modules in dependency order.
+ * */
+class ModuleLoader {
+ public:
+  // `script` is the path of the main script, or empty for the prompt, where
+  // imports are relative to the working directory. Modules are loaded on
+  // `threads` threads, including the calling one.
+  ModuleLoader(const std::filesystem::path& script, size_t threads);
+  ModuleLoader(const ModuleLoader&) = delete;
+  auto operator=(const ModuleLoader&) -> ModuleLoader& = delete;
+  ~ModuleLoader();
+
+  // Loads the modules imported by the statements of the main script, and the
+  // modules those import, and links every import to its module. Returns the
+  // modules loaded for the first time in dependency order. If any of them
+  // can't be loaded or they import each other in a cycle, the errors are
+  // reported and nullopt is returned.
+  auto load(List<Stmt> statements) -> std::optional<std::vector<Module*>>;
+
+ private:
+  // Finds the module of the import in the cache, or queues it to be loaded.
+  // `from` is the directory of the importing script.
+  auto link(const std::filesystem::path& from, Import& import) -> void;
+  auto load_module(Module& module) -> void;
+  // Loads the first queued module, the lock is released meanwhile
+  auto load_next(std::unique_lock<std::mutex>& guard) -> void;
+  // Loads the queued modules until there are none left to load
+  auto drain() -> void;
+  // The loop of the other threads of the pool
+  auto work() -> void;
+  // Adds the module to `loaded` after the modules it imports, `path` are the
+  // modules importing it. Returns false after reporting the errors of the
+  // modules or a cycle.
+  auto order(Module& module, std::vector<Module*>& path,
+             std::vector<Module*>& loaded) -> bool;
+
+  std::filesystem::path directory;
+  size_t threads;
+  // Stands for the main script, so that importing it is seen as a cycle
+  Module* main{};
+  std::unordered_map<std::string, std::unique_ptr<Module>> modules{};
+  // The modules of the current `load`, in the order they were found
+  std::vector<Module*> fresh{};
+
+  std::mutex lock{};
+  // Signals new modules in the queue, the last one loaded and stopping
+  std::condition_variable changed{};
+  std::deque<Module*> queue{};
+  // Queued or being loaded
+  size_t pending = 0;
+  bool stopping = false;
+  std::vector<std::thread> workers{};
+};
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_MODULE_H
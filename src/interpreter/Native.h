@@ -0,0 +1,216 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_NATIVE_H
+#define LOXALONE_NATIVE_H
+
+#include <fmt/format.h>
+
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "Array.h"
+#include "Collections.h"
+#include "Error.h"
+#include "LoxCallable.h"
+#include "Value.h"
+
+namespace loxalone {
+
+// NativeArg converts a lox value to a parameter of a native function. Only
+// the types below can be parameters, `Value` takes any value unchecked.
+template <typename T>
+struct NativeArg;
+
+template <>
+struct NativeArg<double> {
+  static constexpr std::string_view type = "number";
+  static auto is(const Value& value) -> bool { return value.is_number(); }
+  static auto get(const Value& value) -> double { return value.as_number(); }
+};
+
+template <>
+struct NativeArg<bool> {
+  static constexpr std::string_view type = "boolean";
+  static auto is(const Value& value) -> bool { return value.is_bool(); }
+  static auto get(const Value& value) -> bool { return value.as_bool(); }
+};
+
+template <>
+struct NativeArg<std::string_view> {
+  static constexpr std::string_view type = "string";
+  static auto is(const Value& value) -> bool { return value.is_string(); }
+  static auto get(const Value& value) -> std::string_view {
+    return value.as_string_view();
+  }
+};
+
+template <>
+struct NativeArg<std::string> {
+  static constexpr std::string_view type = "string";
+  static auto is(const Value& value) -> bool { return value.is_string(); }
+  static auto get(const Value& value) -> const std::string& {
+    return value.as_string();
+  }
+};
+
+template <>
+struct NativeArg<ArrayObj> {
+  static constexpr std::string_view type = "array";
+  static auto is(const Value& value) -> bool { return value.is_array(); }
+  static auto get(const Value& value) -> ArrayObj& {
+    return *value.as<ArrayObj>();
+  }
+};
+
+template <>
+struct NativeArg<ListObj> {
+  static constexpr std::string_view type = "list";
+  static auto is(const Value& value) -> bool { return value.is_list(); }
+  static auto get(const Value& value) -> ListObj& {
+    return *value.as<ListObj>();
+  }
+};
+
+template <>
+struct NativeArg<MapObj> {
+  static constexpr std::string_view type = "map";
+  static auto is(const Value& value) -> bool { return value.is_map(); }
+  static auto get(const Value& value) -> MapObj& { return *value.as<MapObj>(); }
+};
+
+// The interned string itself, e.g. to look up the key of a map
+template <>
+struct NativeArg<StringObj> {
+  static constexpr std::string_view type = "string";
+  static auto is(const Value& value) -> bool { return value.is_string(); }
+  static auto get(const Value& value) -> StringObj& {
+    return *value.as_string_obj();
+  }
+};
+
+// Functions, classes and bound methods, to be called with `Engine::call_back`
+template <>
+struct NativeArg<LoxCallable> {
+  static constexpr std::string_view type = "function";
+  static auto is(const Value& value) -> bool { return value.is_callable(); }
+  static auto get(const Value& value) -> LoxCallable& {
+    return *value.as<LoxCallable>();
+  }
+};
+
+template <>
+struct NativeArg<Value> {
+  static constexpr std::string_view type = "value";
+  static auto is(const Value&) -> bool { return true; }
+  static auto get(const Value& value) -> const Value& { return value; }
+};
+
+// The arguments of natives taking the engine. A call back into lox may grow
+// the value stack the arguments live on and move them, so even a `const
+// Value&` parameter gets a copy. The objects the other parameters refer to
+// stay where they are, the moved values still keep them alive.
+template <typename T>
+struct CallbackArg : NativeArg<T> {};
+
+template <>
+struct CallbackArg<Value> : NativeArg<Value> {
+  static auto get(const Value& value) -> Value { return value; }
+};
+
+// Converts the result of a native function back to a lox value
+template <typename R>
+auto native_result(R&& result) -> Value {
+  using T = std::remove_cvref_t<R>;
+  if constexpr (std::same_as<T, Value> || std::same_as<T, bool> ||
+                std::same_as<T, std::string> ||
+                std::same_as<T, std::string_view>) {
+    return Value{std::forward<R>(result)};
+  } else {
+    static_assert(std::is_arithmetic_v<T>, "Unsupported native result type");
+    return Value{static_cast<double>(result)};
+  }
+}
+
+// NativeSignature takes the function pointer type of a native apart, so the
+// arity and the argument checks are known at compile time
+template <typename F>
+struct NativeSignature;
+
+template <typename R, typename... Params>
+struct NativeSignature<R (*)(Params...)> {
+  static constexpr int arity = sizeof...(Params);
+
+  // Called by the engines with exactly `arity` arguments
+  template <auto Fn>
+  static auto call(Engine&, Args args) -> Value {
+    return invoke(Fn, args, std::index_sequence_for<Params...>{});
+  }
+
+ protected:
+  // `Arg` converts the arguments, either `NativeArg` or `CallbackArg`
+  template <template <typename> typename Arg = NativeArg, typename F,
+            size_t... I>
+  static auto invoke(F&& fn, Args args, std::index_sequence<I...>) -> Value {
+    (check<std::remove_cvref_t<Params>>(args[I], I), ...);
+    if constexpr (std::is_void_v<R>) {
+      fn(Arg<std::remove_cvref_t<Params>>::get(args[I])...);
+      return {};
+    } else {
+      return native_result(
+          fn(Arg<std::remove_cvref_t<Params>>::get(args[I])...));
+    }
+  }
+
+ private:
+
+  template <typename T>
+  static auto check(const Value& value, size_t index) -> void {
+    if (NativeArg<T>::is(value)) return;
+
+    constexpr std::string_view type = NativeArg<T>::type;
+    constexpr bool vowel = std::string_view{"aeiou"}.find(type[0]) !=
+                           std::string_view::npos;
+    throw NativeError{fmt::format("Argument {} must be {} {}.", index + 1,
+                                  vowel ? "an" : "a", type)};
+  }
+};
+
+// Natives taking the engine as their first parameter can call back into lox,
+// the engine isn't one of the arguments of the lox call
+template <typename R, typename... Params>
+struct NativeSignature<R (*)(Engine&, Params...)>
+    : NativeSignature<R (*)(Params...)> {
+  template <auto Fn>
+  static auto call(Engine& engine, Args args) -> Value {
+    auto fn = [&engine](auto&&... params) -> R {
+      return Fn(engine, std::forward<decltype(params)>(params)...);
+    };
+    return NativeSignature::template invoke<CallbackArg>(
+        fn, args, std::index_sequence_for<Params...>{});
+  }
+};
+
+template <typename R, typename... Params>
+struct NativeSignature<R (*)(Params...) noexcept>
+    : NativeSignature<R (*)(Params...)> {};
+
+// Wraps the C++ function `Fn` as a lox native. The arguments are checked
+// against the parameter types and passed straight from the value stack, e.g.
+// `make_native<&repeat>("repeat")` for `std::string repeat(std::string_view,
+// double)` checks for a string and a number.
+template <auto Fn>
+auto make_native(std::string_view name) -> Ref<NativeCallable> {
+  using Signature = NativeSignature<decltype(Fn)>;
+  return make_ref<NativeCallable>(name, Signature::arity,
+                                  &Signature::template call<Fn>);
+}
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_NATIVE_H
@@ -0,0 +1,63 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "NativeStack.h"
+
+#include <pthread.h>
+
+namespace loxalone {
+
+auto native_stack_limit() -> uintptr_t {
+  // The stack grows down from the end of the range
+#if defined(__APPLE__)
+  pthread_t self = pthread_self();
+  auto end = reinterpret_cast<uintptr_t>(pthread_get_stackaddr_np(self));
+  uintptr_t low = end - pthread_get_stacksize_np(self);
+#elif defined(__linux__)
+  pthread_attr_t attr;
+  if (pthread_getattr_np(pthread_self(), &attr) != 0) return 0;
+  void* address = nullptr;
+  size_t size = 0;
+  int error = pthread_attr_getstack(&attr, &address, &size);
+  pthread_attr_destroy(&attr);
+  if (error != 0) return 0;
+  auto low = reinterpret_cast<uintptr_t>(address);
+#else
+  uintptr_t low = 0;
+#endif
+  return low == 0 ? 0 : low + NATIVE_STACK_MARGIN;
+}
+
+namespace {
+
+struct Task {
+  const std::function<int()>& run;
+  int result;
+};
+
+auto start(void* task) -> void* {
+  auto* self = static_cast<Task*>(task);
+  self->result = self->run();
+  return nullptr;
+}
+
+}  // namespace
+
+auto run_with_stack(size_t size, const std::function<int()>& run) -> int {
+  if (size == 0) return run();
+
+  pthread_attr_t attr;
+  if (pthread_attr_init(&attr) != 0) return run();
+  Task task{run, 0};
+  pthread_t thread;
+  bool started = pthread_attr_setstacksize(&attr, size) == 0 &&
+                 pthread_create(&thread, &attr, &start, &task) == 0;
+  pthread_attr_destroy(&attr);
+  if (!started) return run();
+
+  pthread_join(thread, nullptr);
+  return task.result;
+}
+
+}  // namespace loxalone
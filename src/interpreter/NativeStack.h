@@ -0,0 +1,43 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_NATIVESTACK_H
+#define LOXALONE_NATIVESTACK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace loxalone {
+
+// The tree-walking interpreter runs a lox call as nested C++ calls, so how
+// deep lox calls can nest depends on the C++ stack of the thread running it.
+
+// The deepest calls can nest on the tree-walking interpreter, whatever limit
+// it's given
+inline constexpr size_t MAX_NATIVE_CALL_DEPTH = 1 << 16;
+// C++ stack taken by a lox call, with room for nested expressions in it
+inline constexpr size_t NATIVE_CALL_SIZE = 16 * 1024;
+// C++ stack kept free below the deepest call, e.g. for the natives it calls
+inline constexpr size_t NATIVE_STACK_MARGIN = 256 * 1024;
+
+// Size of a C++ stack with room for calls nested `max_call_depth` deep
+constexpr auto native_stack_size(size_t max_call_depth) -> size_t {
+  return std::min(max_call_depth, MAX_NATIVE_CALL_DEPTH) * NATIVE_CALL_SIZE +
+         NATIVE_STACK_MARGIN;
+}
+
+// Address of the calling thread's stack below which it's about to run out,
+// the margin included. 0 if the stack of the thread can't be found.
+auto native_stack_limit() -> uintptr_t;
+
+// Runs `run` on a new thread with a stack of `size` bytes and returns its
+// result. It runs on the calling thread instead if `size` is 0 or the thread
+// can't be created.
+auto run_with_stack(size_t size, const std::function<int()>& run) -> int;
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_NATIVESTACK_H
@@ -0,0 +1,551 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Optimizer.h"
+
+namespace loxalone {
+
+namespace {
+
+// Counts the nodes of a syntax tree, used to account for removed subtrees
+struct NodeCounter {
+  auto operator()(const BinaryPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->left_m) + count(expr->right_m);
+  }
+  auto operator()(const GroupingPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->expression_m);
+  }
+  auto operator()(const ListLiteralPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->elements_m);
+  }
+  auto operator()(const LiteralPtr &expr) -> size_t { return expr ? 1 : 0; }
+  auto operator()(const MapLiteralPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->keys_m) + count(expr->values_m);
+  }
+  auto operator()(const UnaryPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->right_m);
+  }
+  auto operator()(const VariablePtr &expr) -> size_t { return expr ? 1 : 0; }
+  auto operator()(const AssignPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->value_m);
+  }
+  auto operator()(const LogicalPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->left_m) + count(expr->right_m);
+  }
+  auto operator()(const CallPtr &expr) -> size_t {
+    if (!expr) return 0;
+    size_t n = 1 + count(expr->callee_m);
+    for (const auto &arg : expr->arguments_m) n += count(arg);
+    return n;
+  }
+  auto operator()(const GetPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->object_m);
+  }
+  auto operator()(const SetPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->object_m) + count(expr->value_m);
+  }
+  auto operator()(const IndexPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->object_m) + count(expr->index_m);
+  }
+  auto operator()(const SetIndexPtr &expr) -> size_t {
+    if (!expr) return 0;
+    return 1 + count(expr->object_m) + count(expr->index_m) +
+           count(expr->value_m);
+  }
+  auto operator()(const SuperPtr &expr) -> size_t { return expr ? 1 : 0; }
+  auto operator()(const ThisPtr &expr) -> size_t { return expr ? 1 : 0; }
+
+  auto operator()(const BlockPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->statements_m);
+  }
+  auto operator()(const ExpressionPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->expression_m);
+  }
+  auto operator()(const FunctionPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->body_m);
+  }
+  auto operator()(const PrintPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->expression_m);
+  }
+  auto operator()(const VarPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->initializer_m);
+  }
+  auto operator()(const IfPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->expression_m) + count(stmt->then_branch_m) +
+           count(stmt->else_branch_m);
+  }
+  auto operator()(const WhilePtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->condition_m) + count(stmt->body_m);
+  }
+  auto operator()(const ForInPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->iterable_m) + count(stmt->body_m);
+  }
+  auto operator()(const ReturnPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    return 1 + count(stmt->value_m);
+  }
+  auto operator()(const ClassPtr &stmt) -> size_t {
+    if (!stmt) return 0;
+    size_t n = 1 + count(stmt->superclass_m);
+    for (const auto &method : stmt->methods_m) n += (*this)(method);
+    return n;
+  }
+  auto operator()(const ImportPtr &stmt) -> size_t { return stmt ? 1 : 0; }
+
+  auto count(const Expr &expr) -> size_t { return visit(*this, expr); }
+  auto count(const Stmt &stmt) -> size_t { return visit(*this, stmt); }
+  auto count(List<Stmt> stmts) -> size_t {
+    size_t n = 0;
+    for (const auto &stmt : stmts) n += count(stmt);
+    return n;
+  }
+  auto count(List<Expr> exprs) -> size_t {
+    size_t n = 0;
+    for (const auto &expr : exprs) n += count(expr);
+    return n;
+  }
+};
+
+auto count(const Expr &expr) -> size_t { return NodeCounter{}.count(expr); }
+auto count(const Stmt &stmt) -> size_t { return NodeCounter{}.count(stmt); }
+
+// Returns the literal node if the expression is one
+auto as_literal(const Expr &expr) -> LiteralPtr {
+  const auto *literal = std::get_if<LiteralPtr>(&expr);
+  return literal != nullptr ? *literal : nullptr;
+}
+
+}  // namespace
+
+auto Optimizer::optimize(List<Stmt> stmts) -> List<Stmt> {
+  auto optimized = optimize_list(stmts);
+  if (!optimized.has_value()) return stmts;
+  return arena.list(std::move(optimized.value()));
+}
+
+auto Optimizer::optimize(const Stmt &stmt) -> Stmt {
+  return visit(*this, stmt);
+}
+
+auto Optimizer::optimize(const Expr &expr) -> Expr {
+  return visit(*this, expr);
+}
+
+auto Optimizer::optimize_exprs(List<Expr> exprs, bool &changed)
+    -> std::vector<Expr> {
+  std::vector<Expr> optimized{};
+  optimized.reserve(exprs.size());
+  for (const auto &expr : exprs) {
+    optimized.emplace_back(optimize(expr));
+    changed |= optimized.back() != expr;
+  }
+  return optimized;
+}
+
+auto Optimizer::optimize_list(List<Stmt> stmts)
+    -> std::optional<std::vector<Stmt>> {
+  std::vector<Stmt> result{};
+  result.reserve(stmts.size());
+
+  bool changed = false;
+  for (size_t i = 0; i < stmts.size(); i++) {
+    Stmt stmt = optimize(stmts[i]);
+    changed |= stmt != stmts[i];
+    if (stmt_is_null(stmt)) continue;
+    result.emplace_back(stmt);
+
+    // Nothing after a return statement is ever run
+    if (std::holds_alternative<ReturnPtr>(stmt)) {
+      for (size_t j = i + 1; j < stmts.size(); j++) {
+        removed_m += count(stmts[j]);
+        changed = true;
+      }
+      break;
+    }
+  }
+
+  if (!changed) return std::nullopt;
+  return result;
+}
+
+auto Optimizer::operator()(const BinaryPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr left = optimize(expr->left_m);
+  Expr right = optimize(expr->right_m);
+
+  auto *l = as_literal(left), *r = as_literal(right);
+  if (l != nullptr && r != nullptr) {
+    if (auto value = fold(expr->oper_m, l->value_m, r->value_m)) {
+      removed_m += 2;
+      return Literal::create(arena, std::move(value.value()));
+    }
+  }
+
+  if (left == expr->left_m && right == expr->right_m) return expr;
+  return Binary::create(arena, std::move(left), Token{expr->oper_m},
+                        std::move(right));
+}
+
+auto Optimizer::operator()(const GroupingPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  // The grouping is already reflected in the shape of the tree
+  removed_m++;
+  return optimize(expr->expression_m);
+}
+
+auto Optimizer::operator()(const ListLiteralPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  bool changed = false;
+  auto elements = optimize_exprs(expr->elements_m, changed);
+  if (!changed) return expr;
+  return ListLiteral::create(arena, Token{expr->bracket_m},
+                             std::move(elements));
+}
+
+auto Optimizer::operator()(const LiteralPtr &expr) -> Expr { return expr; }
+
+auto Optimizer::operator()(const MapLiteralPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  bool changed = false;
+  auto keys = optimize_exprs(expr->keys_m, changed);
+  auto values = optimize_exprs(expr->values_m, changed);
+  if (!changed) return expr;
+  return MapLiteral::create(arena, Token{expr->brace_m}, std::move(keys),
+                            std::move(values));
+}
+
+auto Optimizer::operator()(const UnaryPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr right = optimize(expr->right_m);
+  if (auto *r = as_literal(right)) {
+    if (auto value = fold(expr->oper_m, r->value_m)) {
+      removed_m++;
+      return Literal::create(arena, std::move(value.value()));
+    }
+  }
+
+  if (right == expr->right_m) return expr;
+  return Unary::create(arena, Token{expr->oper_m}, std::move(right));
+}
+
+auto Optimizer::operator()(const VariablePtr &expr) -> Expr { return expr; }
+
+auto Optimizer::operator()(const AssignPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr value = optimize(expr->value_m);
+  if (value == expr->value_m) return expr;
+
+  auto assign = Assign::create(arena, Token{expr->name_m}, std::move(value));
+  assign->slot_m = expr->slot_m;
+  return assign;
+}
+
+auto Optimizer::operator()(const LogicalPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr left = optimize(expr->left_m);
+  Expr right = optimize(expr->right_m);
+
+  // The interpreter only accepts a boolean on the left side, anything else
+  // is left for it to report
+  if (auto *l = as_literal(left); l != nullptr && l->value_m.is_bool()) {
+    bool is_or = expr->oper_m.type == TokenType::OR;
+    if (l->value_m.as_bool() == is_or) {
+      // Short-circuits to the left side, the right side is never evaluated
+      removed_m += 1 + count(right);
+      return left;
+    }
+    removed_m += 2;
+    return right;
+  }
+
+  if (left == expr->left_m && right == expr->right_m) return expr;
+  return Logical::create(arena, std::move(left), Token{expr->oper_m},
+                         std::move(right));
+}
+
+auto Optimizer::operator()(const CallPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr callee = optimize(expr->callee_m);
+  bool changed = callee != expr->callee_m;
+
+  std::vector<Expr> args{};
+  args.reserve(expr->arguments_m.size());
+  for (const auto &arg : expr->arguments_m) {
+    args.emplace_back(optimize(arg));
+    changed |= args.back() != arg;
+  }
+
+  if (!changed) return expr;
+  return Call::create(arena, std::move(callee), Token{expr->paren_m},
+                      std::move(args));
+}
+
+auto Optimizer::operator()(const GetPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr object = optimize(expr->object_m);
+  if (object == expr->object_m) return expr;
+  return Get::create(arena, std::move(object), Token{expr->name_m});
+}
+
+auto Optimizer::operator()(const SetPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr object = optimize(expr->object_m);
+  Expr value = optimize(expr->value_m);
+  if (object == expr->object_m && value == expr->value_m) return expr;
+  return Set::create(arena, std::move(object), Token{expr->name_m},
+                     std::move(value));
+}
+
+auto Optimizer::operator()(const IndexPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr object = optimize(expr->object_m);
+  Expr index = optimize(expr->index_m);
+  if (object == expr->object_m && index == expr->index_m) return expr;
+  return Index::create(arena, std::move(object), Token{expr->bracket_m},
+                       std::move(index));
+}
+
+auto Optimizer::operator()(const SetIndexPtr &expr) -> Expr {
+  if (!expr) return expr;
+
+  Expr object = optimize(expr->object_m);
+  Expr index = optimize(expr->index_m);
+  Expr value = optimize(expr->value_m);
+  if (object == expr->object_m && index == expr->index_m &&
+      value == expr->value_m)
+    return expr;
+  return SetIndex::create(arena, std::move(object), Token{expr->bracket_m},
+                          std::move(index), std::move(value));
+}
+
+auto Optimizer::operator()(const SuperPtr &expr) -> Expr { return expr; }
+
+auto Optimizer::operator()(const ThisPtr &expr) -> Expr { return expr; }
+
+auto Optimizer::operator()(const BlockPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  auto statements = optimize_list(stmt->statements_m);
+  if (!statements.has_value()) return stmt;
+  return Block::create(arena, std::move(statements.value()));
+}
+
+auto Optimizer::operator()(const ExpressionPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  Expr expression = optimize(stmt->expression_m);
+
+  // A literal on its own doesn't do anything
+  if (as_literal(expression) != nullptr) {
+    removed_m += 2;
+    return Block::empty();
+  }
+
+  if (expression == stmt->expression_m) return stmt;
+  return Expression::create(arena, std::move(expression));
+}
+
+auto Optimizer::operator()(const FunctionPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  auto body = optimize_list(stmt->body_m);
+  if (!body.has_value()) return stmt;
+
+  auto function = Function::create(
+      arena, Token{stmt->name_m},
+      std::vector<Token>{stmt->params_m.begin(), stmt->params_m.end()},
+      std::move(body.value()));
+  function->slot_m = stmt->slot_m;
+  function->layout_m = stmt->layout_m;
+  function->memo_m = stmt->memo_m;
+  return function;
+}
+
+auto Optimizer::operator()(const PrintPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  Expr expression = optimize(stmt->expression_m);
+  if (expression == stmt->expression_m) return stmt;
+  return Print::create(arena, std::move(expression));
+}
+
+auto Optimizer::operator()(const VarPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  Expr initializer = optimize(stmt->initializer_m);
+  if (initializer == stmt->initializer_m) return stmt;
+
+  auto var = Var::create(arena, Token{stmt->name_m}, std::move(initializer));
+  var->slot_m = stmt->slot_m;
+  return var;
+}
+
+auto Optimizer::operator()(const IfPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  Expr condition = optimize(stmt->expression_m);
+  Stmt then_branch = optimize(stmt->then_branch_m);
+  Stmt else_branch = optimize(stmt->else_branch_m);
+
+  // Only the branch that is taken is kept, the other one is dead code
+  if (auto *c = as_literal(condition); c != nullptr && c->value_m.is_bool()) {
+    removed_m += 2;
+    if (c->value_m.as_bool()) {
+      removed_m += count(else_branch);
+      return then_branch;
+    }
+    removed_m += count(then_branch);
+    return else_branch;
+  }
+
+  if (condition == stmt->expression_m && then_branch == stmt->then_branch_m &&
+      else_branch == stmt->else_branch_m)
+    return stmt;
+  return If::create(arena, std::move(condition), Token{stmt->token_m},
+                    std::move(then_branch), std::move(else_branch));
+}
+
+auto Optimizer::operator()(const WhilePtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  Expr condition = optimize(stmt->condition_m);
+  Stmt body = optimize(stmt->body_m);
+
+  // A loop that never runs its body
+  if (auto *c = as_literal(condition);
+      c != nullptr && c->value_m.is_bool() && !c->value_m.as_bool()) {
+    removed_m += 2 + count(body);
+    return Block::empty();
+  }
+
+  if (condition == stmt->condition_m && body == stmt->body_m) return stmt;
+  return While::create(arena, std::move(condition), std::move(body),
+                       Token{stmt->token_m});
+}
+
+auto Optimizer::operator()(const ForInPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  Expr iterable = optimize(stmt->iterable_m);
+  Stmt body = optimize(stmt->body_m);
+  if (iterable == stmt->iterable_m && body == stmt->body_m) return stmt;
+  return ForIn::create(arena, Token{stmt->name_m}, std::move(iterable),
+                       std::move(body), Token{stmt->token_m});
+}
+
+auto Optimizer::operator()(const ReturnPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  Expr value = optimize(stmt->value_m);
+  if (value == stmt->value_m) return stmt;
+  return Return::create(arena, Token{stmt->keyword_m}, std::move(value));
+}
+
+auto Optimizer::operator()(const ClassPtr &stmt) -> Stmt {
+  if (!stmt) return stmt;
+
+  bool changed = false;
+  std::vector<FunctionPtr> methods{};
+  for (const auto &method : stmt->methods_m) {
+    methods.emplace_back(std::get<FunctionPtr>((*this)(method)));
+    changed = changed || methods.back() != method;
+  }
+  if (!changed) return stmt;
+
+  auto cls = Class::create(arena, Token{stmt->name_m},
+                           Expr{stmt->superclass_m}, std::move(methods));
+  cls->slot_m = stmt->slot_m;
+  cls->super_slot_m = stmt->super_slot_m;
+  return cls;
+}
+
+// The module is optimized on its own when it's loaded
+auto Optimizer::operator()(const ImportPtr &stmt) -> Stmt { return stmt; }
+
+auto Optimizer::fold(const Token &oper, const Value &left, const Value &right)
+    -> std::optional<Value> {
+  // Same rules as the interpreter, see `Interpreter::operator()(BinaryPtr)`
+  bool numbers = left.is_number() && right.is_number();
+  switch (oper.type) {
+    case TokenType::MINUS:
+      if (numbers) return left.as_number() - right.as_number();
+      break;
+    case TokenType::PLUS:
+      if (numbers) return left.as_number() + right.as_number();
+      if (left.is_string() && right.is_string())
+        return concatenate(left, right);
+      break;
+    case TokenType::SLASH:
+      if (numbers) return left.as_number() / right.as_number();
+      break;
+    case TokenType::STAR:
+      if (numbers) return left.as_number() * right.as_number();
+      break;
+    case TokenType::GREATER:
+      if (numbers) return left.as_number() > right.as_number();
+      break;
+    case TokenType::GREATER_EQUAL:
+      if (numbers) return left.as_number() >= right.as_number();
+      break;
+    case TokenType::LESS:
+      if (numbers) return left.as_number() < right.as_number();
+      break;
+    case TokenType::LESS_EQUAL:
+      if (numbers) return left.as_number() <= right.as_number();
+      break;
+    case TokenType::EQUAL_EQUAL:
+      return left == right;
+    case TokenType::BANG_EQUAL:
+      return left != right;
+    default:
+      break;
+  }
+  return std::nullopt;
+}
+
+auto Optimizer::fold(const Token &oper, const Value &right)
+    -> std::optional<Value> {
+  switch (oper.type) {
+    case TokenType::MINUS:
+      if (right.is_number()) return -right.as_number();
+      break;
+    case TokenType::BANG:
+      if (right.is_bool()) return !right.as_bool();
+      break;
+    default:
+      break;
+  }
+  return std::nullopt;
+}
+
+}  // namespace loxalone
@@ -0,0 +1,97 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_OPTIMIZER_H
+#define LOXALONE_OPTIMIZER_H
+
+#include <cstddef>
+#include <optional>
+
+#include "Arena.h"
+#include "Expr.h"
+#include "Stmt.h"
+#include "Token.h"
+
+namespace loxalone {
+
+/*
+ * Optimizer rewrites the syntax tree ahead of execution. It folds operations
+ * on literals into a single literal, drops the branches of conditions that
+ * are known ahead of time and removes the statements that can never run.
+ *
+ * The nodes of the tree are immutable, so a node is only recreated in the
+ * arena if any of its children changed, the rest of the tree is shared with
+ * the original. Operations that would fail at runtime (e.g. adding a number
+ * to a string) are left untouched, so they still report their errors when
+ * they are run.
+ *
+ * The annotations of the resolver are carried over to the recreated nodes,
+ * so the optimizer runs after the resolver and before the interpreter.
+ * */
+class Optimizer {
+ public:
+  explicit Optimizer(Arena &arena) : arena{arena}, removed_m{0} {}
+
+  // Returns the optimized statements, the given ones are left untouched
+  auto optimize(List<Stmt>) -> List<Stmt>;
+
+  // Number of nodes removed from the tree so far
+  auto removed() const -> size_t { return removed_m; }
+
+  // Expression visitor
+  auto operator()(const BinaryPtr &expr) -> Expr;
+  auto operator()(const GroupingPtr &expr) -> Expr;
+  auto operator()(const IndexPtr &expr) -> Expr;
+  auto operator()(const ListLiteralPtr &expr) -> Expr;
+  auto operator()(const LiteralPtr &expr) -> Expr;
+  auto operator()(const MapLiteralPtr &expr) -> Expr;
+  auto operator()(const UnaryPtr &expr) -> Expr;
+  auto operator()(const VariablePtr &expr) -> Expr;
+  auto operator()(const AssignPtr &expr) -> Expr;
+  auto operator()(const LogicalPtr &expr) -> Expr;
+  auto operator()(const CallPtr &expr) -> Expr;
+  auto operator()(const GetPtr &expr) -> Expr;
+  auto operator()(const SetPtr &expr) -> Expr;
+  auto operator()(const SetIndexPtr &expr) -> Expr;
+  auto operator()(const SuperPtr &expr) -> Expr;
+  auto operator()(const ThisPtr &expr) -> Expr;
+
+  // Statement visitors, a removed statement is returned as an empty one
+  auto operator()(const BlockPtr &stmt) -> Stmt;
+  auto operator()(const ExpressionPtr &stmt) -> Stmt;
+  auto operator()(const FunctionPtr &stmt) -> Stmt;
+  auto operator()(const PrintPtr &stmt) -> Stmt;
+  auto operator()(const VarPtr &stmt) -> Stmt;
+  auto operator()(const IfPtr &stmt) -> Stmt;
+  auto operator()(const WhilePtr &stmt) -> Stmt;
+  auto operator()(const ForInPtr &stmt) -> Stmt;
+  auto operator()(const ReturnPtr &stmt) -> Stmt;
+  auto operator()(const ClassPtr &stmt) -> Stmt;
+  auto operator()(const ImportPtr &stmt) -> Stmt;
+
+ private:
+  auto optimize(const Stmt &) -> Stmt;
+  auto optimize(const Expr &) -> Expr;
+
+  // Optimizes the statements, returns nothing if none of them changed
+  auto optimize_list(List<Stmt>) -> std::optional<std::vector<Stmt>>;
+  // Optimizes the expressions, `changed` is set if any of them changed
+  auto optimize_exprs(List<Expr>, bool &changed) -> std::vector<Expr>;
+
+  // Evaluates the operator on literal operands, returns nothing if it would
+  // fail at runtime
+  static auto fold(const Token &oper, const Value &left, const Value &right)
+      -> std::optional<Value>;
+  static auto fold(const Token &oper, const Value &right)
+      -> std::optional<Value>;
+
+  Arena &arena;
+  size_t removed_m;
+};
+
+static_assert(ExprVisitor<Optimizer, Expr>);
+static_assert(StmtVisitor<Optimizer, Stmt>);
+}  // namespace loxalone
+
+#endif  // LOXALONE_OPTIMIZER_H
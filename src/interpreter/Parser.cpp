@@ -4,20 +4,43 @@
 
 #include "Parser.h"
 
+#include <algorithm>
+#include <charconv>
+
 namespace loxalone {
 
+namespace {
+
+// The scanner only lets valid numbers through
+auto number_value(std::string_view lexeme) -> double {
+  double value = 0;
+  std::from_chars(lexeme.data(), lexeme.data() + lexeme.size(), value);
+  return value;
+}
+
+// The lexeme of a string includes the quotes
+auto string_value(std::string_view lexeme) -> Value {
+  return Value{lexeme.substr(1, lexeme.size() - 2)};
+}
+
+}  // namespace
+
 auto Parser::parse() -> std::vector<Stmt> {
   std::vector<Stmt> result{};
-  try {
-    while (!is_at_end()) {
-      result.emplace_back(declaration());
-    }
-
-    return result;
-  } catch (const ParserError& err) {
-    // TODO: How do we report this?
-    return {};
+  while (auto stmt = next()) {
+    result.emplace_back(std::move(stmt.value()));
   }
+  return result;
+}
+
+auto Parser::next() -> std::optional<Stmt> {
+  if (is_at_end()) return std::nullopt;
+  if (match(TokenType::IMPORT)) return import_declaration();
+  return declaration();
+}
+
+auto Parser::well_formed() -> bool {
+  return well_formed_m && (scanner_m == nullptr || scanner_m->well_formed());
 }
 
 auto Parser::declaration() -> Stmt {
@@ -33,8 +56,28 @@ auto Parser::declaration() -> Stmt {
   }
 }
 
+auto Parser::import_declaration() -> Stmt {
+  try {
+    Token keyword = previous();
+    Token path =
+        consume(TokenType::STRING, "Expect module path after 'import'.");
+    consume(TokenType::SEMICOLON, "Expect ';' after module path.");
+    return Import::create(arena_m, std::move(keyword), std::move(path));
+  } catch (const ParserError& err) {
+    synchronize();
+    return Import::empty();
+  }
+}
+
 auto Parser::class_declaration() -> Stmt {
   Token name = consume(TokenType::IDENTIFIER, "Expect class name.");
+
+  Expr superclass = Variable::empty();
+  if (match(TokenType::LESS)) {
+    consume(TokenType::IDENTIFIER, "Expect superclass name.");
+    superclass = Variable::create(arena_m, Token{previous()});
+  }
+
   consume(TokenType::LEFT_BRACE, "Expect '{' before class body.");
 
   std::vector<FunctionPtr> methods{};
@@ -43,34 +86,40 @@ auto Parser::class_declaration() -> Stmt {
   }
 
   consume(TokenType::RIGHT_BRACE, "Expect '}' after class body");
-  return Class::create(std::move(name), std::move(methods));
+  return Class::create(arena_m, std::move(name), std::move(superclass),
+                       std::move(methods));
 }
 
 auto Parser::var_declaration() -> Stmt {
   Token name = consume(TokenType::IDENTIFIER, "Expect variable name.");
+  return var_initializer(std::move(name));
+}
 
+auto Parser::var_initializer(Token&& name) -> Stmt {
   Expr init = Variable::empty();
   if (match(TokenType::EQUAL)) {
     init = expression();
   }
 
   consume(TokenType::SEMICOLON, "Expect ';' after variable declaration.");
-  return Var::create(std::move(name), std::move(init));
+  return Var::create(arena_m, std::move(name), std::move(init));
 }
 
 auto Parser::statement() -> Stmt {
+  if (match(TokenType::IMPORT))
+    throw parser_error(previous(), "Can only import at the top level.");
   if (match(TokenType::IF)) return if_statement();
   if (match(TokenType::PRINT)) return print_statement();
   if (match(TokenType::RETURN)) return return_statement();
   if (match(TokenType::WHILE)) return while_statement();
   if (match(TokenType::FOR)) return for_statement();
-  if (match(TokenType::LEFT_BRACE)) return Block::create(block());
+  if (match(TokenType::LEFT_BRACE)) return Block::create(arena_m, block());
 
   return expression_statement();
 }
 
 auto Parser::if_statement() -> Stmt {
-  const Token& token = previous();
+  Token token = previous();
   consume(TokenType::LEFT_PAREN, "Expect '(' after 'if'.");
   Expr condition = expression();
   consume(TokenType::RIGHT_PAREN, "Expect ')' after if condition.");
@@ -79,34 +128,36 @@ auto Parser::if_statement() -> Stmt {
   Stmt else_branch = Block::empty();
   if (match(TokenType::ELSE)) else_branch = statement();
 
-  return If::create(std::move(condition), Token{token}, std::move(then_branch),
-                    std::move(else_branch));
+  return If::create(arena_m, std::move(condition), Token{token},
+                    std::move(then_branch), std::move(else_branch));
 }
 
 auto Parser::print_statement() -> Stmt {
   Expr expr = expression();
   consume(TokenType::SEMICOLON, "Expect ';' after value.");
-  return Print::create(std::move(expr));
+  return Print::create(arena_m, std::move(expr));
 }
 
 auto Parser::while_statement() -> Stmt {
-  const Token& token = previous();
+  Token token = previous();
   consume(TokenType::LEFT_PAREN, "Expect '(' after 'while'.");
   Expr condition = expression();
   consume(TokenType::RIGHT_PAREN, "Expect ')' after while condition.");
   Stmt body = statement();
-  return While::create(std::move(condition), std::move(body), Token{token});
+  return While::create(arena_m, std::move(condition), std::move(body), Token{token});
 }
 
 auto Parser::for_statement() -> Stmt {
-  const Token& token = previous();
+  Token token = previous();
 
   consume(TokenType::LEFT_PAREN, "Expect '(' after 'for'.");
   Stmt initializer{};
   if (match(TokenType::SEMICOLON)) {
     initializer = Var::empty();
   } else if (match(TokenType::VAR)) {
-    initializer = var_declaration();
+    Token name = consume(TokenType::IDENTIFIER, "Expect variable name.");
+    if (match(TokenType::IN)) return for_in_statement(token, std::move(name));
+    initializer = var_initializer(std::move(name));
   } else {
     initializer = expression_statement();
   }
@@ -129,34 +180,42 @@ auto Parser::for_statement() -> Stmt {
 
   // If the increment expression is not null, add it to the end of body
   if (!expr_is_null(increment))
-    stmts.emplace_back(Expression::create(std::move(increment)));
+    stmts.emplace_back(Expression::create(arena_m, std::move(increment)));
 
   // The for loop's body is a list of statement with increment expression
   // added at the end
-  Stmt body = Block::create(std::move(stmts));
+  Stmt body = Block::create(arena_m, std::move(stmts));
 
   // If the condition expression is null, use `true` literal (an infinite
   // loop)
-  if (expr_is_null(condition)) condition = Literal::create(true);
+  if (expr_is_null(condition)) condition = Literal::create(arena_m, true);
 
   // De-sugar for loop into a while loop with the condition.
-  body = While::create(std::move(condition), std::move(body), Token{token});
+  body = While::create(arena_m, std::move(condition), std::move(body), Token{token});
 
   // The initializer needs to be executed first before looping
   if (!stmt_is_null(initializer)) {
     std::vector<Stmt> block{};
     block.emplace_back(std::move(initializer));
     block.emplace_back(std::move(body));
-    body = Block::create(std::move(block));
+    body = Block::create(arena_m, std::move(block));
   }
 
   return body;
 }
 
+auto Parser::for_in_statement(const Token& token, Token&& name) -> Stmt {
+  Expr iterable = expression();
+  consume(TokenType::RIGHT_PAREN, "Expect ')' after for clauses.");
+  Stmt body = statement();
+  return ForIn::create(arena_m, std::move(name), std::move(iterable),
+                       std::move(body), Token{token});
+}
+
 auto Parser::expression_statement() -> Stmt {
   Expr expr = expression();
   consume(TokenType::SEMICOLON, "Expect ';' after expression.");
-  return Expression::create(std::move(expr));
+  return Expression::create(arena_m, std::move(expr));
 }
 
 auto Parser::block() -> std::vector<Stmt> {
@@ -191,7 +250,8 @@ auto Parser::function(const std::string_view& kind) -> Stmt {
           fmt::format("Expect '{{' before {} body.", kind));
   std::vector<Stmt> body{block()};
 
-  return Function::create(std::move(name), std::move(params), std::move(body));
+  return Function::create(arena_m, std::move(name), std::move(params),
+                          std::move(body));
 }
 
 auto Parser::return_statement() -> Stmt {
@@ -202,7 +262,7 @@ auto Parser::return_statement() -> Stmt {
   }
 
   consume(TokenType::SEMICOLON, "Expect ';' after return value.");
-  return Return::create(std::move(keyword), std::move(value));
+  return Return::create(arena_m, std::move(keyword), std::move(value));
 }
 
 auto Parser::expression() -> Expr { return assignment(); }
@@ -211,12 +271,27 @@ auto Parser::assignment() -> Expr {
   Expr expr = or_expression();
 
   if (match(TokenType::EQUAL)) {
-    const Token& equals = previous();
+    Token equals = previous();
     Expr value = assignment();
 
     if (std::holds_alternative<VariablePtr>(expr)) {
       Token name = std::get<VariablePtr>(expr)->name_m;
-      return Assign::create(std::move(name), std::move(value));
+      return Assign::create(arena_m, std::move(name), std::move(value));
+    }
+
+    // An assignment to a property access sets the property instead
+    if (std::holds_alternative<GetPtr>(expr)) {
+      const auto& get = std::get<GetPtr>(expr);
+      return Set::create(arena_m, Expr{get->object_m}, Token{get->name_m},
+                         std::move(value));
+    }
+
+    // Same for an element of an array, list or map
+    if (std::holds_alternative<IndexPtr>(expr)) {
+      const auto& index = std::get<IndexPtr>(expr);
+      return SetIndex::create(arena_m, Expr{index->object_m},
+                              Token{index->bracket_m}, Expr{index->index_m},
+                              std::move(value));
     }
 
     parser_error(equals, "Invalid assignment target.");
@@ -228,9 +303,9 @@ auto Parser::assignment() -> Expr {
 auto Parser::or_expression() -> Expr {
   Expr expr = and_expression();
   while (match(TokenType::OR)) {
-    const Token& oper = previous();
+    Token oper = previous();
     Expr right = and_expression();
-    expr = Logical::create(std::move(expr), Token{oper}, std::move(right));
+    expr = Logical::create(arena_m, std::move(expr), Token{oper}, std::move(right));
   }
   return expr;
 }
@@ -238,9 +313,9 @@ auto Parser::or_expression() -> Expr {
 auto Parser::and_expression() -> Expr {
   Expr expr = equality();
   while (match(TokenType::AND)) {
-    const Token& oper = previous();
+    Token oper = previous();
     Expr right = equality();
-    expr = Logical::create(std::move(expr), Token{oper}, std::move(right));
+    expr = Logical::create(arena_m, std::move(expr), Token{oper}, std::move(right));
   }
   return expr;
 }
@@ -251,7 +326,8 @@ auto Parser::equality() -> Expr {
   while (match(TokenType::BANG_EQUAL, TokenType::EQUAL_EQUAL)) {
     Token oper = previous();
     Expr right = comparison();
-    expr = Binary::create(std::move(expr), std::move(oper), std::move(right));
+    expr = Binary::create(arena_m, std::move(expr), std::move(oper),
+                          std::move(right));
   }
 
   return expr;
@@ -264,7 +340,8 @@ auto Parser::comparison() -> Expr {
                TokenType::LESS_EQUAL)) {
     Token oper = previous();
     Expr right = term();
-    expr = Binary::create(std::move(expr), std::move(oper), std::move(right));
+    expr = Binary::create(arena_m, std::move(expr), std::move(oper),
+                          std::move(right));
   }
 
   return expr;
@@ -276,7 +353,8 @@ auto Parser::term() -> Expr {
   while (match(TokenType::PLUS, TokenType::MINUS)) {
     Token oper = previous();
     Expr right = factor();
-    expr = Binary::create(std::move(expr), std::move(oper), std::move(right));
+    expr = Binary::create(arena_m, std::move(expr), std::move(oper),
+                          std::move(right));
   }
 
   return expr;
@@ -288,7 +366,8 @@ auto Parser::factor() -> Expr {
   while (match(TokenType::SLASH, TokenType::STAR)) {
     Token oper = previous();
     Expr right = unary();
-    expr = Binary::create(std::move(expr), std::move(oper), std::move(right));
+    expr = Binary::create(arena_m, std::move(expr), std::move(oper),
+                          std::move(right));
   }
 
   return expr;
@@ -298,7 +377,7 @@ auto Parser::unary() -> Expr {
   if (match(TokenType::BANG, TokenType::MINUS)) {
     Token oper = previous();
     Expr right = unary();
-    return Unary::create(std::move(oper), std::move(right));
+    return Unary::create(arena_m, std::move(oper), std::move(right));
   }
 
   return call();
@@ -310,6 +389,16 @@ auto Parser::call() -> Expr {
   while (true) {
     if (match(TokenType::LEFT_PAREN)) {
       expr = finish_call(std::move(expr));
+    } else if (match(TokenType::DOT)) {
+      Token name =
+          consume(TokenType::IDENTIFIER, "Expect property name after '.'.");
+      expr = Get::create(arena_m, std::move(expr), std::move(name));
+    } else if (match(TokenType::LEFT_BRACKET)) {
+      Token bracket = previous();
+      Expr index = expression();
+      consume(TokenType::RIGHT_BRACKET, "Expect ']' after index.");
+      expr = Index::create(arena_m, std::move(expr), std::move(bracket),
+                           std::move(index));
     } else {
       break;
     }
@@ -331,29 +420,75 @@ auto Parser::finish_call(Expr&& callee) -> Expr {
 
   const Token& paren =
       consume(TokenType::RIGHT_PAREN, "Expect ')' after arguments.");
-  return Call::create(std::move(callee), Token{paren}, std::move(args));
+  return Call::create(arena_m, std::move(callee), Token{paren}, std::move(args));
 }
 
 auto Parser::primary() -> Expr {
-  if (match(TokenType::TRUE)) return Literal::create(true);
-  if (match(TokenType::FALSE)) return Literal::create(false);
-  if (match(TokenType::NIL)) return Literal::create(std::monostate{});
-  if (match(TokenType::NUMBER, TokenType::STRING))
-    return Literal::create(lox_literal{previous().literal.value()});
+  if (match(TokenType::TRUE)) return Literal::create(arena_m, true);
+  if (match(TokenType::FALSE)) return Literal::create(arena_m, false);
+  if (match(TokenType::NIL)) return Literal::create(arena_m, Value{});
+  if (match(TokenType::NUMBER))
+    return Literal::create(arena_m, number_value(previous().lexeme));
+  if (match(TokenType::STRING))
+    return Literal::create(arena_m, string_value(previous().lexeme));
+  if (match(TokenType::SUPER)) {
+    Token keyword = previous();
+    consume(TokenType::DOT, "Expect '.' after 'super'.");
+    Token method =
+        consume(TokenType::IDENTIFIER, "Expect superclass method name.");
+    return Super::create(arena_m, std::move(keyword), std::move(method));
+  }
+  if (match(TokenType::THIS)) return This::create(arena_m, Token{previous()});
   if (match(TokenType::LEFT_PAREN)) {
     Expr expr = expression();
     consume(TokenType::RIGHT_PAREN, "Expect ')' after expression");
-    return Grouping::create(std::move(expr));
+    return Grouping::create(arena_m, std::move(expr));
   }
   if (match(TokenType::IDENTIFIER)) {
     Token prev = previous();
-    return Variable::create(std::move(prev));
+    return Variable::create(arena_m, std::move(prev));
   }
+  if (match(TokenType::LEFT_BRACKET)) return list_literal();
+  if (match(TokenType::LEFT_BRACE)) return map_literal();
 
   throw parser_error(peek(), "Expect expression.");
 }
 
-auto Parser::previous() -> const Token& { return tokens_m[current_m - 1]; }
+auto Parser::list_literal() -> Expr {
+  Token bracket = previous();
+  std::vector<Expr> elements{};
+  if (!check(TokenType::RIGHT_BRACKET)) {
+    do {
+      elements.emplace_back(expression());
+    } while (match(TokenType::COMMA));
+  }
+
+  consume(TokenType::RIGHT_BRACKET, "Expect ']' after list elements.");
+  return ListLiteral::create(arena_m, std::move(bracket), std::move(elements));
+}
+
+// Only parsed where an expression is expected, a '{' starting a statement is
+// always a block
+auto Parser::map_literal() -> Expr {
+  Token brace = previous();
+  std::vector<Expr> keys{};
+  std::vector<Expr> values{};
+  if (!check(TokenType::RIGHT_BRACE)) {
+    do {
+      keys.emplace_back(expression());
+      consume(TokenType::COLON, "Expect ':' after map key.");
+      values.emplace_back(expression());
+    } while (match(TokenType::COMMA));
+  }
+
+  consume(TokenType::RIGHT_BRACE, "Expect '}' after map entries.");
+  return MapLiteral::create(arena_m, std::move(brace), std::move(keys),
+                            std::move(values));
+}
+
+auto Parser::previous() -> const Token& {
+  return ring_m[(current_m - 1) % LOOKAHEAD];
+}
 
 auto Parser::check(TokenType type) -> bool {
   if (is_at_end()) return false;
@@ -365,7 +500,20 @@ auto Parser::advance() -> const Token& {
   return previous();
 }
 
-auto Parser::peek() -> const Token& { return tokens_m[current_m]; }
+auto Parser::peek() -> const Token& {
+  if (pulled_m == current_m) {
+    ring_m[pulled_m % LOOKAHEAD] = pull();
+    pulled_m++;
+  }
+  return ring_m[current_m % LOOKAHEAD];
+}
+
+auto Parser::pull() -> Token {
+  if (scanner_m != nullptr) return scanner_m->next_token();
+  // The list ends with an EOF_ token, which is repeated from then on
+  size_t index = std::min(pulled_m, tokens_m->size() - 1);
+  return (*tokens_m)[index];
+}
 
 auto Parser::is_at_end() -> bool { return peek().type == TokenType::EOF_; }
 
@@ -389,6 +537,7 @@ auto Parser::consume(TokenType type, std::string_view&& msg) -> Token {
 
 auto Parser::parser_error(const Token& token, const std::string_view& err)
     -> ParserError {
+  well_formed_m = false;
   if (token.type == TokenType::EOF_) {
     report(token.line, " at end", err);
   } else {
@@ -406,6 +555,7 @@ auto Parser::synchronize() -> void {
     switch (peek().type) {
       case TokenType::CLASS:
       case TokenType::FUN:
+      case TokenType::IMPORT:
       case TokenType::VAR:
       case TokenType::FOR:
       case TokenType::IF:
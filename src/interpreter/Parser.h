@@ -5,42 +5,71 @@
 #ifndef LOXALONE_PARSER_H
 #define LOXALONE_PARSER_H
 
+#include <array>
+#include <cstddef>
 #include <optional>
 #include <vector>
 
+#include "Arena.h"
 #include "Error.h"
 #include "Expr.h"
+#include "Scanner.h"
 #include "Stmt.h"
 #include "Token.h"
 
 namespace loxalone {
 class ParserError : std::exception {
  public:
-  const Token& token;
+  const Token token;
   const std::string msg;
 
-  ParserError(const Token& token, std::string&& msg)
+  ParserError(Token token, std::string&& msg)
       : token{token}, msg{std::move(msg)} {}
 };
 
+/*
+ * Parser pulls the tokens from the scanner as it needs them, through a small
+ * ring of the tokens it's looking at. So a script can be parsed and run one
+ * top-level declaration at a time with `next`, and only a few tokens exist at
+ * a time however long it is. The parser can also read a list of tokens
+ * scanned ahead of time, which must end with an EOF_ token.
+ *
+ * The syntax tree is allocated in the given arena, so the arena has to
+ * outlive the statements returned by the parser.
+ * */
 class Parser {
  public:
-  explicit Parser(const std::vector<Token>& tokens) : tokens_m{tokens} {}
+  Parser(Scanner& scanner, Arena& arena)
+      : scanner_m{&scanner}, arena_m{arena} {}
+  Parser(const std::vector<Token>& tokens, Arena& arena)
+      : tokens_m{&tokens}, arena_m{arena} {}
 
-  // The main entry point of the parser,
-  // parses the source text into list of statements
+  // Parses all of the remaining declarations
   auto parse() -> std::vector<Stmt>;
 
+  // Parses the next top-level declaration, returns nullopt at the end of the
+  // source. A declaration with a syntax error is reported and returned as an
+  // empty statement. Imports are only allowed at the top level, so all of the
+  // imports of a script are known without running it.
+  auto next() -> std::optional<Stmt>;
+
+  // False once a syntax error was found, or the scanner found a malformed
+  // token. The statements must not be run then.
+  auto well_formed() -> bool;
+
  private:
   // Statement parsing functions
+  auto import_declaration() -> Stmt;
   auto declaration() -> Stmt;
   auto class_declaration() -> Stmt;
   auto var_declaration() -> Stmt;
+  auto var_initializer(Token&& name) -> Stmt;
   auto statement() -> Stmt;
   auto if_statement() -> Stmt;
   auto print_statement() -> Stmt;
   auto while_statement() -> Stmt;
   auto for_statement() -> Stmt;
+  auto for_in_statement(const Token& token, Token&& name) -> Stmt;
   auto expression_statement() -> Stmt;
   auto function(const std::string_view&) -> Stmt;
   auto return_statement() -> Stmt;
@@ -62,12 +91,15 @@ class Parser {
   auto call() -> Expr;
   auto finish_call(Expr&&) -> Expr;
   auto primary() -> Expr;
+  auto list_literal() -> Expr;
+  auto map_literal() -> Expr;
 
   // Helper methods to help with the parsing
   auto previous() -> const Token&;
   auto check(TokenType) -> bool;
   auto advance() -> const Token&;
   auto peek() -> const Token&;
+  auto pull() -> Token;
   auto is_at_end() -> bool;
 
   template <typename Head, typename... Tail>
@@ -81,8 +113,20 @@ class Parser {
 
   auto synchronize() -> void;
 
-  const std::vector<Token>& tokens_m;
-  int current_m = 0;
+  // The previous and the current token are kept, so references returned by
+  // `previous` and `peek` stay valid until a few more tokens are read
+  static constexpr size_t LOOKAHEAD = 4;
+
+  // Exactly one of them is set
+  Scanner* scanner_m = nullptr;
+  const std::vector<Token>* tokens_m = nullptr;
+
+  Arena& arena_m;
+  std::array<Token, LOOKAHEAD> ring_m{};
+  // The number of tokens consumed and pulled so far
+  size_t current_m = 0;
+  size_t pulled_m = 0;
+  bool well_formed_m = true;
 };
 }  // namespace loxalone
 
@@ -0,0 +1,28 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_PERCENTILE_H
+#define LOXALONE_PERCENTILE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace loxalone {
+
+// Nearest-rank percentile of sorted values, which must not be empty
+inline auto percentile(const std::vector<double>& sorted, double p) -> double {
+  auto rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+// Median of sorted values, the mean of the middle two for an even count
+inline auto median(const std::vector<double>& sorted) -> double {
+  size_t n = sorted.size();
+  return n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_PERCENTILE_H
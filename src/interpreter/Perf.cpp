@@ -0,0 +1,92 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Perf.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "Collections.h"
+#include "LoxInstance.h"
+#include "Native.h"
+#include "Percentile.h"
+
+namespace loxalone {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The calls of `bench` are split into this many trials at most, so a single
+// slow trial only moves the p99
+constexpr size_t MAX_TRIALS = 100;
+
+auto now() -> double {
+  return std::chrono::duration<double, std::nano>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+auto cpu() -> double {
+  timespec time{};
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+  return static_cast<double>(time.tv_sec) * 1e9 +
+         static_cast<double>(time.tv_nsec);
+}
+
+auto objects() -> double { return static_cast<double>(live_objects); }
+
+// The loop runs in C++, so the time of a trial is only the calls themselves.
+// A tenth of the calls are made before the trials to warm up caches and the
+// memo tables of pure functions.
+auto bench(Engine& engine, LoxCallable& fn, double iterations) -> Value {
+  if (!(iterations >= 1 && iterations <= static_cast<double>(1ull << 48) &&
+        iterations == static_cast<double>(static_cast<size_t>(iterations))))
+    throw NativeError{"Iterations must be a positive integer."};
+
+  auto calls = static_cast<size_t>(iterations);
+  for (size_t i = 0; i < std::max<size_t>(calls / 10, 1); i++) {
+    engine.call_back(fn, Args{});
+  }
+
+  // The calls that don't divide evenly go to the first trials
+  size_t trials = std::min(calls, MAX_TRIALS);
+  std::vector<double> per_call{};
+  per_call.reserve(trials);
+  for (size_t trial = 0; trial < trials; trial++) {
+    size_t batch = calls / trials + (trial < calls % trials ? 1 : 0);
+    auto start = Clock::now();
+    for (size_t i = 0; i < batch; i++) {
+      engine.call_back(fn, Args{});
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    per_call.emplace_back(elapsed.count() / static_cast<double>(batch));
+  }
+  std::sort(per_call.begin(), per_call.end());
+
+  auto result = make_ref<MapObj>();
+  result->set(Value{"min"}, per_call.front());
+  result->set(Value{"median"}, median(per_call));
+  result->set(Value{"p99"}, percentile(per_call, 99));
+  return result;
+}
+
+}  // namespace
+
+auto perf_module() -> Value {
+  auto module = make_ref<LoxInstance>(make_ref<LoxClass>("perf"));
+  for (auto& native :
+       {make_native<&now>("now"), make_native<&cpu>("cpu"),
+        make_native<&bench>("bench"), make_native<&objects>("objects")}) {
+    // Every field is added by its own site
+    PropertyCache cache{};
+    module->set(cache, native->name(), native);
+  }
+  return module;
+}
+
+}  // namespace loxalone
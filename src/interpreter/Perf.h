@@ -0,0 +1,25 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_PERF_H
+#define LOXALONE_PERF_H
+
+#include "Value.h"
+
+namespace loxalone {
+
+// Returns the `perf` module, an instance whose fields are the timing natives:
+//
+// - `perf.now()` is a monotonic clock in nanoseconds
+// - `perf.cpu()` is the CPU time used by the process in nanoseconds
+// - `perf.bench(fn, iterations)` calls `fn` without arguments `iterations`
+//   times in a few trials and returns a map with the "min", "median" and
+//   "p99" nanoseconds per call over the trials
+// - `perf.objects()` is the number of heap objects alive, e.g. to check that
+//   a loop doesn't leak
+auto perf_module() -> Value;
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_PERF_H
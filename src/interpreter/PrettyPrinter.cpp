@@ -19,9 +19,11 @@ auto PrettyPrinter::operator()(const GroupingPtr& expr) -> std::string {
 }
 
 auto PrettyPrinter::operator()(const LiteralPtr& expr) -> std::string {
-  return std::visit(
-      [](auto&& arg) -> std::string { return fmt::format("{}", arg); },
-      expr->value_m);
+  const Value& value = expr->value_m;
+  if (value.is_nil()) return "nil";
+  if (value.is_bool()) return fmt::format("{}", value.as_bool());
+  if (value.is_number()) return fmt::format("{}", value.as_number());
+  return value.as_string();
 }
 
 auto PrettyPrinter::operator()(const UnaryPtr& expr) -> std::string {
@@ -41,8 +43,7 @@ auto PrettyPrinter::parenthesize(const std::string_view& name,
 }
 
 auto PrettyPrinter::operator()(const VariablePtr& expr) -> std::string {
-  return fmt::format("(var {}={})", expr->name_m.lexeme,
-                     expr->name_m.literal.value());
+  return fmt::format("(var {})", expr->name_m.lexeme);
 }
 
 auto PrettyPrinter::operator()(const AssignPtr& expr) -> std::string {
@@ -66,4 +67,53 @@ auto PrettyPrinter::operator()(const CallPtr& expr) -> std::string {
   return oss.str();
 }
 
+auto PrettyPrinter::operator()(const GetPtr& expr) -> std::string {
+  return fmt::format("(get {} {})", visit(*this, expr->object_m),
+                     expr->name_m.lexeme);
+}
+
+auto PrettyPrinter::operator()(const SetPtr& expr) -> std::string {
+  return fmt::format("(set {} {} {})", visit(*this, expr->object_m),
+                     expr->name_m.lexeme, visit(*this, expr->value_m));
+}
+
+auto PrettyPrinter::operator()(const ListLiteralPtr& expr) -> std::string {
+  std::stringstream oss{};
+  oss << "(list";
+  for (const auto& element : expr->elements_m) {
+    oss << fmt::format(" {}", visit(*this, element));
+  }
+  oss << ")";
+  return oss.str();
+}
+
+auto PrettyPrinter::operator()(const MapLiteralPtr& expr) -> std::string {
+  std::stringstream oss{};
+  oss << "(map";
+  for (size_t i = 0; i < expr->keys_m.size(); i++) {
+    oss << fmt::format(" {}={}", visit(*this, expr->keys_m[i]),
+                       visit(*this, expr->values_m[i]));
+  }
+  oss << ")";
+  return oss.str();
+}
+
+auto PrettyPrinter::operator()(const IndexPtr& expr) -> std::string {
+  return fmt::format("(index {} {})", visit(*this, expr->object_m),
+                     visit(*this, expr->index_m));
+}
+
+auto PrettyPrinter::operator()(const SetIndexPtr& expr) -> std::string {
+  return fmt::format("(set-index {} {} {})", visit(*this, expr->object_m),
+                     visit(*this, expr->index_m), visit(*this, expr->value_m));
+}
+
+auto PrettyPrinter::operator()(const SuperPtr& expr) -> std::string {
+  return fmt::format("(super {})", expr->method_m.lexeme);
+}
+
+auto PrettyPrinter::operator()(const ThisPtr& expr) -> std::string {
+  return "this";
+}
+
 }  // namespace loxalone
\ No newline at end of file
@@ -16,12 +16,20 @@ class PrettyPrinter {
  public:
   auto operator()(const BinaryPtr &) -> std::string;
   auto operator()(const GroupingPtr &) -> std::string;
+  auto operator()(const IndexPtr &) -> std::string;
+  auto operator()(const ListLiteralPtr &) -> std::string;
   auto operator()(const LiteralPtr &) -> std::string;
+  auto operator()(const MapLiteralPtr &) -> std::string;
   auto operator()(const UnaryPtr &) -> std::string;
   auto operator()(const VariablePtr &) -> std::string;
   auto operator()(const AssignPtr &) -> std::string;
   auto operator()(const LogicalPtr &) -> std::string;
   auto operator()(const CallPtr &) -> std::string;
+  auto operator()(const GetPtr &) -> std::string;
+  auto operator()(const SetPtr &) -> std::string;
+  auto operator()(const SetIndexPtr &) -> std::string;
+  auto operator()(const SuperPtr &) -> std::string;
+  auto operator()(const ThisPtr &) -> std::string;
 
  private:
   // TODO: Can these two be written with variadic template?
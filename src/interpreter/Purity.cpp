@@ -0,0 +1,292 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Purity.h"
+
+#include <fmt/format.h>
+
+#include "LoxCallable.h"
+
+namespace loxalone {
+
+auto Purity::memoize(List<Stmt> stmts) -> std::vector<MemoTable *> {
+  for (const auto &stmt : stmts) {
+    analyze(stmt);
+  }
+
+  std::unordered_map<FunctionPtr, Candidate *> by_function{};
+  for (auto &candidate : candidates) {
+    by_function.emplace(candidate.function, &candidate);
+  }
+
+  // A callee is pure if its variable always holds the same pure function.
+  // Functions found calling an impure one are impure themselves, which may
+  // in turn make their callers impure, so this runs until nothing changes.
+  auto is_pure = [&](const Binding &callee) {
+    return callee.function != nullptr && callee.definitions == 1 &&
+           callee.assignments == 0 && !callee.native &&
+           !by_function[callee.function]->impure;
+  };
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto &candidate : candidates) {
+      if (candidate.impure) continue;
+      for (const auto *callee : candidate.callees) {
+        if (is_pure(*callee)) continue;
+        candidate.impure = true;
+        changed = true;
+        break;
+      }
+    }
+  }
+
+  std::vector<MemoTable *> tables{};
+  for (auto &candidate : candidates) {
+    if (candidate.impure) continue;
+
+    const auto &function = candidate.function;
+    function->memo_m = arena.make<MemoTable>(
+        fmt::format("{} (line {})", function->name_m.lexeme,
+                    function->name_m.line),
+        function->params_m.size());
+    tables.emplace_back(function->memo_m);
+  }
+  return tables;
+}
+
+auto Purity::operator()(const BinaryPtr &expr) -> void {
+  analyze(expr->left_m);
+  analyze(expr->right_m);
+}
+
+auto Purity::operator()(const GroupingPtr &expr) -> void {
+  analyze(expr->expression_m);
+}
+
+auto Purity::operator()(const LiteralPtr &expr) -> void {}
+
+auto Purity::operator()(const UnaryPtr &expr) -> void {
+  analyze(expr->right_m);
+}
+
+auto Purity::operator()(const VariablePtr &expr) -> void {
+  auto [binding, own] = lookup(expr->name_m.lexeme);
+  if (!own) impure();
+}
+
+auto Purity::operator()(const AssignPtr &expr) -> void {
+  analyze(expr->value_m);
+
+  auto [binding, own] = lookup(expr->name_m.lexeme);
+  binding->assignments++;
+  if (!own) impure();
+}
+
+auto Purity::operator()(const LogicalPtr &expr) -> void {
+  analyze(expr->left_m);
+  analyze(expr->right_m);
+}
+
+auto Purity::operator()(const CallPtr &expr) -> void {
+  // Only functions called by name are known, calling anything else (e.g. a
+  // parameter) may run any code
+  if (const auto *variable = std::get_if<VariablePtr>(&expr->callee_m)) {
+    auto [binding, own] = lookup((*variable)->name_m.lexeme);
+    if (own) {
+      impure();
+    } else if (current != nullptr) {
+      current->callees.emplace_back(binding);
+    }
+  } else {
+    analyze(expr->callee_m);
+    impure();
+  }
+
+  for (const auto &arg : expr->arguments_m) {
+    analyze(arg);
+  }
+}
+
+auto Purity::operator()(const GetPtr &expr) -> void {
+  impure();
+  analyze(expr->object_m);
+}
+
+auto Purity::operator()(const SetPtr &expr) -> void {
+  impure();
+  analyze(expr->value_m);
+  analyze(expr->object_m);
+}
+
+// Every run creates a new list or map
+auto Purity::operator()(const ListLiteralPtr &expr) -> void {
+  impure();
+  for (const auto &element : expr->elements_m) {
+    analyze(element);
+  }
+}
+
+auto Purity::operator()(const MapLiteralPtr &expr) -> void {
+  impure();
+  for (size_t i = 0; i < expr->keys_m.size(); i++) {
+    analyze(expr->keys_m[i]);
+    analyze(expr->values_m[i]);
+  }
+}
+
+// Collections are mutable, so reading an element depends on more than the
+// index
+auto Purity::operator()(const IndexPtr &expr) -> void {
+  impure();
+  analyze(expr->object_m);
+  analyze(expr->index_m);
+}
+
+auto Purity::operator()(const SetIndexPtr &expr) -> void {
+  impure();
+  analyze(expr->object_m);
+  analyze(expr->index_m);
+  analyze(expr->value_m);
+}
+
+auto Purity::operator()(const SuperPtr &expr) -> void { impure(); }
+
+auto Purity::operator()(const ThisPtr &expr) -> void { impure(); }
+
+auto Purity::operator()(const BlockPtr &stmt) -> void {
+  scopes.emplace_back();
+  for (const auto &inner : stmt->statements_m) {
+    analyze(inner);
+  }
+  scopes.pop_back();
+}
+
+auto Purity::operator()(const ExpressionPtr &stmt) -> void {
+  analyze(stmt->expression_m);
+}
+
+auto Purity::operator()(const FunctionPtr &stmt) -> void {
+  // Every run of the declaration creates a new closure
+  impure();
+  declare(stmt->name_m, stmt);
+  analyze_function(stmt, false);
+}
+
+auto Purity::operator()(const PrintPtr &stmt) -> void {
+  impure();
+  analyze(stmt->expression_m);
+}
+
+auto Purity::operator()(const VarPtr &stmt) -> void {
+  if (!expr_is_null(stmt->initializer_m)) analyze(stmt->initializer_m);
+  declare(stmt->name_m, nullptr);
+}
+
+auto Purity::operator()(const IfPtr &stmt) -> void {
+  analyze(stmt->expression_m);
+  analyze(stmt->then_branch_m);
+  if (!stmt_is_null(stmt->else_branch_m)) analyze(stmt->else_branch_m);
+}
+
+auto Purity::operator()(const WhilePtr &stmt) -> void {
+  analyze(stmt->condition_m);
+  analyze(stmt->body_m);
+}
+
+// Iterating reads the elements of a mutable collection
+auto Purity::operator()(const ForInPtr &stmt) -> void {
+  impure();
+  analyze(stmt->iterable_m);
+
+  scopes.emplace_back();
+  declare(stmt->name_m, nullptr);
+  analyze(stmt->body_m);
+  scopes.pop_back();
+}
+
+auto Purity::operator()(const ReturnPtr &stmt) -> void {
+  if (!expr_is_null(stmt->value_m)) analyze(stmt->value_m);
+}
+
+auto Purity::operator()(const ClassPtr &stmt) -> void {
+  impure();
+  declare(stmt->name_m, nullptr);
+  if (!expr_is_null(stmt->superclass_m)) analyze(stmt->superclass_m);
+
+  // Methods depend on `this`, they are only analyzed for the assignments and
+  // functions they contain
+  for (const auto &method : stmt->methods_m) {
+    analyze_function(method, true);
+  }
+}
+
+// The statements of the module are analyzed together with the script's
+auto Purity::operator()(const ImportPtr &stmt) -> void {}
+
+auto Purity::analyze(const Stmt &stmt) -> void { visit(*this, stmt); }
+
+auto Purity::analyze(const Expr &expr) -> void { visit(*this, expr); }
+
+auto Purity::analyze_function(const FunctionPtr &stmt, bool method) -> void {
+  candidates.emplace_back(
+      Candidate{stmt, current, scopes.size(), method, {}});
+  current = &candidates.back();
+
+  scopes.emplace_back();
+  for (const auto &param : stmt->params_m) {
+    declare(param, nullptr);
+  }
+  for (const auto &inner : stmt->body_m) {
+    analyze(inner);
+  }
+  scopes.pop_back();
+
+  current = current->enclosing;
+}
+
+auto Purity::lookup(std::string_view name) -> std::pair<Binding *, bool> {
+  for (size_t i = scopes.size(); i > 0; i--) {
+    auto &scope = scopes[i - 1];
+    if (auto find = scope.find(name); find != scope.end()) {
+      bool own = current != nullptr && i > current->scope_base;
+      return {find->second, own};
+    }
+  }
+  return {global(name), false};
+}
+
+auto Purity::global(std::string_view name) -> Binding * {
+  auto [it, inserted] = globals.try_emplace(name, nullptr);
+  if (inserted) {
+    it->second = &bindings.emplace_back();
+
+    // Natives are defined before the script runs, so the script could call
+    // them before its own declaration replaces them
+    for (const auto &standard : standard_globals()) {
+      if (standard.name == name) it->second->native = true;
+    }
+  }
+  return it->second;
+}
+
+auto Purity::declare(const Token &token, FunctionPtr function) -> void {
+  Binding *binding = nullptr;
+  if (scopes.empty()) {
+    binding = global(token.lexeme);
+  } else {
+    binding = &bindings.emplace_back();
+    scopes.back()[token.lexeme] = binding;
+  }
+
+  binding->definitions++;
+  binding->function = function;
+}
+
+auto Purity::impure() -> void {
+  if (current != nullptr) current->impure = true;
+}
+
+}  // namespace loxalone
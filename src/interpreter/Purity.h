@@ -0,0 +1,125 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_PURITY_H
+#define LOXALONE_PURITY_H
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Arena.h"
+#include "Expr.h"
+#include "Memo.h"
+#include "Stmt.h"
+
+namespace loxalone {
+
+/*
+ * Purity finds the functions whose result only depends on their arguments
+ * and gives each of them a `MemoTable`, so that calling them again with the
+ * same arguments returns the cached result instead of running the body.
+ *
+ * A function is pure if it only reads and assigns its own parameters and
+ * locals, and only calls pure functions by the name of their declaration. It
+ * must not print, touch properties, create functions or classes, or read any
+ * other variable. Called functions are only known if their variable is
+ * declared once and never assigned, so the name can't refer to anything else.
+ * Recursive functions are assumed to be pure until proven otherwise.
+ *
+ * The pass does its own scoping rather than relying on the resolver, so it
+ * works for both engines. It must see the whole program at once, a later
+ * assignment to a function would otherwise go unnoticed.
+ * */
+class Purity {
+ public:
+  explicit Purity(Arena &arena)
+      : arena{arena}, scopes{}, globals{}, current{nullptr} {}
+
+  // Attaches a memo table to every pure function of the program and returns
+  // the tables
+  auto memoize(List<Stmt>) -> std::vector<MemoTable *>;
+
+  // Expression visitor
+  auto operator()(const BinaryPtr &expr) -> void;
+  auto operator()(const GroupingPtr &expr) -> void;
+  auto operator()(const IndexPtr &expr) -> void;
+  auto operator()(const ListLiteralPtr &expr) -> void;
+  auto operator()(const LiteralPtr &expr) -> void;
+  auto operator()(const MapLiteralPtr &expr) -> void;
+  auto operator()(const UnaryPtr &expr) -> void;
+  auto operator()(const VariablePtr &expr) -> void;
+  auto operator()(const AssignPtr &expr) -> void;
+  auto operator()(const LogicalPtr &expr) -> void;
+  auto operator()(const CallPtr &expr) -> void;
+  auto operator()(const GetPtr &expr) -> void;
+  auto operator()(const SetPtr &expr) -> void;
+  auto operator()(const SetIndexPtr &expr) -> void;
+  auto operator()(const SuperPtr &expr) -> void;
+  auto operator()(const ThisPtr &expr) -> void;
+
+  // Statement visitors
+  auto operator()(const BlockPtr &stmt) -> void;
+  auto operator()(const ExpressionPtr &stmt) -> void;
+  auto operator()(const FunctionPtr &stmt) -> void;
+  auto operator()(const PrintPtr &stmt) -> void;
+  auto operator()(const VarPtr &stmt) -> void;
+  auto operator()(const IfPtr &stmt) -> void;
+  auto operator()(const WhilePtr &stmt) -> void;
+  auto operator()(const ForInPtr &stmt) -> void;
+  auto operator()(const ReturnPtr &stmt) -> void;
+  auto operator()(const ClassPtr &stmt) -> void;
+  auto operator()(const ImportPtr &stmt) -> void;
+
+ private:
+  // A declared variable, `function` is set if it's declared by a function
+  // declaration
+  struct Binding {
+    FunctionPtr function = nullptr;
+    int definitions = 0;
+    int assignments = 0;
+    bool native = false;
+  };
+
+  // A function being analyzed, its scopes start at `scope_base`. `callees`
+  // are the variables it calls, it's only pure if all of them are.
+  struct Candidate {
+    FunctionPtr function;
+    Candidate *enclosing;
+    size_t scope_base;
+    bool impure;
+    std::vector<Binding *> callees;
+  };
+
+  auto analyze(const Stmt &) -> void;
+  auto analyze(const Expr &) -> void;
+  auto analyze_function(const FunctionPtr &stmt, bool method) -> void;
+
+  // Returns the variable with the given name, and whether it belongs to the
+  // function being analyzed
+  auto lookup(std::string_view name) -> std::pair<Binding *, bool>;
+  auto global(std::string_view name) -> Binding *;
+  auto declare(const Token &, FunctionPtr function) -> void;
+
+  // The function being analyzed can't be memoized
+  auto impure() -> void;
+
+  Arena &arena;
+  std::vector<std::unordered_map<std::string_view, Binding *>> scopes;
+  std::unordered_map<std::string_view, Binding *> globals;
+  Candidate *current;
+
+  // Deques, so that the pointers to the elements stay valid
+  std::deque<Binding> bindings;
+  std::deque<Candidate> candidates;
+};
+
+static_assert(ExprVisitor<Purity, void>);
+static_assert(StmtVisitor<Purity, void>);
+}  // namespace loxalone
+
+#endif  // LOXALONE_PURITY_H
@@ -4,6 +4,8 @@
 
 #include "Resolver.h"
 
+#include <algorithm>
+
 #include "Error.h"
 
 namespace loxalone {
@@ -14,14 +16,15 @@ auto Resolver::operator()(const BlockPtr &stmt) -> void {
 }
 
 auto Resolver::operator()(const FunctionPtr &stmt) -> void {
-  declare(stmt->name_m);
+  declare(stmt->name_m, &stmt->slot_m);
   define(stmt->name_m);
+  if (!scopes.empty()) scopes.back()[stmt->name_m.lexeme].function = stmt;
 
   resolve_function(stmt, FunctionType::FUNCTION);
 }
 
 auto Resolver::operator()(const VarPtr &stmt) -> void {
-  declare(stmt->name_m);
+  declare(stmt->name_m, &stmt->slot_m);
   if (!expr_is_null(stmt->initializer_m)) {
     resolve(stmt->initializer_m);
   }
@@ -34,13 +37,13 @@ auto Resolver::operator()(const VariablePtr &expr) -> void {
   if (!scopes.empty()) {
     const auto &last = scopes.back();
     if (auto find = last.find(expr->name_m.lexeme);
-        find != last.end() && !find->second) {
+        find != last.end() && !find->second.defined) {
       throw RuntimeError{expr->name_m,
                          "Can't read local variable in its own initializer."};
     }
   }
 
-  resolve_local(expr, expr->name_m);
+  resolve_variable(expr->name_m, &expr->slot_m);
 }
 
 auto Resolver::operator()(const AssignPtr &expr) -> void {
@@ -48,62 +51,211 @@ auto Resolver::operator()(const AssignPtr &expr) -> void {
   resolve(expr->value_m);
 
   // Resolve the variable that's being assigned to
-  resolve_local(expr, expr->name_m);
+  resolve_variable(expr->name_m, &expr->slot_m, true);
 }
 
-auto Resolver::resolve(const std::vector<Stmt> &stmts) -> void {
-  for (const auto &stmt : stmts) {
-    resolve(stmt);
+auto Resolver::resolve(List<Stmt> stmts) -> void {
+  if (function != nullptr) {
+    for (const auto &stmt : stmts) {
+      resolve(stmt);
+    }
+    return;
+  }
+
+  // Blocks at the top level live in the frame of the script itself
+  FunctionState script{nullptr, 0, 0, {}, nullptr};
+  function = &script;
+  try {
+    for (const auto &stmt : stmts) {
+      resolve(stmt);
+    }
+  } catch (...) {
+    // Start over from the top level next time, e.g. in the REPL
+    scopes.clear();
+    current = FunctionType::NONE;
+    current_class = ClassType::NONE;
+    function = nullptr;
+    throw;
   }
+  function = nullptr;
 }
 
 auto Resolver::resolve(const Stmt &stmt) -> void { visit(*this, stmt); }
 
 auto Resolver::resolve_function(const FunctionPtr &stmt, FunctionType type)
     -> void {
-  FunctionType enclosing = current;
+  FunctionType enclosing_type = current;
   current = type;
 
+  FunctionState state{function, scopes.size(), 0, {}, stmt};
+  function = &state;
+
+  // The slots are patched through pointers until the scope ends, so the
+  // vector must not be resized after this point
+  size_t receiver = type == FunctionType::FUNCTION ? 0 : 1;
+  auto &params = stmt->layout_m.params;
+  params.resize(receiver + stmt->params_m.size());
+
   begin_scope();
-  for (const auto &param : stmt->params_m) {
-    declare(param);
-    define(param);
+  if (receiver == 1) {
+    // `this` is a keyword, so it can't clash with the parameters
+    Token keyword{TokenType::THIS, "this", stmt->name_m.line};
+    declare(keyword, &params[0]);
+    define(keyword);
+  }
+  for (size_t i = 0; i < stmt->params_m.size(); i++) {
+    declare(stmt->params_m[i], &params[receiver + i]);
+    define(stmt->params_m[i]);
   }
   resolve(stmt->body_m);
   end_scope();
 
-  current = enclosing;
+  stmt->layout_m.captures = std::move(state.captures);
+  function = state.enclosing;
+  current = enclosing_type;
 }
 
 auto Resolver::resolve(const Expr &expr) -> void { visit(*this, expr); }
 
-template <IsExpr T>
-auto Resolver::resolve_local(const T &expr, const Token &token) -> void {
-  for (int i = static_cast<int>(scopes.size() - 1); i >= 0; i--) {
-    if (scopes[i].find(token.lexeme) != scopes[i].end()) {
-      interpreter.resolve(expr, scopes.size() - 1 - i);
-      return;
-    }
+auto Resolver::resolve_variable(const Token &token, Slot *slot, bool assign)
+    -> void {
+  if (auto *local = find_local(*function, scopes.size(), token.lexeme)) {
+    *slot = Slot{Slot::Kind::LOCAL, local->index};
+    local->uses.emplace_back(slot);
+    local->assigned = local->assigned || assign;
+    return;
+  }
+
+  // A function calling itself, e.g. recursively
+  if (auto *local = find_self(*function, token.lexeme)) {
+    *slot = Slot{Slot::Kind::SELF, 0};
+    local->self_uses.emplace_back(slot);
+    local->assigned = local->assigned || assign;
+    return;
+  }
+
+  if (int index = resolve_upvalue(*function, token.lexeme, assign);
+      index != -1) {
+    *slot = Slot{Slot::Kind::UPVALUE, index};
+    return;
+  }
+
+  // Not found in any of the scopes, assume it's a global
+  *slot = Slot{};
+}
+
+auto Resolver::find_local(const FunctionState &state, size_t scope_end,
+                          std::string_view name) -> Local * {
+  for (size_t i = scope_end; i > state.scope_base; i--) {
+    auto &scope = scopes[i - 1];
+    if (auto find = scope.find(name); find != scope.end())
+      return &find->second;
+  }
+  return nullptr;
+}
+
+auto Resolver::find_self(const FunctionState &state, std::string_view name)
+    -> Local * {
+  if (state.declaration == nullptr || state.enclosing == nullptr)
+    return nullptr;
+  auto *local = find_local(*state.enclosing, state.scope_base, name);
+  if (local == nullptr || local->function != state.declaration) return nullptr;
+  return local;
+}
+
+auto Resolver::resolve_upvalue(FunctionState &state, std::string_view name,
+                               bool assign) -> int {
+  if (state.enclosing == nullptr) return -1;
+
+  // The scopes of the enclosing function end where the current one's begin
+  if (auto *local = find_local(*state.enclosing, state.scope_base, name)) {
+    local->captured = true;
+    local->assigned = local->assigned || assign;
+    return add_capture(state, Capture{true, local->index});
   }
+
+  // A closure calling the function it's in gets the running function instead
+  if (auto *local = find_self(*state.enclosing, name)) {
+    local->assigned = local->assigned || assign;
+    int index = add_capture(state, Capture{false, 0, true});
+    local->self_captures.emplace_back(state.declaration, index);
+    return index;
+  }
+
+  if (int index = resolve_upvalue(*state.enclosing, name, assign);
+      index != -1)
+    return add_capture(state, Capture{false, index});
+
+  return -1;
+}
+
+auto Resolver::add_capture(FunctionState &state, Capture capture) -> int {
+  for (size_t i = 0; i < state.captures.size(); i++) {
+    const auto &existing = state.captures[i];
+    if (existing.is_local == capture.is_local &&
+        existing.index == capture.index && existing.is_self == capture.is_self)
+      return static_cast<int>(i);
+  }
+  state.captures.emplace_back(capture);
+  return static_cast<int>(state.captures.size() - 1);
+}
+
+auto Resolver::capture_self(Local &local) -> void {
+  // The function is resolved already, its captures are only appended to
+  auto &captures = local.function->layout_m.captures;
+  auto find = std::find_if(captures.begin(), captures.end(),
+                           [&](const Capture &capture) {
+                             return capture.is_local &&
+                                    capture.index == local.index;
+                           });
+  auto index = static_cast<int>(find - captures.begin());
+  if (find == captures.end()) captures.emplace_back(Capture{true, local.index});
+
+  for (Slot *use : local.self_uses) *use = Slot{Slot::Kind::UPVALUE, index};
+  for (auto &[closure, capture] : local.self_captures)
+    closure->layout_m.captures[capture] = Capture{false, index};
+  local.captured = true;
 }
 
 auto Resolver::begin_scope() -> void { scopes.emplace_back(); }
 
-auto Resolver::end_scope() -> void { scopes.pop_back(); }
+auto Resolver::end_scope() -> void {
+  auto &scope = scopes.back();
+  for (auto &[name, local] : scope) {
+    bool self = !local.self_uses.empty() || !local.self_captures.empty();
+    if (local.assigned && self) capture_self(local);
 
-auto Resolver::declare(const Token &token) -> void {
-  if (scopes.empty()) return;
+    // Only the variables captured by a closure need to be stored in a cell,
+    // the rest stay directly in the frame
+    if (!local.captured) continue;
+    for (Slot *use : local.uses) use->kind = Slot::Kind::CELL;
+  }
+
+  function->active_locals -= static_cast<int>(scope.size());
+  scopes.pop_back();
+}
+
+auto Resolver::declare(const Token &token, Slot *slot) -> void {
+  if (scopes.empty()) {
+    *slot = Slot{};
+    return;
+  }
 
   const auto &last = scopes.back();
   if (auto find = last.find(token.lexeme); find != last.end())
     throw RuntimeError{token,
                        "Already a variable with this name in this scope"};
-  scopes.back()[token.lexeme] = false;
+
+  // Slots are reused once the scope of a variable ends
+  int index = function->active_locals++;
+  *slot = Slot{Slot::Kind::LOCAL, index};
+  scopes.back().emplace(token.lexeme,
+                        Local{false, index, false, std::vector<Slot *>{slot}});
 }
 
 auto Resolver::define(const Token &token) -> void {
   if (scopes.empty()) return;
-  scopes.back()[token.lexeme] = true;
+  scopes.back()[token.lexeme].defined = true;
 }
 
 auto Resolver::operator()(const BinaryPtr &expr) -> void {
@@ -133,6 +285,63 @@ auto Resolver::operator()(const CallPtr &expr) -> void {
   }
 }
 
+auto Resolver::operator()(const GetPtr &expr) -> void {
+  // Properties are looked up dynamically, only the object is resolved
+  resolve(expr->object_m);
+}
+
+auto Resolver::operator()(const SetPtr &expr) -> void {
+  resolve(expr->value_m);
+  resolve(expr->object_m);
+}
+
+auto Resolver::operator()(const ListLiteralPtr &expr) -> void {
+  for (const auto &element : expr->elements_m) {
+    resolve(element);
+  }
+}
+
+auto Resolver::operator()(const MapLiteralPtr &expr) -> void {
+  for (size_t i = 0; i < expr->keys_m.size(); i++) {
+    resolve(expr->keys_m[i]);
+    resolve(expr->values_m[i]);
+  }
+}
+
+auto Resolver::operator()(const IndexPtr &expr) -> void {
+  resolve(expr->object_m);
+  resolve(expr->index_m);
+}
+
+auto Resolver::operator()(const SetIndexPtr &expr) -> void {
+  resolve(expr->object_m);
+  resolve(expr->index_m);
+  resolve(expr->value_m);
+}
+
+auto Resolver::operator()(const SuperPtr &expr) -> void {
+  if (current_class == ClassType::NONE)
+    throw RuntimeError{expr->keyword_m,
+                       "Can't use 'super' outside of a class."};
+  if (current_class != ClassType::SUBCLASS)
+    throw RuntimeError{expr->keyword_m,
+                       "Can't use 'super' in a class with no superclass."};
+
+  // The method is looked up in the superclass and bound to `this`
+  resolve_variable(expr->keyword_m, &expr->slot_m);
+  resolve_variable(
+      Token{TokenType::THIS, "this", expr->keyword_m.line},
+      &expr->receiver_m);
+}
+
+auto Resolver::operator()(const ThisPtr &expr) -> void {
+  if (current_class == ClassType::NONE)
+    throw RuntimeError{expr->keyword_m,
+                       "Can't use 'this' outside of a class."};
+
+  resolve_variable(expr->keyword_m, &expr->slot_m);
+}
+
 auto Resolver::operator()(const ExpressionPtr &stmt) -> void {
   resolve(stmt->expression_m);
 }
@@ -152,16 +361,64 @@ auto Resolver::operator()(const WhilePtr &stmt) -> void {
   resolve(stmt->body_m);
 }
 
+auto Resolver::operator()(const ForInPtr &stmt) -> void {
+  resolve(stmt->iterable_m);
+
+  // The loop variable gets a scope of its own around the body, it's bound
+  // again for every element
+  begin_scope();
+  declare(stmt->name_m, &stmt->slot_m);
+  define(stmt->name_m);
+  resolve(stmt->body_m);
+  end_scope();
+}
+
 auto Resolver::operator()(const ReturnPtr &stmt) -> void {
   if (current == FunctionType::NONE)
     throw RuntimeError{stmt->keyword_m, "Can't return from top-level code."};
+  if (current == FunctionType::INITIALIZER && !expr_is_null(stmt->value_m))
+    throw RuntimeError{stmt->keyword_m,
+                       "Can't return a value from an initializer."};
 
   if (!expr_is_null(stmt->value_m)) resolve(stmt->value_m);
 }
 
 auto Resolver::operator()(const ClassPtr &stmt) -> void {
-  declare(stmt->name_m);
+  ClassType enclosing_class = current_class;
+  current_class = ClassType::CLASS;
+
+  declare(stmt->name_m, &stmt->slot_m);
   define(stmt->name_m);
+
+  // The superclass is bound to `super` in a scope around the methods, so the
+  // methods using it capture it like any other variable
+  bool has_superclass = !expr_is_null(stmt->superclass_m);
+  if (has_superclass) {
+    const auto &superclass = std::get<VariablePtr>(stmt->superclass_m);
+    if (superclass->name_m.lexeme == stmt->name_m.lexeme)
+      throw RuntimeError{superclass->name_m,
+                         "A class can't inherit from itself."};
+
+    current_class = ClassType::SUBCLASS;
+    resolve(stmt->superclass_m);
+
+    begin_scope();
+    Token keyword{TokenType::SUPER, "super", stmt->name_m.line};
+    declare(keyword, &stmt->super_slot_m);
+    define(keyword);
+  }
+
+  for (const auto &method : stmt->methods_m) {
+    resolve_function(method, method->name_m.lexeme == "init"
+                                 ? FunctionType::INITIALIZER
+                                 : FunctionType::METHOD);
+  }
+
+  if (has_superclass) end_scope();
+  current_class = enclosing_class;
 }
 
+// The module is resolved on its own when it's loaded
+auto Resolver::operator()(const ImportPtr &stmt) -> void {}
+
 }  // namespace loxalone
\ No newline at end of file
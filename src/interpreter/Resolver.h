@@ -8,10 +8,10 @@
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Expr.h"
-#include "Interpreter.h"
 #include "Stmt.h"
 #include "Token.h"
 
@@ -19,20 +19,31 @@ namespace loxalone {
 
 class Resolver {
  public:
-  explicit Resolver(Interpreter &interpreter)
-      : interpreter{interpreter}, scopes{}, current{FunctionType::NONE} {}
+  Resolver()
+      : scopes{},
+        current{FunctionType::NONE},
+        current_class{ClassType::NONE},
+        function{nullptr} {}
 
-  auto resolve(const std::vector<Stmt> &) -> void;
+  auto resolve(List<Stmt>) -> void;
 
   // Expression visitor
   auto operator()(const BinaryPtr &expr) -> void;
   auto operator()(const GroupingPtr &expr) -> void;
+  auto operator()(const IndexPtr &expr) -> void;
+  auto operator()(const ListLiteralPtr &expr) -> void;
   auto operator()(const LiteralPtr &expr) -> void;
+  auto operator()(const MapLiteralPtr &expr) -> void;
   auto operator()(const UnaryPtr &expr) -> void;
   auto operator()(const VariablePtr &expr) -> void;
   auto operator()(const AssignPtr &expr) -> void;
   auto operator()(const LogicalPtr &expr) -> void;
   auto operator()(const CallPtr &expr) -> void;
+  auto operator()(const GetPtr &expr) -> void;
+  auto operator()(const SetPtr &expr) -> void;
+  auto operator()(const SetIndexPtr &expr) -> void;
+  auto operator()(const SuperPtr &expr) -> void;
+  auto operator()(const ThisPtr &expr) -> void;
 
   // Statement visitors
   auto operator()(const BlockPtr &stmt) -> void;
@@ -42,29 +53,77 @@ class Resolver {
   auto operator()(const VarPtr &stmt) -> void;
   auto operator()(const IfPtr &stmt) -> void;
   auto operator()(const WhilePtr &stmt) -> void;
+  auto operator()(const ForInPtr &stmt) -> void;
   auto operator()(const ReturnPtr &stmt) -> void;
   auto operator()(const ClassPtr &stmt) -> void;
+  auto operator()(const ImportPtr &stmt) -> void;
 
  private:
-  enum class FunctionType { NONE, FUNCTION };
+  enum class FunctionType { NONE, FUNCTION, METHOD, INITIALIZER };
+  enum class ClassType { NONE, CLASS, SUBCLASS };
+
+  // State of a declared local variable. `defined` is false while the variable
+  // initializer is being resolved and `index` is the frame slot of the
+  // variable. `uses` are the slots of every node referring to the variable
+  // directly, they are turned into cells if a closure captures the variable.
+  //
+  // `function` is set if the variable is declared by a function declaration,
+  // `self_uses` are then the slots of the function's own body referring to
+  // it, and `self_captures` the captures of it by the closures directly
+  // inside of the function, as indices into their captures. They are
+  // captured like any other variable if it's ever assigned.
+  struct Local {
+    bool defined;
+    int index;
+    bool captured;
+    std::vector<Slot *> uses;
+    FunctionPtr function{};
+    bool assigned = false;
+    std::vector<Slot *> self_uses{};
+    std::vector<std::pair<FunctionPtr, int>> self_captures{};
+  };
+
+  // Resolution state of the function being resolved. Its scopes are the ones
+  // from `scope_base` to the end of `scopes`. `declaration` is null for the
+  // script.
+  struct FunctionState {
+    FunctionState *enclosing;
+    size_t scope_base;
+    int active_locals;
+    std::vector<Capture> captures;
+    FunctionPtr declaration;
+  };
 
   auto resolve(const Stmt &) -> void;
   auto resolve_function(const FunctionPtr &stmt, FunctionType type) -> void;
+  // Captures the variable for the uses of a function of itself, once it turns
+  // out to be assigned
+  auto capture_self(Local &) -> void;
 
   auto resolve(const Expr &) -> void;
 
-  template <IsExpr T>
-  auto resolve_local(const T &, const Token &) -> void;
-
-  auto declare(const Token &) -> void;
+  // Resolves the variable with the given name from the function, updating
+  // `slot` to where the variable is found. `assign` is set for assignments.
+  auto resolve_variable(const Token &, Slot *slot, bool assign = false)
+      -> void;
+  auto find_local(const FunctionState &, size_t scope_end,
+                  std::string_view name) -> Local *;
+  // Finds the variable holding the function itself if the name refers to it
+  auto find_self(const FunctionState &, std::string_view name) -> Local *;
+  auto resolve_upvalue(FunctionState &, std::string_view name, bool assign)
+      -> int;
+  auto add_capture(FunctionState &, Capture) -> int;
+
+  auto declare(const Token &, Slot *slot) -> void;
   auto define(const Token &) -> void;
 
   auto begin_scope() -> void;
   auto end_scope() -> void;
 
-  Interpreter &interpreter;
-  std::vector<std::unordered_map<std::string, bool>> scopes;
+  std::vector<std::unordered_map<std::string_view, Local>> scopes;
   FunctionType current;
+  ClassType current_class;
+  FunctionState *function;
 };
 
 static_assert(ExprVisitor<Resolver, void>);
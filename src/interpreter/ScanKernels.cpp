@@ -0,0 +1,205 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "ScanKernels.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace loxalone {
+
+namespace {
+
+enum CharClass : uint8_t { IDENTIFIER = 1, DIGIT = 2, WHITESPACE = 4 };
+
+constexpr auto make_classes() -> std::array<uint8_t, 256> {
+  std::array<uint8_t, 256> classes{};
+  for (int c = 'a'; c <= 'z'; c++) classes[c] = IDENTIFIER;
+  for (int c = 'A'; c <= 'Z'; c++) classes[c] = IDENTIFIER;
+  for (int c = '0'; c <= '9'; c++) classes[c] = IDENTIFIER | DIGIT;
+  classes['_'] = IDENTIFIER;
+  for (int c : {' ', '\t', '\r', '\n'}) classes[c] = WHITESPACE;
+  return classes;
+}
+
+constexpr std::array<uint8_t, 256> CLASSES = make_classes();
+
+auto has_class(char c, CharClass cls) -> bool {
+  return (CLASSES[static_cast<unsigned char>(c)] & cls) != 0;
+}
+
+auto skip_identifier_scalar(const char* begin, const char* end)
+    -> const char* {
+  while (begin < end && has_class(*begin, IDENTIFIER)) begin++;
+  return begin;
+}
+
+auto skip_digits_scalar(const char* begin, const char* end) -> const char* {
+  while (begin < end && has_class(*begin, DIGIT)) begin++;
+  return begin;
+}
+
+auto skip_whitespace_scalar(const char* begin, const char* end, int& lines)
+    -> const char* {
+  for (; begin < end && has_class(*begin, WHITESPACE); begin++) {
+    if (*begin == '\n') lines++;
+  }
+  return begin;
+}
+
+constexpr ScanKernels SCALAR{"scalar", &skip_identifier_scalar,
+                             &skip_digits_scalar, &skip_whitespace_scalar};
+
+#if defined(__x86_64__)
+
+// SSE2 is part of x86-64, so these need no check. The characters of a vector
+// are classified with compares, the first one outside of the class is found
+// from the mask of the results. The characters left at the end are handled
+// one by one.
+
+auto in_range(__m128i chars, char low, char high) -> __m128i {
+  return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(low - 1)),
+                       _mm_cmpgt_epi8(_mm_set1_epi8(high + 1), chars));
+}
+
+auto skip_identifier_sse2(const char* begin, const char* end) -> const char* {
+  for (; end - begin >= 16; begin += 16) {
+    auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    // Setting the 0x20 bit turns upper case letters into lower case ones
+    __m128i letters = in_range(_mm_or_si128(chars, _mm_set1_epi8(0x20)), 'a',
+                               'z');
+    __m128i others = _mm_or_si128(in_range(chars, '0', '9'),
+                                  _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+    auto stop = ~static_cast<uint32_t>(
+                    _mm_movemask_epi8(_mm_or_si128(letters, others))) &
+                0xFFFF;
+    if (stop != 0) return begin + std::countr_zero(stop);
+  }
+  return skip_identifier_scalar(begin, end);
+}
+
+auto skip_digits_sse2(const char* begin, const char* end) -> const char* {
+  for (; end - begin >= 16; begin += 16) {
+    auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    auto stop =
+        ~static_cast<uint32_t>(_mm_movemask_epi8(in_range(chars, '0', '9'))) &
+        0xFFFF;
+    if (stop != 0) return begin + std::countr_zero(stop);
+  }
+  return skip_digits_scalar(begin, end);
+}
+
+auto skip_whitespace_sse2(const char* begin, const char* end, int& lines)
+    -> const char* {
+  for (; end - begin >= 16; begin += 16) {
+    auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    __m128i newlines = _mm_cmpeq_epi8(chars, _mm_set1_epi8('\n'));
+    __m128i blanks =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')),
+                                  _mm_cmpeq_epi8(chars, _mm_set1_epi8('\t'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('\r')),
+                                  newlines));
+    auto newline_bits = static_cast<uint32_t>(_mm_movemask_epi8(newlines));
+    auto stop = ~static_cast<uint32_t>(_mm_movemask_epi8(blanks)) & 0xFFFF;
+    if (stop != 0) {
+      int length = std::countr_zero(stop);
+      lines += std::popcount(newline_bits & ((1u << length) - 1));
+      return begin + length;
+    }
+    lines += std::popcount(newline_bits);
+  }
+  return skip_whitespace_scalar(begin, end, lines);
+}
+
+constexpr ScanKernels SSE2{"sse2", &skip_identifier_sse2, &skip_digits_sse2,
+                           &skip_whitespace_sse2};
+
+// The AVX2 versions are compiled for AVX2 regardless of the flags of the
+// build, they are only called after checking that the CPU supports it
+
+#define LOXALONE_AVX2 __attribute__((target("avx2")))
+
+LOXALONE_AVX2 auto in_range(__m256i chars, char low, char high) -> __m256i {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8(low - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(high + 1), chars));
+}
+
+LOXALONE_AVX2 auto skip_identifier_avx2(const char* begin, const char* end)
+    -> const char* {
+  for (; end - begin >= 32; begin += 32) {
+    auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    __m256i letters = in_range(
+        _mm256_or_si256(chars, _mm256_set1_epi8(0x20)), 'a', 'z');
+    __m256i others =
+        _mm256_or_si256(in_range(chars, '0', '9'),
+                        _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_')));
+    auto stop = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_or_si256(letters, others)));
+    if (stop != 0) return begin + std::countr_zero(stop);
+  }
+  return skip_identifier_sse2(begin, end);
+}
+
+LOXALONE_AVX2 auto skip_digits_avx2(const char* begin, const char* end)
+    -> const char* {
+  for (; end - begin >= 32; begin += 32) {
+    auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    auto stop = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(in_range(chars, '0', '9')));
+    if (stop != 0) return begin + std::countr_zero(stop);
+  }
+  return skip_digits_sse2(begin, end);
+}
+
+LOXALONE_AVX2 auto skip_whitespace_avx2(const char* begin, const char* end,
+                                        int& lines) -> const char* {
+  for (; end - begin >= 32; begin += 32) {
+    auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    __m256i newlines = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\n'));
+    __m256i blanks = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('\r')),
+                        newlines));
+    auto newline_bits = static_cast<uint32_t>(_mm256_movemask_epi8(newlines));
+    auto stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(blanks));
+    if (stop != 0) {
+      int length = std::countr_zero(stop);
+      lines += std::popcount(newline_bits & ((1u << length) - 1));
+      return begin + length;
+    }
+    lines += std::popcount(newline_bits);
+  }
+  return skip_whitespace_sse2(begin, end, lines);
+}
+
+#undef LOXALONE_AVX2
+
+constexpr ScanKernels AVX2{"avx2", &skip_identifier_avx2, &skip_digits_avx2,
+                           &skip_whitespace_avx2};
+
+#endif
+
+auto detect() -> const ScanKernels& {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("avx2")) return AVX2;
+  return SSE2;
+#else
+  return SCALAR;
+#endif
+}
+
+}  // namespace
+
+auto scan_kernels() -> const ScanKernels& {
+  static const ScanKernels& kernels = detect();
+  return kernels;
+}
+
+}  // namespace loxalone
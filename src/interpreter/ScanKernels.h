@@ -0,0 +1,35 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_SCANKERNELS_H
+#define LOXALONE_SCANKERNELS_H
+
+namespace loxalone {
+
+/*
+ * ScanKernels skip runs of characters of one class for the scanner, they
+ * return the first character at or after `begin` that is not in the class, or
+ * `end`. There is a plain C++ version of every kernel, and on x86-64 an SSE2
+ * and an AVX2 version too, which classify 16 or 32 characters at once. Like
+ * the array kernels, the fastest set the CPU supports is picked the first
+ * time the kernels are used.
+ * */
+struct ScanKernels {
+  const char* name;
+
+  // Letters, digits and underscores
+  const char* (*skip_identifier)(const char* begin, const char* end);
+  const char* (*skip_digits)(const char* begin, const char* end);
+  // Spaces, tabs, carriage returns and newlines. The newlines skipped are
+  // added to `lines`.
+  const char* (*skip_whitespace)(const char* begin, const char* end,
+                                 int& lines);
+};
+
+// Returns the kernels for the running CPU
+auto scan_kernels() -> const ScanKernels&;
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_SCANKERNELS_H
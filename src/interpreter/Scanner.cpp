@@ -4,133 +4,180 @@
 
 #include "Scanner.h"
 
-#include <string>
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
 
 #include "Error.h"
 
 namespace loxalone {
-static std::unordered_map<std::string, TokenType> keywords{
+
+namespace {
+
+struct Keyword {
+  std::string_view text;
+  TokenType type;
+};
+
+constexpr Keyword KEYWORDS[] = {
     {"and", TokenType::AND},       {"class", TokenType::CLASS},
     {"else", TokenType::ELSE},     {"false", TokenType::FALSE},
     {"for", TokenType::FOR},       {"fun", TokenType::FUN},
-    {"if", TokenType::IF},         {"nil", TokenType::NIL},
+    {"if", TokenType::IF},         {"import", TokenType::IMPORT},
+    {"in", TokenType::IN},         {"nil", TokenType::NIL},
     {"or", TokenType::OR},         {"print", TokenType::PRINT},
     {"return", TokenType::RETURN}, {"super", TokenType::SUPER},
     {"this", TokenType::THIS},     {"true", TokenType::TRUE},
     {"var", TokenType::VAR},       {"while", TokenType::WHILE}};
 
+// Keywords are 2 to 6 characters long, and no two of them share a slot of
+// this hash, so looking up an identifier is one hash and one comparison
+constexpr size_t KEYWORD_SLOTS = 32;
+
+constexpr auto keyword_hash(std::string_view text) -> size_t {
+  return (static_cast<unsigned char>(text[0]) +
+          static_cast<unsigned char>(text[1]) * 19 + text.size() * 20) %
+         KEYWORD_SLOTS;
+}
+
+constexpr auto make_keyword_table() -> std::array<Keyword, KEYWORD_SLOTS> {
+  std::array<Keyword, KEYWORD_SLOTS> table{};
+  table.fill(Keyword{"", TokenType::IDENTIFIER});
+  for (const auto& keyword : KEYWORDS)
+    table[keyword_hash(keyword.text)] = keyword;
+  return table;
+}
+
+constexpr std::array<Keyword, KEYWORD_SLOTS> KEYWORD_TABLE =
+    make_keyword_table();
+
+constexpr auto is_perfect() -> bool {
+  return std::all_of(std::begin(KEYWORDS), std::end(KEYWORDS),
+                     [](const Keyword& keyword) {
+                       return KEYWORD_TABLE[keyword_hash(keyword.text)].text ==
+                              keyword.text;
+                     });
+}
+
+static_assert(is_perfect(), "Two keywords share a slot of the keyword table");
+
+auto keyword_type(std::string_view text) -> TokenType {
+  if (text.size() < 2 || text.size() > 6) return TokenType::IDENTIFIER;
+  const Keyword& keyword = KEYWORD_TABLE[keyword_hash(text)];
+  return keyword.text == text ? keyword.type : TokenType::IDENTIFIER;
+}
+
 auto is_digit(char ch) -> bool { return ch >= '0' && ch <= '9'; }
 
 auto is_alpha(char ch) -> bool {
   return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch == '_');
 }
 
-auto is_alphanumeric(char ch) -> bool { return is_alpha(ch) || is_digit(ch); }
+}  // namespace
 
 auto Scanner::scan_tokens() -> std::optional<std::vector<Token>> {
+  // Scripts average 2 to 5 characters per token, growing the list is most of
+  // the cost of scanning otherwise
+  std::vector<Token> tokens{};
+  tokens.reserve(source.size() / 4 + 1);
+  do {
+    tokens.emplace_back(next_token());
+  } while (tokens.back().type != TokenType::EOF_);
+
+  if (!well_formed_m) return std::nullopt;
+  return std::optional{std::move(tokens)};
+}
+
+auto Scanner::next_token() -> Token {
   while (!is_at_end()) {
     start_m = current_m;
-    scan_token();
+    if (auto token = scan_token()) return token.value();
   }
-
-  tokens.emplace_back(TokenType::EOF_, "", std::nullopt, line_m);
-  return well_formed_m ? std::optional{tokens} : std::nullopt;
+  return Token{TokenType::EOF_, "", line_m};
 }
 
-// TODO: Implement
-auto Scanner::scan_token() -> void {
+auto Scanner::scan_token() -> std::optional<Token> {
   char c = advance();
 
   switch (c) {
     case '(':
-      add_token(TokenType::LEFT_PAREN);
-      break;
+      return make_token(TokenType::LEFT_PAREN);
     case ')':
-      add_token(TokenType::RIGHT_PAREN);
-      break;
+      return make_token(TokenType::RIGHT_PAREN);
     case '{':
-      add_token(TokenType::LEFT_BRACE);
-      break;
+      return make_token(TokenType::LEFT_BRACE);
     case '}':
-      add_token(TokenType::RIGHT_BRACE);
-      break;
+      return make_token(TokenType::RIGHT_BRACE);
+    case '[':
+      return make_token(TokenType::LEFT_BRACKET);
+    case ']':
+      return make_token(TokenType::RIGHT_BRACKET);
+    case ':':
+      return make_token(TokenType::COLON);
     case ',':
-      add_token(TokenType::COMMA);
-      break;
+      return make_token(TokenType::COMMA);
     case '.':
-      add_token(TokenType::DOT);
-      break;
+      return make_token(TokenType::DOT);
     case '-':
-      add_token(TokenType::MINUS);
-      break;
+      return make_token(TokenType::MINUS);
     case '+':
-      add_token(TokenType::PLUS);
-      break;
+      return make_token(TokenType::PLUS);
     case ';':
-      add_token(TokenType::SEMICOLON);
-      break;
+      return make_token(TokenType::SEMICOLON);
     case '*':
-      add_token(TokenType::STAR);
-      break;
+      return make_token(TokenType::STAR);
     case '!':
-      add_token(match('=') ? TokenType::BANG_EQUAL : TokenType::BANG);
-      break;
+      return make_token(match('=') ? TokenType::BANG_EQUAL : TokenType::BANG);
     case '=':
-      add_token(match('=') ? TokenType::EQUAL_EQUAL : TokenType::EQUAL);
-      break;
+      return make_token(match('=') ? TokenType::EQUAL_EQUAL
+                                   : TokenType::EQUAL);
     case '<':
-      add_token(match('=') ? TokenType::LESS_EQUAL : TokenType::LESS);
-      break;
+      return make_token(match('=') ? TokenType::LESS_EQUAL : TokenType::LESS);
     case '>':
-      add_token(match('=') ? TokenType::GREATER_EQUAL : TokenType::GREATER);
-      break;
+      return make_token(match('=') ? TokenType::GREATER_EQUAL
+                                   : TokenType::GREATER);
     case '/':
       if (match('/')) {
-        while (peek() != '\n' && !is_at_end()) advance();
-      } else if (match('*')) {
-        bool done = false;
-        while (peek() != '\n' && !is_at_end() && !done) {
-          char now = advance();
-          if (now == '*' && peek() == '/') {
-            advance();  // consume "/"
-            done = true;
-          }
+        skip_to(line_end());
+        break;
+      }
+      if (match('*')) {
+        // Block comments have to be closed on the line they start
+        const char* end = line_end();
+        auto close =
+            std::string_view{cursor(), static_cast<size_t>(end - cursor())}
+                .find("*/");
+        if (close != std::string_view::npos) {
+          skip_to(cursor() + close + 2);
+          break;
         }
 
-        // done = comment was well-formed, scanning is done
-        // if done is false, we reached the end without closing the comment
-        if (done) break;
-
+        skip_to(end);
         scanner_error(line_m, "Unterminated block comment.");
-      } else {
-        add_token(TokenType::SLASH);
+        break;
       }
-      break;
+      return make_token(TokenType::SLASH);
     case '"':
-      string();
-      break;
+      return string();
 
-    // Whitespaces
+    // Whitespaces, the rest of the run is skipped at once
+    case '\n':
+      line_m++;
+      [[fallthrough]];
     case ' ':
     case '\t':
     case '\r':
-      break;
-    case '\n':
-      line_m++;
+      skip_to(kernels.skip_whitespace(cursor(), source_end(), line_m));
       break;
     default:
-      // TODO: This should set an parser_error flag in Lox so we won't execute
-      //       the malformed program though we can just return empty tokens_m
-      //       or result from top-level scan_tokens()?
-      if (is_digit(c)) {
-        number();
-      } else if (is_alpha(c)) {
-        identifier();
-      } else {
-        scanner_error(line_m, "Unexpected character.");
-      }
+      if (is_digit(c)) return number();
+      if (is_alpha(c)) return identifier();
+      scanner_error(line_m, "Unexpected character.");
   }
+
+  // Whitespaces, comments and unexpected characters
+  return std::nullopt;
 }
 
 auto Scanner::is_at_end() -> bool { return current_m >= source.length(); }
@@ -151,64 +198,62 @@ auto Scanner::peek() -> char {
   return source[current_m];
 }
 
+auto Scanner::cursor() -> const char* { return source.data() + current_m; }
+
+auto Scanner::source_end() -> const char* {
+  return source.data() + source.size();
+}
+
+auto Scanner::skip_to(const char* position) -> void {
+  current_m = static_cast<int>(position - source.data());
+}
+
 auto Scanner::peek_next() -> char {
   if (current_m + 1 >= source.length()) return '\0';
   return source[current_m + 1];
 }
 
-auto Scanner::string() -> void {
-  while (peek() != '"' && !is_at_end()) {
-    if (peek() == '\n') line_m++;
-    advance();
-  }
+auto Scanner::string() -> std::optional<Token> {
+  const auto* close = static_cast<const char*>(
+      std::memchr(cursor(), '"', source_end() - cursor()));
+  const char* end = close == nullptr ? source_end() : close;
+  line_m += static_cast<int>(std::count(cursor(), end, '\n'));
+  skip_to(end);
 
   if (is_at_end()) {
     scanner_error(line_m, "Unterminated string.");
-    return;
+    return std::nullopt;
   }
 
   advance();  // consume the closing "
-  std::string value{source.begin() + start_m + 1,
-                    source.begin() + current_m - 1};
-  add_token(TokenType::STRING, std::string{source.begin() + start_m + 1,
-                                           source.begin() + current_m - 1});
+  return make_token(TokenType::STRING);
 }
 
-auto Scanner::number() -> void {
-  while (is_digit(peek())) advance();
+auto Scanner::number() -> Token {
+  skip_to(kernels.skip_digits(cursor(), source_end()));
 
   if (peek() == '.' && is_digit(peek_next())) {
     advance();  // consume the "."
 
-    while (is_digit(peek())) advance();
+    skip_to(kernels.skip_digits(cursor(), source_end()));
   }
 
-  add_token(TokenType::NUMBER,
-            std::stod(std::string{source.begin() + start_m,
-                                  source.begin() + current_m}));
+  return make_token(TokenType::NUMBER);
 }
 
-auto Scanner::identifier() -> void {
-  while (is_alphanumeric(peek())) advance();
-
-  std::string text =
-      std::string{source.begin() + start_m, source.begin() + current_m};
-  auto result = keywords.find(text);
-  if (result != keywords.end())
-    add_token(result->second);
-  else
-    add_token(TokenType::IDENTIFIER);
+auto Scanner::identifier() -> Token {
+  skip_to(kernels.skip_identifier(cursor(), source_end()));
+  return make_token(keyword_type(source.substr(start_m, current_m - start_m)));
 }
 
-auto Scanner::add_token(TokenType type) -> void {
-  add_token(type, std::nullopt);
+auto Scanner::line_end() -> const char* {
+  const auto* newline = static_cast<const char*>(
+      std::memchr(cursor(), '\n', source_end() - cursor()));
+  return newline == nullptr ? source_end() : newline;
 }
 
-auto Scanner::add_token(TokenType type, std::optional<lox_literal>&& literal)
-    -> void {
-  tokens.emplace_back(
-      type, std::string{source.begin() + start_m, source.begin() + current_m},
-      std::move(literal), line_m);
+auto Scanner::make_token(TokenType type) -> Token {
+  return Token{type, source.substr(start_m, current_m - start_m), line_m};
 }
 
 auto Scanner::scanner_error(int line, const std::string_view& msg) -> void {
@@ -6,37 +6,58 @@
 #define LOXALONE_SCANNER_H
 
 #include <optional>
-#include <string>
+#include <string_view>
 #include <vector>
 
+#include "ScanKernels.h"
 #include "Token.h"
 
 namespace loxalone {
+// The lexemes of the tokens are views on the source, so it must outlive them.
+// Runs of whitespace, identifier and digit characters are skipped with the
+// scan kernels, comments and strings are skipped with memchr.
 class Scanner {
  public:
-  explicit Scanner(const std::string_view& source) : source{source}, tokens{} {}
+  explicit Scanner(const std::string_view& source)
+      : source{source}, kernels{scan_kernels()} {}
 
+  // Scans the next token, the parser pulls the tokens one by one so only a
+  // few of them exist at a time. Returns EOF_ tokens once the source is used
+  // up. Errors are reported as they are found.
+  auto next_token() -> Token;
+
+  // Scans all of the tokens at once, up to and including the EOF_ token.
+  // Returns nullopt if any of them is malformed.
   auto scan_tokens() -> std::optional<std::vector<Token>>;
 
+  // False once a malformed token was found
+  auto well_formed() const -> bool { return well_formed_m; }
+
  private:
-  auto scan_token() -> void;
+  // Returns nullopt for whitespaces, comments and errors
+  auto scan_token() -> std::optional<Token>;
   auto is_at_end() -> bool;
   auto advance() -> char;
   auto match(char c) -> bool;
   auto peek() -> char;
   auto peek_next() -> char;
 
-  auto string() -> void;
-  auto number() -> void;
-  auto identifier() -> void;
+  // Moves between the current position and pointers into the source
+  auto cursor() -> const char*;
+  auto source_end() -> const char*;
+  auto skip_to(const char* position) -> void;
+  auto line_end() -> const char*;
+
+  auto string() -> std::optional<Token>;
+  auto number() -> Token;
+  auto identifier() -> Token;
 
-  auto add_token(TokenType) -> void;
-  auto add_token(TokenType, std::optional<lox_literal>&&) -> void;
+  auto make_token(TokenType) -> Token;
 
   auto scanner_error(int line, const std::string_view& msg) -> void;
 
-  const std::string_view& source;
-  std::vector<Token> tokens;
+  const std::string_view source;
+  const ScanKernels& kernels;
 
   int start_m = 0;
   int current_m = 0;
@@ -0,0 +1,36 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Shape.h"
+
+namespace loxalone {
+
+auto Shape::root() -> const Shape * {
+  // Leaked on purpose, shapes must outlive every cache pointing to them
+  static const Shape *root = new Shape{};
+  return root;
+}
+
+auto Shape::find(const StringObj *name) const -> int {
+  // Instances rarely have many fields and the names are interned, so a
+  // linear scan comparing pointers is the fastest way here
+  for (size_t i = 0; i < fields.size(); i++) {
+    if (fields[i].get() == name) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+auto Shape::with(const Ref<StringObj> &name) const -> const Shape * {
+  for (const auto &child : transitions) {
+    if (child->fields.back() == name) return child.get();
+  }
+
+  auto child = std::unique_ptr<Shape>{new Shape{}};
+  child->fields = fields;
+  child->fields.emplace_back(name);
+  transitions.emplace_back(std::move(child));
+  return transitions.back().get();
+}
+
+}  // namespace loxalone
@@ -0,0 +1,103 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_SHAPE_H
+#define LOXALONE_SHAPE_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Value.h"
+
+namespace loxalone {
+
+class LoxCallable;
+
+/*
+ * Shape (a.k.a. hidden class) describes the fields of an instance. Instances
+ * that got the same fields added in the same order share their shape, and
+ * keep the values of their fields at the same indexes of a plain array, so
+ * the name of a field is only looked up once per shape.
+ *
+ * Shapes form a tree of transitions starting from the empty shape, adding a
+ * field to an instance moves it to the child shape for that field. Shapes are
+ * never freed, so a pointer to a shape can be cached safely.
+ * */
+class Shape {
+ public:
+  // The shape of an instance without any field
+  static auto root() -> const Shape *;
+
+  // Returns the index of the field, or -1 if there is no such field
+  auto find(const StringObj *name) const -> int;
+
+  // Returns the shape with the field added after the existing ones
+  auto with(const Ref<StringObj> &name) const -> const Shape *;
+
+  auto size() const -> int { return static_cast<int>(fields.size()); }
+
+ private:
+  Shape() = default;
+
+  std::vector<Ref<StringObj>> fields;
+
+  // Children of this shape, created the first time a field is added to an
+  // instance of this shape
+  mutable std::vector<std::unique_ptr<Shape>> transitions;
+};
+
+/*
+ * PropertyCache is the inline cache of a property access site. It remembers
+ * where the property is for the last few shapes seen at the site, so most
+ * accesses skip the lookup altogether. A site that only sees one shape is
+ * monomorphic and hits the first entry, polymorphic sites keep up to `SIZE`
+ * shapes and replace the oldest one after that.
+ * */
+struct PropertyCache {
+  static constexpr int SIZE = 4;
+
+  // The field is at `index` for instances of `shape`, or -1 if they don't
+  // have it. When a field is added by an assignment, `next` is the shape the
+  // instance moves to, otherwise it's the same shape.
+  struct Entry {
+    const Shape *shape = nullptr;
+    const Shape *next = nullptr;
+    int index = -1;
+  };
+
+  auto find(const Shape *shape) -> Entry * {
+    for (auto &entry : entries) {
+      if (entry.shape == shape) return &entry;
+    }
+    return nullptr;
+  }
+
+  auto add(Entry entry) -> Entry * {
+    Entry &slot = entries[victim];
+    victim = (victim + 1) % SIZE;
+    slot = entry;
+    return &slot;
+  }
+
+  std::array<Entry, SIZE> entries{};
+  uint8_t victim = 0;
+};
+
+/*
+ * MethodCache is the inline cache of a method call site. It remembers the
+ * method found for the last class seen at the site, so calling a method on
+ * instances of the same class doesn't search the method table every time.
+ * Classes are identified by their ids, which are never reused, so the cached
+ * method is only used while its class is still alive.
+ * */
+struct MethodCache {
+  uint64_t class_id = 0;
+  LoxCallable *method = nullptr;
+};
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_SHAPE_H
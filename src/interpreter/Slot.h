@@ -0,0 +1,55 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_SLOT_H
+#define LOXALONE_SLOT_H
+
+#include <cstdint>
+#include <vector>
+
+namespace loxalone {
+
+// Slot is the location of a resolved variable, computed by the resolver.
+//
+// - GLOBAL variables are looked up by their names.
+// - LOCAL variables live in the slot `index` of the current call frame.
+// - CELL variables are locals captured by a closure, the frame slot holds a
+//   cell shared with the closures and the value lives inside the cell.
+// - UPVALUE variables belong to an enclosing function, `index` is the
+//   position of the captured cell in the current closure.
+// - SELF is a local function referring to itself by its name, which is never
+//   assigned. It's the running function, so the function doesn't capture the
+//   cell holding it, which would keep both alive forever.
+struct Slot {
+  enum class Kind : uint8_t { GLOBAL, LOCAL, CELL, UPVALUE, SELF };
+
+  Kind kind = Kind::GLOBAL;
+  int index = 0;
+
+  auto is_global() const -> bool { return kind == Kind::GLOBAL; }
+};
+
+// Capture describes where a closure gets one of its upvalues from when it's
+// created. If `is_local` is true, it's the cell in the slot `index` of the
+// enclosing function's frame, otherwise it's the upvalue `index` of the
+// enclosing closure. If `is_self` is true, it's a new cell holding the
+// enclosing closure itself, which the closure refers to like a SELF slot.
+struct Capture {
+  bool is_local;
+  int index;
+  bool is_self = false;
+};
+
+// FunctionLayout is the resolved shape of a function's call frame
+struct FunctionLayout {
+  // Slots of the parameters, in order. Methods get `this` as an implicit
+  // first parameter.
+  std::vector<Slot> params;
+  // Variables the function captures from enclosing functions
+  std::vector<Capture> captures;
+};
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_SLOT_H
@@ -0,0 +1,109 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "SourceFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace loxalone {
+
+namespace {
+
+// Size of the reads for files of unknown size, like pipes
+constexpr size_t READ_SIZE = 64 * 1024;
+
+// Reads everything left in the file. A regular file is read with a single
+// call, the extra byte lets the next one see the end of the file.
+auto read_all(int fd, const struct stat& info, std::string& buffer) -> bool {
+  buffer.resize(S_ISREG(info.st_mode) ? static_cast<size_t>(info.st_size) + 1
+                                      : READ_SIZE);
+  size_t size = 0;
+  while (true) {
+    if (size == buffer.size()) buffer.resize(buffer.size() * 2);
+
+    ssize_t count = read(fd, buffer.data() + size, buffer.size() - size);
+    if (count == 0) break;
+    if (count == -1) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    size += static_cast<size_t>(count);
+  }
+  buffer.resize(size);
+  return true;
+}
+
+}  // namespace
+
+SourceFile::SourceFile(SourceFile&& other) noexcept { *this = std::move(other); }
+
+auto SourceFile::operator=(SourceFile&& other) noexcept -> SourceFile& {
+  if (this == &other) return *this;
+
+  release();
+  mapped_m = std::exchange(other.mapped_m, false);
+  size_m = std::exchange(other.size_m, 0);
+  data_m = std::exchange(other.data_m, nullptr);
+  buffer_m = std::move(other.buffer_m);
+  // A short buffer is stored inside of the string, so it moved with it
+  if (!mapped_m) data_m = buffer_m.data();
+  return *this;
+}
+
+SourceFile::~SourceFile() { release(); }
+
+auto SourceFile::release() -> void {
+  if (mapped_m) munmap(const_cast<char*>(data_m), size_m);
+  mapped_m = false;
+}
+
+auto SourceFile::load(const std::string& path, std::string& error)
+    -> std::optional<SourceFile> {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    error = std::strerror(errno);
+    return std::nullopt;
+  }
+
+  struct stat info {};
+  if (fstat(fd, &info) == -1 || S_ISDIR(info.st_mode)) {
+    error = std::strerror(S_ISDIR(info.st_mode) ? EISDIR : errno);
+    close(fd);
+    return std::nullopt;
+  }
+
+  SourceFile file{};
+  // Empty files can't be mapped, they are "read" instead
+  if (S_ISREG(info.st_mode) && info.st_size > 0) {
+    auto size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      // The scanner goes through the text once, front to back
+      madvise(data, size, MADV_SEQUENTIAL);
+      file.data_m = static_cast<const char*>(data);
+      file.size_m = size;
+      file.mapped_m = true;
+      close(fd);
+      return file;
+    }
+  }
+
+  bool ok = read_all(fd, info, file.buffer_m);
+  if (!ok) error = std::strerror(errno);
+  close(fd);
+  if (!ok) return std::nullopt;
+
+  file.data_m = file.buffer_m.data();
+  file.size_m = file.buffer_m.size();
+  return file;
+}
+
+}  // namespace loxalone
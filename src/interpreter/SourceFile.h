@@ -0,0 +1,56 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_SOURCEFILE_H
+#define LOXALONE_SOURCEFILE_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace loxalone {
+
+/*
+ * SourceFile is the text of a script loaded from disk. Regular files are
+ * mapped into memory, so loading one copies nothing and the pages are only
+ * read as the scanner reaches them. Anything that can't be mapped, like a
+ * pipe, is read into a buffer instead.
+ *
+ * The text is neither copied nor terminated, the scanner works on it in
+ * place. A mapped file changed by another process while it's loaded can
+ * change the text too.
+ * */
+class SourceFile {
+ public:
+  SourceFile(const SourceFile&) = delete;
+  auto operator=(const SourceFile&) -> SourceFile& = delete;
+  SourceFile(SourceFile&& other) noexcept;
+  auto operator=(SourceFile&& other) noexcept -> SourceFile&;
+  ~SourceFile();
+
+  // Loads the file at `path`. Returns nullopt if it doesn't exist or can't
+  // be read, with the reason in `error`.
+  static auto load(const std::string& path, std::string& error)
+      -> std::optional<SourceFile>;
+
+  auto text() const -> std::string_view { return {data_m, size_m}; }
+
+  // Whether the text is mapped rather than read into a buffer
+  auto mapped() const -> bool { return mapped_m; }
+
+ private:
+  SourceFile() = default;
+
+  auto release() -> void;
+
+  const char* data_m = nullptr;
+  size_t size_m = 0;
+  bool mapped_m = false;
+  std::string buffer_m{};
+};
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_SOURCEFILE_H
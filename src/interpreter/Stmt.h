@@ -1,48 +1,55 @@
 #ifndef LOXALONE_Stmt_H
 #define LOXALONE_Stmt_H
 
-#include <memory>
 #include <vector>
 #include <string>
 #include <variant>
 
+#include "Arena.h"
 #include "Token.h"
 
 #include "Expr.h"
+#include "Memo.h"
 
 namespace loxalone {
 
+class Module;
+
 class Block;
 class Expression;
 class Function;
 class Class;
 class If;
 class While;
+class ForIn;
 class Print;
 class Return;
 class Var;
-
-using BlockPtr = std::unique_ptr<Block>;
-using ExpressionPtr = std::unique_ptr<Expression>;
-using FunctionPtr = std::unique_ptr<Function>;
-using ClassPtr = std::unique_ptr<Class>;
-using IfPtr = std::unique_ptr<If>;
-using WhilePtr = std::unique_ptr<While>;
-using PrintPtr = std::unique_ptr<Print>;
-using ReturnPtr = std::unique_ptr<Return>;
-using VarPtr = std::unique_ptr<Var>;
-
-using Stmt = std::variant<BlockPtr,ExpressionPtr,FunctionPtr,ClassPtr,IfPtr,WhilePtr,PrintPtr,ReturnPtr,VarPtr>;
+class Import;
+
+using BlockPtr = Block*;
+using ExpressionPtr = Expression*;
+using FunctionPtr = Function*;
+using ClassPtr = Class*;
+using IfPtr = If*;
+using WhilePtr = While*;
+using ForInPtr = ForIn*;
+using PrintPtr = Print*;
+using ReturnPtr = Return*;
+using VarPtr = Var*;
+using ImportPtr = Import*;
+
+using Stmt = std::variant<BlockPtr,ExpressionPtr,FunctionPtr,ClassPtr,IfPtr,WhilePtr,ForInPtr,PrintPtr,ReturnPtr,VarPtr,ImportPtr>;
 
 static auto stmt_is_null(const Stmt& stmt) {
   return visit([](auto&& arg) -> bool { return arg == nullptr; }, stmt);
 }
 
 template <typename T>
-concept IsStmt = std::same_as<T, BlockPtr> || std::same_as<T, ExpressionPtr> || std::same_as<T, FunctionPtr> || std::same_as<T, ClassPtr> || std::same_as<T, IfPtr> || std::same_as<T, WhilePtr> || std::same_as<T, PrintPtr> || std::same_as<T, ReturnPtr> || std::same_as<T, VarPtr>;
+concept IsStmt = std::same_as<T, BlockPtr> || std::same_as<T, ExpressionPtr> || std::same_as<T, FunctionPtr> || std::same_as<T, ClassPtr> || std::same_as<T, IfPtr> || std::same_as<T, WhilePtr> || std::same_as<T, ForInPtr> || std::same_as<T, PrintPtr> || std::same_as<T, ReturnPtr> || std::same_as<T, VarPtr> || std::same_as<T, ImportPtr>;
 
 template <typename V, typename Out>
-concept StmtVisitor = requires (V v, const BlockPtr& arg_0, const ExpressionPtr& arg_1, const FunctionPtr& arg_2, const ClassPtr& arg_3, const IfPtr& arg_4, const WhilePtr& arg_5, const PrintPtr& arg_6, const ReturnPtr& arg_7, const VarPtr& arg_8) { 
+concept StmtVisitor = requires (V v, const BlockPtr& arg_0, const ExpressionPtr& arg_1, const FunctionPtr& arg_2, const ClassPtr& arg_3, const IfPtr& arg_4, const WhilePtr& arg_5, const ForInPtr& arg_6, const PrintPtr& arg_7, const ReturnPtr& arg_8, const VarPtr& arg_9, const ImportPtr& arg_10) { 
   { v(arg_0) } -> std::convertible_to<Out>;
   { v(arg_1) } -> std::convertible_to<Out>;
   { v(arg_2) } -> std::convertible_to<Out>;
@@ -52,21 +59,23 @@ concept StmtVisitor = requires (V v, const BlockPtr& arg_0, const ExpressionPtr&
   { v(arg_6) } -> std::convertible_to<Out>;
   { v(arg_7) } -> std::convertible_to<Out>;
   { v(arg_8) } -> std::convertible_to<Out>;
+  { v(arg_9) } -> std::convertible_to<Out>;
+  { v(arg_10) } -> std::convertible_to<Out>;
 };
 
 class Block {
  public:
-  const std::vector<Stmt> statements_m;
+  const List<Stmt> statements_m;
 
-  explicit Block(std::vector<Stmt>&& statements): statements_m{std::move(statements)} {}
+  explicit Block(List<Stmt>&& statements): statements_m{std::move(statements)} {}
   ~Block() = default;
 
-  static auto create(std::vector<Stmt>&& statements) -> BlockPtr {
-    return std::make_unique<Block>(std::move(statements));
+  static auto create(Arena& arena, std::vector<Stmt>&& statements) -> BlockPtr {
+    return arena.make<Block>(arena.list(std::move(statements)));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<Block>(nullptr);
+    return static_cast<BlockPtr>(nullptr);
   }
 
 };
@@ -78,12 +87,12 @@ class Expression {
   explicit Expression(Expr&& expression): expression_m{std::move(expression)} {}
   ~Expression() = default;
 
-  static auto create(Expr&& expression) -> ExpressionPtr {
-    return std::make_unique<Expression>(std::move(expression));
+  static auto create(Arena& arena, Expr&& expression) -> ExpressionPtr {
+    return arena.make<Expression>(std::move(expression));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<Expression>(nullptr);
+    return static_cast<ExpressionPtr>(nullptr);
   }
 
 };
@@ -91,18 +100,21 @@ class Expression {
 class Function {
  public:
   const Token name_m;
-  const std::vector<Token> params_m;
-  const std::vector<Stmt> body_m;
+  const List<Token> params_m;
+  const List<Stmt> body_m;
+  Slot slot_m{};
+  FunctionLayout layout_m{};
+  MemoTable* memo_m{};
 
-  Function(Token&& name, std::vector<Token>&& params, std::vector<Stmt>&& body): name_m{std::move(name)}, params_m{std::move(params)}, body_m{std::move(body)} {}
+  Function(Token&& name, List<Token>&& params, List<Stmt>&& body): name_m{std::move(name)}, params_m{std::move(params)}, body_m{std::move(body)} {}
   ~Function() = default;
 
-  static auto create(Token&& name, std::vector<Token>&& params, std::vector<Stmt>&& body) -> FunctionPtr {
-    return std::make_unique<Function>(std::move(name), std::move(params), std::move(body));
+  static auto create(Arena& arena, Token&& name, std::vector<Token>&& params, std::vector<Stmt>&& body) -> FunctionPtr {
+    return arena.make<Function>(std::move(name), arena.list(std::move(params)), arena.list(std::move(body)));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<Function>(nullptr);
+    return static_cast<FunctionPtr>(nullptr);
   }
 
 };
@@ -110,17 +122,20 @@ class Function {
 class Class {
  public:
   const Token name_m;
-  const std::vector<FunctionPtr> methods_m;
+  const Expr superclass_m;
+  const List<FunctionPtr> methods_m;
+  Slot slot_m{};
+  Slot super_slot_m{};
 
-  Class(Token&& name, std::vector<FunctionPtr>&& methods): name_m{std::move(name)}, methods_m{std::move(methods)} {}
+  Class(Token&& name, Expr&& superclass, List<FunctionPtr>&& methods): name_m{std::move(name)}, superclass_m{std::move(superclass)}, methods_m{std::move(methods)} {}
   ~Class() = default;
 
-  static auto create(Token&& name, std::vector<FunctionPtr>&& methods) -> ClassPtr {
-    return std::make_unique<Class>(std::move(name), std::move(methods));
+  static auto create(Arena& arena, Token&& name, Expr&& superclass, std::vector<FunctionPtr>&& methods) -> ClassPtr {
+    return arena.make<Class>(std::move(name), std::move(superclass), arena.list(std::move(methods)));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<Class>(nullptr);
+    return static_cast<ClassPtr>(nullptr);
   }
 
 };
@@ -135,12 +150,12 @@ class If {
   If(Expr&& expression, Token&& token, Stmt&& then_branch, Stmt&& else_branch): expression_m{std::move(expression)}, token_m{std::move(token)}, then_branch_m{std::move(then_branch)}, else_branch_m{std::move(else_branch)} {}
   ~If() = default;
 
-  static auto create(Expr&& expression, Token&& token, Stmt&& then_branch, Stmt&& else_branch) -> IfPtr {
-    return std::make_unique<If>(std::move(expression), std::move(token), std::move(then_branch), std::move(else_branch));
+  static auto create(Arena& arena, Expr&& expression, Token&& token, Stmt&& then_branch, Stmt&& else_branch) -> IfPtr {
+    return arena.make<If>(std::move(expression), std::move(token), std::move(then_branch), std::move(else_branch));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<If>(nullptr);
+    return static_cast<IfPtr>(nullptr);
   }
 
 };
@@ -154,12 +169,33 @@ class While {
   While(Expr&& condition, Stmt&& body, Token&& token): condition_m{std::move(condition)}, body_m{std::move(body)}, token_m{std::move(token)} {}
   ~While() = default;
 
-  static auto create(Expr&& condition, Stmt&& body, Token&& token) -> WhilePtr {
-    return std::make_unique<While>(std::move(condition), std::move(body), std::move(token));
+  static auto create(Arena& arena, Expr&& condition, Stmt&& body, Token&& token) -> WhilePtr {
+    return arena.make<While>(std::move(condition), std::move(body), std::move(token));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<While>(nullptr);
+    return static_cast<WhilePtr>(nullptr);
+  }
+
+};
+
+class ForIn {
+ public:
+  const Token name_m;
+  const Expr iterable_m;
+  const Stmt body_m;
+  const Token token_m;
+  Slot slot_m{};
+
+  ForIn(Token&& name, Expr&& iterable, Stmt&& body, Token&& token): name_m{std::move(name)}, iterable_m{std::move(iterable)}, body_m{std::move(body)}, token_m{std::move(token)} {}
+  ~ForIn() = default;
+
+  static auto create(Arena& arena, Token&& name, Expr&& iterable, Stmt&& body, Token&& token) -> ForInPtr {
+    return arena.make<ForIn>(std::move(name), std::move(iterable), std::move(body), std::move(token));
+  }
+
+  static auto empty() -> Stmt {
+    return static_cast<ForInPtr>(nullptr);
   }
 
 };
@@ -171,12 +207,12 @@ class Print {
   explicit Print(Expr&& expression): expression_m{std::move(expression)} {}
   ~Print() = default;
 
-  static auto create(Expr&& expression) -> PrintPtr {
-    return std::make_unique<Print>(std::move(expression));
+  static auto create(Arena& arena, Expr&& expression) -> PrintPtr {
+    return arena.make<Print>(std::move(expression));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<Print>(nullptr);
+    return static_cast<PrintPtr>(nullptr);
   }
 
 };
@@ -189,12 +225,12 @@ class Return {
   Return(Token&& keyword, Expr&& value): keyword_m{std::move(keyword)}, value_m{std::move(value)} {}
   ~Return() = default;
 
-  static auto create(Token&& keyword, Expr&& value) -> ReturnPtr {
-    return std::make_unique<Return>(std::move(keyword), std::move(value));
+  static auto create(Arena& arena, Token&& keyword, Expr&& value) -> ReturnPtr {
+    return arena.make<Return>(std::move(keyword), std::move(value));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<Return>(nullptr);
+    return static_cast<ReturnPtr>(nullptr);
   }
 
 };
@@ -203,16 +239,36 @@ class Var {
  public:
   const Token name_m;
   const Expr initializer_m;
+  Slot slot_m{};
 
   Var(Token&& name, Expr&& initializer): name_m{std::move(name)}, initializer_m{std::move(initializer)} {}
   ~Var() = default;
 
-  static auto create(Token&& name, Expr&& initializer) -> VarPtr {
-    return std::make_unique<Var>(std::move(name), std::move(initializer));
+  static auto create(Arena& arena, Token&& name, Expr&& initializer) -> VarPtr {
+    return arena.make<Var>(std::move(name), std::move(initializer));
+  }
+
+  static auto empty() -> Stmt {
+    return static_cast<VarPtr>(nullptr);
+  }
+
+};
+
+class Import {
+ public:
+  const Token keyword_m;
+  const Token path_m;
+  Module* module_m{};
+
+  Import(Token&& keyword, Token&& path): keyword_m{std::move(keyword)}, path_m{std::move(path)} {}
+  ~Import() = default;
+
+  static auto create(Arena& arena, Token&& keyword, Token&& path) -> ImportPtr {
+    return arena.make<Import>(std::move(keyword), std::move(path));
   }
 
   static auto empty() -> Stmt {
-    return std::unique_ptr<Var>(nullptr);
+    return static_cast<ImportPtr>(nullptr);
   }
 
 };
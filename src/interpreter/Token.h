@@ -7,26 +7,20 @@
 
 #include <fmt/format.h>
 
-#include <optional>
-#include <string>
-#include <variant>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
 
 namespace loxalone {
 
-class LoxCallable;
-using LoxCallablePtr = std::shared_ptr<LoxCallable>;
-
-class LoxInstance;
-using LoxInstancePtr = std::shared_ptr<LoxInstance>;
-
-using lox_literal = std::variant<std::string, double, bool, LoxCallablePtr,
-                                 LoxInstancePtr, std::monostate>;
-
-enum class TokenType {
+enum class TokenType : uint8_t {
   LEFT_PAREN,
   RIGHT_PAREN,
   LEFT_BRACE,
   RIGHT_BRACE,
+  LEFT_BRACKET,
+  RIGHT_BRACKET,
+  COLON,
   COMMA,
   DOT,
   MINUS,
@@ -55,6 +49,8 @@ enum class TokenType {
   FUN,
   FOR,
   IF,
+  IMPORT,
+  IN,
   NIL,
   OR,
   PRINT,
@@ -78,6 +74,12 @@ constexpr const char* tt_to_string(TokenType type) {
       return "LEFT_BRACE";
     case TokenType::RIGHT_BRACE:
       return "RIGHT_BRACE";
+    case TokenType::LEFT_BRACKET:
+      return "LEFT_BRACKET";
+    case TokenType::RIGHT_BRACKET:
+      return "RIGHT_BRACKET";
+    case TokenType::COLON:
+      return "COLON";
     case TokenType::COMMA:
       return "COMMA";
     case TokenType::DOT:
@@ -131,6 +133,10 @@ constexpr const char* tt_to_string(TokenType type) {
       return "FOR";
     case TokenType::IF:
       return "IF";
+    case TokenType::IMPORT:
+      return "IMPORT";
+    case TokenType::IN:
+      return "IN";
     case TokenType::NIL:
       return "NIL";
     case TokenType::OR:
@@ -155,16 +161,26 @@ constexpr const char* tt_to_string(TokenType type) {
   }
 }
 
+/*
+ * Token is a small record that is cheap to copy, the syntax tree keeps tokens
+ * by value. The lexeme is a view on the source, which must outlive the tokens
+ * and the syntax tree (see `Arena::keep`). The parser turns the lexemes of
+ * string and number literals into their values.
+ * */
 struct Token {
-  const TokenType type;
-  const std::string lexeme;
-  const std::optional<lox_literal> literal;
-  const int line;
-
-  Token(TokenType type, std::string&& lexeme,
-        std::optional<lox_literal>&& literal, int line)
-      : type{type}, lexeme{lexeme}, literal{literal}, line{line} {}
+  // An EOF_ token, for buffers of tokens to start with
+  Token() : Token{TokenType::EOF_, "", 0} {}
+  Token(TokenType type, std::string_view lexeme, int line)
+      : type{type}, line{line}, lexeme{lexeme} {}
+
+  TokenType type;
+  int line;
+  std::string_view lexeme;
 };
+
+static_assert(std::is_trivially_copyable_v<Token>);
+static_assert(sizeof(Token) <= 24);
+
 }  // namespace loxalone
 
 template <>
@@ -180,14 +196,10 @@ struct fmt::formatter<loxalone::Token> {
     // For some reason I can't use overload visit pattern with `ctx.out` here
     switch (token.type) {
       case loxalone::TokenType::IDENTIFIER:
-        return fmt::format_to(ctx.out(), "({} '{}')", tt_to_string(token.type),
-                              token.lexeme);
       case loxalone::TokenType::STRING:
-        return fmt::format_to(ctx.out(), "({} '{}')", tt_to_string(token.type),
-                              std::get<std::string>(token.literal.value()));
       case loxalone::TokenType::NUMBER:
         return fmt::format_to(ctx.out(), "({} '{}')", tt_to_string(token.type),
-                              std::get<double>(token.literal.value()));
+                              token.lexeme);
       default:
         return fmt::format_to(ctx.out(), "({})", tt_to_string(token.type));
     }
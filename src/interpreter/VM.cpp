@@ -0,0 +1,751 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "VM.h"
+
+#include <algorithm>
+
+#include "Collections.h"
+#include "Compiler.h"
+#include "Error.h"
+#include "LiteralFormatter.h"
+#include "LoxClass.h"
+#include "LoxInstance.h"
+#include "Module.h"
+
+namespace loxalone {
+
+static constexpr size_t STACK_MAX = 1 << 17;
+// A call needs room for at least as many values as a function can have locals
+static constexpr size_t FRAME_HEADROOM = 256;
+
+auto VmClosure::arity() const -> int { return function->arity; }
+
+auto VmClosure::execute(Interpreter&, Args args) -> Value {
+  return vm.call_back(*this, args);
+}
+
+auto VmClosure::name() const -> std::string_view { return function->name; }
+
+VM::VM(size_t max_call_depth)
+    : stack(STACK_MAX),
+      frames{},
+      // Every frame takes at least a stack slot, so there can't be more
+      // frames than slots anyway
+      max_call_depth{std::min(max_call_depth, STACK_MAX)},
+      globals{},
+      global_indices{} {
+  stack_top = stack.data();
+  // The running frame is referred to by pointer, so the frames must never be
+  // reallocated. The script has a frame on top of the calls.
+  frames.reserve(this->max_call_depth + 1);
+
+  for (auto& global : standard_globals()) {
+    define_global(global.name, std::move(global.value));
+  }
+}
+
+auto VM::interpret(List<Stmt> stmts) -> bool {
+  Compiler compiler{*this};
+  return execute(compiler.compile(stmts));
+}
+
+auto VM::compile_module(const Module& module)
+    -> std::shared_ptr<const VmFunction> {
+  auto& function = modules[&module];
+  if (function == nullptr) {
+    Compiler compiler{*this, &module};
+    function = compiler.compile(module.statements);
+  }
+  return function;
+}
+
+auto VM::execute(std::shared_ptr<const VmFunction> function) -> bool {
+  try {
+    auto closure = make_ref<VmClosure>(*this, std::move(function));
+    *stack_top++ = closure;
+    call_value(stack_top[-1], 0, 0);
+    run(0);
+    pop_to(stack_top - 1);
+    return true;
+  } catch (const RuntimeError& err) {
+    // The frames are still there, the last one is where the error was raised
+    const Module* at =
+        frames.empty() ? nullptr : frames.back().closure->function->module;
+    report_error(err, at != nullptr ? display(at->path) : "");
+    // The closures that escaped keep the values they captured
+    close_upvalues(stack.data());
+    pop_to(stack.data());
+    frames.clear();
+    return false;
+  }
+}
+
+auto VM::call_back(LoxCallable& callee, Args args) -> Value {
+  // Errors are reported at the call of the native
+  if (args.size() != callee.arity())
+    throw NativeError{fmt::format("Expected {} arguments but got {}.",
+                                  callee.arity(), args.size())};
+  // The frame of the script isn't a call
+  if (frames.size() - 1 == max_call_depth ||
+      stack_top + args.size() + FRAME_HEADROOM > stack.data() + stack.size())
+    throw NativeError{"Stack overflow."};
+
+  size_t depth = frames.size();
+  *stack_top++ = Value{&callee};
+  for (const auto& arg : args) *stack_top++ = arg;
+
+  call_value(stack_top[-1 - static_cast<int>(args.size())],
+             static_cast<int>(args.size()), 0);
+  // A memoized result is already on the stack, there is no frame to run
+  if (frames.size() > depth) run(depth);
+  return std::move(*--stack_top);
+}
+
+auto VM::global_index(std::string_view name) -> int {
+  auto find = global_indices.find(std::string{name});
+  if (find != global_indices.end()) return find->second;
+
+  int index = static_cast<int>(globals.size());
+  globals.emplace_back(Global{std::string{name}, Value{}, false});
+  global_indices.emplace(name, index);
+  return index;
+}
+
+auto VM::run(size_t exit_depth) -> void {
+  CallFrame* frame = &frames.back();
+  const uint8_t* ip = frame->ip;
+
+  auto read_byte = [&]() -> uint8_t { return *ip++; };
+  auto read_short = [&]() -> uint16_t {
+    ip += 2;
+    return static_cast<uint16_t>((ip[-2] << 8) | ip[-1]);
+  };
+  auto pop = [&]() -> Value { return std::move(*--stack_top); };
+  auto push = [&](Value value) { *stack_top++ = std::move(value); };
+
+  // Runtime errors are reported with the line of the current instruction
+  auto error = [&](std::string_view msg) {
+    const Chunk& chunk = frame->closure->function->chunk;
+    int line = chunk.lines[ip - chunk.code.data() - 1];
+    throw RuntimeError{Token{TokenType::EOF_, "", line}, msg};
+  };
+  auto check_are_numbers = [&]() {
+    if (!stack_top[-1].is_number() ||
+        !stack_top[-2].is_number())
+      error("Operands must be numbers.");
+  };
+
+  // Replaces the current frame with the callee and the arguments on top of
+  // the stack, for a call in tail position
+  auto reuse_frame = [&](int argc) {
+    close_upvalues(frame->slots);
+    Value* slots = frame->slots;
+    std::move(stack_top - argc - 1, stack_top, slots);
+    pop_to(slots + argc + 1);
+    frames.pop_back();
+  };
+  auto is_closure = [](const Value& value) {
+    return value.is_callable() &&
+           dynamic_cast<VmClosure*>(value.as<LoxCallable>()) != nullptr;
+  };
+
+  // Pops the right operand and replaces the left one with the result
+  auto binary = [&](auto op) {
+    check_are_numbers();
+    double right = stack_top[-1].as_number();
+    double left = stack_top[-2].as_number();
+    pop_to(stack_top - 1);
+    stack_top[-1] = op(left, right);
+  };
+
+  while (true) {
+    switch (static_cast<OpCode>(read_byte())) {
+      case OpCode::CONSTANT:
+        push(frame->closure->function->chunk.constants[read_short()]);
+        break;
+      case OpCode::NIL:
+        push(Value{});
+        break;
+      case OpCode::TRUE:
+        push(true);
+        break;
+      case OpCode::FALSE:
+        push(false);
+        break;
+      case OpCode::POP:
+        pop_to(stack_top - 1);
+        break;
+      case OpCode::GET_LOCAL:
+        push(frame->slots[read_byte()]);
+        break;
+      case OpCode::SET_LOCAL:
+        frame->slots[read_byte()] = stack_top[-1];
+        break;
+      case OpCode::GET_GLOBAL: {
+        Global& global = globals[read_short()];
+        if (!global.defined)
+          error(fmt::format("Undefined variable '{}'.", global.name));
+        push(global.value);
+        break;
+      }
+      case OpCode::DEFINE_GLOBAL: {
+        Global& global = globals[read_short()];
+        global.value = pop();
+        global.defined = true;
+        break;
+      }
+      case OpCode::SET_GLOBAL: {
+        Global& global = globals[read_short()];
+        if (!global.defined)
+          error(fmt::format("Undefined variable '{}'.", global.name));
+        global.value = stack_top[-1];
+        break;
+      }
+      case OpCode::GET_UPVALUE:
+        push(*frame->closure->upvalues[read_byte()]->location);
+        break;
+      case OpCode::SET_UPVALUE:
+        *frame->closure->upvalues[read_byte()]->location = stack_top[-1];
+        break;
+      case OpCode::EQUAL: {
+        bool equal = stack_top[-2] == stack_top[-1];
+        pop_to(stack_top - 1);
+        stack_top[-1] = equal;
+        break;
+      }
+      case OpCode::NOT_EQUAL: {
+        bool equal = stack_top[-2] == stack_top[-1];
+        pop_to(stack_top - 1);
+        stack_top[-1] = !equal;
+        break;
+      }
+      case OpCode::GREATER:
+        binary([](double a, double b) { return a > b; });
+        break;
+      case OpCode::GREATER_EQUAL:
+        binary([](double a, double b) { return a >= b; });
+        break;
+      case OpCode::LESS:
+        binary([](double a, double b) { return a < b; });
+        break;
+      case OpCode::LESS_EQUAL:
+        binary([](double a, double b) { return a <= b; });
+        break;
+      case OpCode::ADD: {
+        Value& left = stack_top[-2];
+        Value& right = stack_top[-1];
+        if (left.is_number() && right.is_number()) {
+          left = left.as_number() + right.as_number();
+        } else if (left.is_string() && right.is_string()) {
+          left = concatenate(left, right);
+        } else {
+          error("Operands must be either strings or numbers.");
+        }
+        pop_to(stack_top - 1);
+        break;
+      }
+      case OpCode::SUBTRACT:
+        binary([](double a, double b) { return a - b; });
+        break;
+      case OpCode::MULTIPLY:
+        binary([](double a, double b) { return a * b; });
+        break;
+      case OpCode::DIVIDE:
+        binary([](double a, double b) { return a / b; });
+        break;
+      case OpCode::NOT:
+        if (!stack_top[-1].is_bool())
+          error("Operand must be a boolean.");
+        stack_top[-1] = !stack_top[-1].as_bool();
+        break;
+      case OpCode::NEGATE:
+        if (!stack_top[-1].is_number())
+          error("Operand must be a number.");
+        stack_top[-1] = -stack_top[-1].as_number();
+        break;
+      case OpCode::PRINT:
+        fmt::print("{}", pop());
+        break;
+      case OpCode::JUMP: {
+        uint16_t offset = read_short();
+        ip += offset;
+        break;
+      }
+      case OpCode::JUMP_IF_FALSE: {
+        auto condition = static_cast<Condition>(read_byte());
+        uint16_t offset = read_short();
+        Value value = pop();
+        if (!value.is_bool())
+          error(condition == Condition::IF
+                    ? "If condition must be a boolean expression."
+                    : "While condition must be a boolean expression.");
+        if (!value.as_bool()) ip += offset;
+        break;
+      }
+      case OpCode::AND: {
+        uint16_t offset = read_short();
+        if (!stack_top[-1].is_bool())
+          error("Operand must be a boolean.");
+        if (!stack_top[-1].as_bool())
+          ip += offset;
+        else
+          pop_to(stack_top - 1);
+        break;
+      }
+      case OpCode::OR: {
+        uint16_t offset = read_short();
+        if (!stack_top[-1].is_bool())
+          error("Operand must be a boolean.");
+        if (stack_top[-1].as_bool())
+          ip += offset;
+        else
+          pop_to(stack_top - 1);
+        break;
+      }
+      case OpCode::LOOP: {
+        uint16_t offset = read_short();
+        ip -= offset;
+        break;
+      }
+      case OpCode::CALL: {
+        int argc = read_byte();
+        frame->ip = ip;
+        const Chunk& chunk = frame->closure->function->chunk;
+        call_value(stack_top[-1 - argc], argc,
+                   chunk.lines[ip - chunk.code.data() - 1]);
+        frame = &frames.back();
+        ip = frame->ip;
+        break;
+      }
+      case OpCode::TAIL_CALL: {
+        int argc = read_byte();
+        frame->ip = ip;
+        const Chunk& chunk = frame->closure->function->chunk;
+        int line = chunk.lines[ip - chunk.code.data() - 1];
+
+        // Anything other than a closure is called as usual, the RETURN
+        // following this instruction returns its result
+        Value& callee = stack_top[-1 - argc];
+        if (is_closure(callee)) {
+          auto* closure = callee.as<VmClosure>();
+          MemoTable::Ticket memo = frame->memo;
+          reuse_frame(argc);
+          call_closure(*closure, argc, line, &memo);
+        } else {
+          call_value(callee, argc, line);
+        }
+        frame = &frames.back();
+        ip = frame->ip;
+        break;
+      }
+      case OpCode::CLOSURE: {
+        const auto& function =
+            frame->closure->function->chunk.functions[read_short()];
+        auto closure = make_ref<VmClosure>(*this, function);
+        closure->upvalues.reserve(function->upvalue_count);
+        for (int i = 0; i < function->upvalue_count; i++) {
+          auto from = static_cast<UpvalueFrom>(read_byte());
+          uint8_t index = read_byte();
+          if (from == UpvalueFrom::LOCAL) {
+            closure->upvalues.emplace_back(
+                capture_upvalue(frame->slots + index));
+          } else if (from == UpvalueFrom::ENCLOSING) {
+            closure->upvalues.emplace_back(frame->closure->upvalues[index]);
+          } else {
+            closure->upvalues.emplace_back(nullptr);
+          }
+        }
+        push(std::move(closure));
+        break;
+      }
+      case OpCode::IMPORT: {
+        const auto& function =
+            frame->closure->function->chunk.functions[read_short()];
+        if (!imported.insert(function.get()).second) {
+          push(Value{});
+          break;
+        }
+
+        // The module runs like a call of its script, its result is popped
+        push(make_ref<VmClosure>(*this, function));
+        frame->ip = ip;
+        const Chunk& chunk = frame->closure->function->chunk;
+        call_value(stack_top[-1], 0, chunk.lines[ip - chunk.code.data() - 1]);
+        frame = &frames.back();
+        ip = frame->ip;
+        break;
+      }
+      case OpCode::CLOSE_UPVALUE:
+        close_upvalues(stack_top - 1);
+        pop_to(stack_top - 1);
+        break;
+      case OpCode::RETURN: {
+        Value result = pop();
+        MemoTable::store(frame->memo, result);
+        close_upvalues(frame->slots);
+        pop_to(frame->slots);
+        frames.pop_back();
+        push(std::move(result));
+
+        if (frames.size() == exit_depth) return;
+        frame = &frames.back();
+        ip = frame->ip;
+        break;
+      }
+      case OpCode::CLASS: {
+        const auto& name =
+            frame->closure->function->chunk.constants[read_short()];
+        push(make_ref<LoxClass>(name.as_string()));
+        break;
+      }
+      case OpCode::GET_PROPERTY: {
+        const Chunk& chunk = frame->closure->function->chunk;
+        const auto& name = chunk.constants[read_short()];
+        uint16_t cache_index = read_short();
+        PropertyCache& cache = chunk.caches[cache_index];
+        if (!stack_top[-1].is_instance())
+          error("Only instances have properties.");
+
+        auto* instance = stack_top[-1].as<LoxInstance>();
+        if (int index = instance->find(cache, name.as_string()); index != -1) {
+          // Copied first, the instance may only be kept alive by the stack
+          Value value = instance->fields[index];
+          stack_top[-1] = std::move(value);
+          break;
+        }
+
+        auto* method = instance->cls->find_method(
+            chunk.method_caches[cache_index], name.as_string());
+        if (method == nullptr)
+          error(fmt::format("Undefined property '{}'.", name.as_string()));
+        stack_top[-1] = make_ref<LoxBoundMethod>(stack_top[-1],
+                                                 Ref<LoxCallable>{method});
+        break;
+      }
+      case OpCode::SET_PROPERTY: {
+        const Chunk& chunk = frame->closure->function->chunk;
+        const auto& name = chunk.constants[read_short()];
+        PropertyCache& cache = chunk.caches[read_short()];
+        if (!stack_top[-2].is_instance())
+          error("Only instances have fields.");
+
+        stack_top[-2].as<LoxInstance>()->set(cache, name.as_string(),
+                                             stack_top[-1]);
+        Value value = pop();
+        stack_top[-1] = std::move(value);
+        break;
+      }
+      case OpCode::GET_INDEX: {
+        Value element{};
+        try {
+          element = get_element(stack_top[-2], stack_top[-1]);
+        } catch (const NativeError& err) {
+          error(err.msg);
+        }
+        pop();
+        stack_top[-1] = std::move(element);
+        break;
+      }
+      case OpCode::SET_INDEX: {
+        try {
+          set_element(stack_top[-3], stack_top[-2], stack_top[-1]);
+        } catch (const NativeError& err) {
+          error(err.msg);
+        }
+        Value value = pop();
+        pop();
+        stack_top[-1] = std::move(value);
+        break;
+      }
+      case OpCode::BUILD_LIST: {
+        int count = read_short();
+        auto list = make_ref<ListObj>(
+            std::vector<Value>{std::make_move_iterator(stack_top - count),
+                               std::make_move_iterator(stack_top)});
+        pop_to(stack_top - count);
+        push(std::move(list));
+        break;
+      }
+      case OpCode::BUILD_MAP: {
+        int count = read_short();
+        Value* entries = stack_top - 2 * count;
+        auto map = make_ref<MapObj>();
+        for (int i = 0; i < count; i++) {
+          if (!entries[2 * i].is_string()) error("Map keys must be strings.");
+          map->set(entries[2 * i], std::move(entries[2 * i + 1]));
+        }
+        pop_to(entries);
+        push(std::move(map));
+        break;
+      }
+      case OpCode::ITERATE: {
+        uint32_t version = 0;
+        try {
+          version = begin_iteration(stack_top[-1]);
+        } catch (const NativeError& err) {
+          error(err.msg);
+        }
+        push(Value{0.0});
+        push(Value{static_cast<double>(version)});
+        break;
+      }
+      case OpCode::FOR_IN: {
+        // The iterable, the position and the version are hidden locals
+        Value* state = frame->slots + read_byte();
+        uint16_t offset = read_short();
+
+        auto position = static_cast<size_t>(state[1].as_number());
+        auto version = static_cast<uint32_t>(state[2].as_number());
+        Value element{};
+        bool more = false;
+        try {
+          more = next_element(state[0], position, version, element);
+        } catch (const NativeError& err) {
+          error(err.msg);
+        }
+        if (!more) {
+          ip += offset;
+          break;
+        }
+        state[1] = Value{static_cast<double>(position)};
+        push(std::move(element));
+        break;
+      }
+      case OpCode::INVOKE: {
+        const Chunk& chunk = frame->closure->function->chunk;
+        const auto& name = chunk.constants[read_short()];
+        uint16_t cache_index = read_short();
+        int argc = read_byte();
+        frame->ip = ip;
+        int line = chunk.lines[ip - chunk.code.data() - 1];
+
+        Value& receiver = stack_top[-1 - argc];
+        if (!receiver.is_instance()) error("Only instances have properties.");
+
+        // A field holding a function shadows the methods with the same name
+        auto* instance = receiver.as<LoxInstance>();
+        if (int index = instance->find(chunk.caches[cache_index],
+                                       name.as_string());
+            index != -1) {
+          Value callee = instance->fields[index];
+          receiver = callee;
+          call_value(callee, argc, line);
+        } else {
+          // The receiver is already where the method expects `this`
+          auto* method = instance->cls->find_method(
+              chunk.method_caches[cache_index], name.as_string());
+          if (method == nullptr)
+            error(fmt::format("Undefined property '{}'.", name.as_string()));
+          call_closure(*static_cast<VmClosure*>(method), argc, line);
+        }
+        frame = &frames.back();
+        ip = frame->ip;
+        break;
+      }
+      case OpCode::TAIL_INVOKE: {
+        const Chunk& chunk = frame->closure->function->chunk;
+        const auto& name = chunk.constants[read_short()];
+        uint16_t cache_index = read_short();
+        int argc = read_byte();
+        frame->ip = ip;
+        int line = chunk.lines[ip - chunk.code.data() - 1];
+
+        Value& receiver = stack_top[-1 - argc];
+        if (!receiver.is_instance()) error("Only instances have properties.");
+
+        auto* instance = receiver.as<LoxInstance>();
+        if (int index = instance->find(chunk.caches[cache_index],
+                                       name.as_string());
+            index != -1) {
+          Value callee = instance->fields[index];
+          receiver = callee;
+          if (is_closure(callee)) {
+            MemoTable::Ticket memo = frame->memo;
+            reuse_frame(argc);
+            call_closure(*callee.as<VmClosure>(), argc, line, &memo);
+          } else {
+            call_value(callee, argc, line);
+          }
+        } else {
+          auto* method = instance->cls->find_method(
+              chunk.method_caches[cache_index], name.as_string());
+          if (method == nullptr)
+            error(fmt::format("Undefined property '{}'.", name.as_string()));
+          // The receiver keeps the method alive through its class
+          reuse_frame(argc);
+          call_closure(*static_cast<VmClosure*>(method), argc, line);
+        }
+        frame = &frames.back();
+        ip = frame->ip;
+        break;
+      }
+      case OpCode::INHERIT: {
+        const Value& superclass = stack_top[-2];
+        auto* cls = superclass.is_callable()
+                        ? dynamic_cast<LoxClass*>(superclass.as<LoxCallable>())
+                        : nullptr;
+        if (cls == nullptr) error("Superclass must be a class.");
+        stack_top[-1].as<LoxClass>()->inherit(*cls);
+        pop_to(stack_top - 1);
+        break;
+      }
+      case OpCode::METHOD: {
+        const auto& name =
+            frame->closure->function->chunk.constants[read_short()];
+        stack_top[-2].as<LoxClass>()->add_method(
+            name.as_string(), Ref<LoxCallable>{stack_top[-1].as<VmClosure>()});
+        pop_to(stack_top - 1);
+        break;
+      }
+      case OpCode::GET_SUPER: {
+        const Chunk& chunk = frame->closure->function->chunk;
+        const auto& name = chunk.constants[read_short()];
+        MethodCache& cache = chunk.method_caches[read_short()];
+
+        auto* method = stack_top[-1].as<LoxClass>()->find_method(
+            cache, name.as_string());
+        if (method == nullptr)
+          error(fmt::format("Undefined property '{}'.", name.as_string()));
+        pop_to(stack_top - 1);
+        stack_top[-1] = make_ref<LoxBoundMethod>(stack_top[-1],
+                                                 Ref<LoxCallable>{method});
+        break;
+      }
+      case OpCode::SUPER_INVOKE: {
+        const Chunk& chunk = frame->closure->function->chunk;
+        const auto& name = chunk.constants[read_short()];
+        MethodCache& cache = chunk.method_caches[read_short()];
+        int argc = read_byte();
+        frame->ip = ip;
+
+        auto* method = stack_top[-1].as<LoxClass>()->find_method(
+            cache, name.as_string());
+        if (method == nullptr)
+          error(fmt::format("Undefined property '{}'.", name.as_string()));
+        // The superclass is kept alive by the `super` upvalue of the caller
+        pop_to(stack_top - 1);
+        call_closure(*static_cast<VmClosure*>(method), argc,
+                     chunk.lines[ip - chunk.code.data() - 1]);
+        frame = &frames.back();
+        ip = frame->ip;
+        break;
+      }
+    }
+  }
+}
+
+auto VM::call_value(const Value& callee, int argc, int line) -> void {
+  auto error = [&](std::string_view msg) {
+    throw RuntimeError{Token{TokenType::EOF_, "", line}, msg};
+  };
+
+  if (!callee.is_callable())
+    error("Can only call functions and classes");
+
+  auto* callable = callee.as<LoxCallable>();
+  if (argc != callable->arity())
+    error(fmt::format("Expected {} arguments but got {}.", callable->arity(),
+                      argc));
+
+  if (auto* closure = dynamic_cast<VmClosure*>(callable); closure != nullptr) {
+    call_closure(*closure, argc, line);
+    return;
+  }
+
+  // Bound methods and initializers get the instance in place of the callee,
+  // the method is kept alive by the class of the instance
+  Value& slot = stack_top[-1 - argc];
+  if (auto* bound = dynamic_cast<LoxBoundMethod*>(callable); bound != nullptr) {
+    auto* method = static_cast<VmClosure*>(bound->method.get());
+    slot = bound->receiver;
+    call_closure(*method, argc, line);
+    return;
+  }
+  if (auto* cls = dynamic_cast<LoxClass*>(callable); cls != nullptr) {
+    auto* initializer = static_cast<VmClosure*>(cls->initializer());
+    slot = make_ref<LoxInstance>(Ref<LoxClass>{cls});
+    if (initializer != nullptr) call_closure(*initializer, argc, line);
+    return;
+  }
+
+  // Natives are run by the host, the result replaces the callee
+  auto* native = dynamic_cast<NativeCallable*>(callable);
+  if (native == nullptr) error("Can only call functions and classes");
+
+  Value result{};
+  try {
+    result = native->call(*this,
+                          Args{stack_top - argc, static_cast<size_t>(argc)});
+  } catch (const NativeError& err) {
+    error(err.msg);
+  }
+  pop_to(stack_top - argc - 1);
+  *stack_top++ = std::move(result);
+}
+
+auto VM::call_closure(VmClosure& closure, int argc, int line,
+                      const MemoTable::Ticket* replaced) -> void {
+  auto error = [&](std::string_view msg) {
+    throw RuntimeError{Token{TokenType::EOF_, "", line}, msg};
+  };
+
+  if (argc != closure.arity())
+    error(fmt::format("Expected {} arguments but got {}.", closure.arity(),
+                      argc));
+  if (frames.size() - 1 == max_call_depth ||
+      stack_top + FRAME_HEADROOM > stack.data() + stack.size())
+    error("Stack overflow.");
+
+  MemoTable::Ticket ticket =
+      replaced != nullptr ? *replaced : MemoTable::Ticket{};
+  if (auto* memo = closure.function->memo;
+      memo != nullptr && replaced == nullptr) {
+    Args args{stack_top - argc, static_cast<size_t>(argc)};
+    if (const Value* hit = memo->find(args, ticket)) {
+      Value result = *hit;
+      pop_to(stack_top - argc - 1);
+      *stack_top++ = std::move(result);
+      return;
+    }
+  }
+
+  frames.emplace_back(CallFrame{&closure, closure.function->chunk.code.data(),
+                                stack_top - argc - 1, ticket});
+}
+
+auto VM::pop_to(Value* top) -> void {
+  while (stack_top != top) *--stack_top = Value{};
+}
+
+auto VM::capture_upvalue(Value* local) -> std::shared_ptr<Upvalue> {
+  auto slot = static_cast<size_t>(local - stack.data());
+
+  auto it = open_upvalues.rbegin();
+  for (; it != open_upvalues.rend() && (*it)->slot >= slot; ++it) {
+    if ((*it)->slot == slot) return *it;
+  }
+
+  auto upvalue = std::make_shared<Upvalue>(Upvalue{local, {}, slot});
+  open_upvalues.insert(it.base(), upvalue);
+  return upvalue;
+}
+
+auto VM::close_upvalues(Value* last) -> void {
+  while (!open_upvalues.empty() &&
+         open_upvalues.back()->location >= last) {
+    auto& upvalue = open_upvalues.back();
+    upvalue->closed = std::move(*upvalue->location);
+    upvalue->location = &upvalue->closed;
+    open_upvalues.pop_back();
+  }
+}
+
+auto VM::define_global(std::string_view name, Value value) -> void {
+  Global& global = globals[global_index(name)];
+  global.value = std::move(value);
+  global.defined = true;
+}
+
+}  // namespace loxalone
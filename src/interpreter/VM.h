@@ -0,0 +1,139 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_VM_H
+#define LOXALONE_VM_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Chunk.h"
+#include "LoxCallable.h"
+#include "Native.h"
+#include "Stmt.h"
+#include "Token.h"
+
+namespace loxalone {
+
+class VM;
+
+// Upvalue is a variable captured by a closure. While the variable is still on
+// the VM stack, `location` points to its stack slot. When the variable goes
+// out of scope the value is moved into `closed` and `location` points there.
+struct Upvalue {
+  Value* location;
+  Value closed;
+  size_t slot;
+};
+
+// VmClosure is the runtime function object of the VM, a compiled function
+// together with the variables it captured.
+class VmClosure : public LoxCallable {
+ public:
+  VmClosure(VM& vm, std::shared_ptr<const VmFunction> function)
+      : vm{vm}, function{std::move(function)}, upvalues{} {}
+
+  auto arity() const -> int override;
+  auto execute(Interpreter&, Args args) -> Value override;
+  auto name() const -> std::string_view override;
+
+  VM& vm;
+  const std::shared_ptr<const VmFunction> function;
+  std::vector<std::shared_ptr<Upvalue>> upvalues;
+};
+
+/*
+ * VM is the bytecode execution engine, an alternative to the tree-walking
+ * `Interpreter`. Statements are compiled into chunks by the `Compiler` and run
+ * on a value stack with one call frame per active lox function.
+ * */
+class VM : public Engine {
+ public:
+  explicit VM(size_t max_call_depth = DEFAULT_MAX_CALL_DEPTH);
+
+  // Entry point for the VM, returns true if it's successful or false if
+  // there's a runtime error. Compile errors are thrown as RuntimeError.
+  auto interpret(List<Stmt>) -> bool;
+
+  // Runs a compiled top-level script, reports runtime errors the same way as
+  // `interpret`
+  auto execute(std::shared_ptr<const VmFunction>) -> bool;
+
+  // Calls a closure, or any other callable, from the host with the given
+  // arguments
+  auto call_back(LoxCallable& callee, Args args) -> Value override;
+
+  // Defines a global native function calling the C++ function `Fn`, the
+  // arity and the argument checks come from its signature
+  template <auto Fn>
+  auto register_native(std::string_view name) -> void {
+    define_global(name, make_native<Fn>(name));
+  }
+
+  // Returns the index of the global variable with the given name, creating
+  // an undefined global if it hasn't been seen before.
+  auto global_index(std::string_view name) -> int;
+
+  // Returns the statements of the module compiled into a top-level script,
+  // the module is compiled the first time it's asked for
+  auto compile_module(const Module&) -> std::shared_ptr<const VmFunction>;
+
+ private:
+  struct CallFrame {
+    VmClosure* closure;
+    const uint8_t* ip;
+    Value* slots;
+    // Where the result goes if the function is memoized
+    MemoTable::Ticket memo;
+  };
+
+  struct Global {
+    std::string name;
+    Value value;
+    bool defined;
+  };
+
+  // Runs the dispatch loop until the frame count drops back to `exit_depth`
+  auto run(size_t exit_depth) -> void;
+
+  auto call_value(const Value& callee, int argc, int line) -> void;
+  // Pushes a frame for the closure, the slot below the arguments becomes its
+  // slot zero. A memoized function that already knows its result doesn't get
+  // a frame, the result replaces the callee and the arguments right away.
+  //
+  // A tail call passes the cache ticket of the frame it `replaced`. The
+  // callee's cache isn't looked up, its result is cached for the replaced
+  // call instead.
+  auto call_closure(VmClosure& closure, int argc, int line,
+                    const MemoTable::Ticket* replaced = nullptr) -> void;
+  // Releases the values from `top` upwards and makes it the top again
+  auto pop_to(Value* top) -> void;
+  auto capture_upvalue(Value* local) -> std::shared_ptr<Upvalue>;
+  auto close_upvalues(Value* last) -> void;
+  auto define_global(std::string_view name, Value value) -> void;
+
+  std::vector<Value> stack;
+  Value* stack_top;
+  std::vector<CallFrame> frames;
+  size_t max_call_depth;
+
+  std::vector<Global> globals;
+  std::unordered_map<std::string, int> global_indices;
+
+  // Upvalues that still point into the stack, sorted by their stack slots
+  std::vector<std::shared_ptr<Upvalue>> open_upvalues;
+
+  std::unordered_map<const Module*, std::shared_ptr<const VmFunction>>
+      modules;
+  // The modules that ran, a module only runs at the first import of it
+  std::unordered_set<const VmFunction*> imported;
+};
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_VM_H
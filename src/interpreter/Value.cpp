@@ -0,0 +1,200 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include "Value.h"
+
+#include <mutex>
+#include <vector>
+
+namespace loxalone {
+
+namespace {
+
+/*
+ * StringTable is the set of all live strings, an open addressing hash table
+ * with linear probing. It doesn't own the strings, a string removes itself
+ * from the table once the last reference to it is dropped. Removed entries
+ * are left as tombstones so that probing sequences aren't broken.
+ *
+ * Modules are parsed on several threads at once, so strings are interned and
+ * erased under `lock`. A string found in the table is retained under the
+ * lock too, before another thread can drop it.
+ * */
+class StringTable {
+ public:
+  std::mutex lock{};
+
+  auto find(std::string_view value, uint32_t hash) const -> StringObj* {
+    if (entries.empty()) return nullptr;
+
+    size_t mask = entries.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      StringObj* entry = entries[i];
+      if (entry == nullptr) return nullptr;
+      if (entry != tombstone() && entry->hash == hash && entry->value == value)
+        return entry;
+    }
+  }
+
+  auto insert(StringObj* str) -> void {
+    if ((used + 1) * 4 > entries.size() * 3) grow();
+
+    size_t mask = entries.size() - 1;
+    size_t i = str->hash & mask;
+    while (entries[i] != nullptr && entries[i] != tombstone())
+      i = (i + 1) & mask;
+    if (entries[i] == nullptr) used++;
+    entries[i] = str;
+  }
+
+  auto erase(const StringObj* str) -> void {
+    size_t mask = entries.size() - 1;
+    for (size_t i = str->hash & mask;; i = (i + 1) & mask) {
+      if (entries[i] == str) {
+        entries[i] = tombstone();
+        return;
+      }
+    }
+  }
+
+ private:
+  static auto tombstone() -> StringObj* {
+    static char marker;
+    return reinterpret_cast<StringObj*>(&marker);
+  }
+
+  // Rebuilds the table without the tombstones, the capacity is doubled only
+  // if the table is still at least half full afterwards
+  auto grow() -> void {
+    size_t live = 0;
+    for (StringObj* entry : entries) {
+      if (entry != nullptr && entry != tombstone()) live++;
+    }
+    size_t capacity = 64;
+    while (live * 2 >= capacity) capacity *= 2;
+
+    std::vector<StringObj*> old = std::move(entries);
+    entries.assign(capacity, nullptr);
+    used = 0;
+    for (StringObj* entry : old) {
+      if (entry != nullptr && entry != tombstone()) insert(entry);
+    }
+  }
+
+  std::vector<StringObj*> entries;
+  // Number of entries that are not empty, tombstones included
+  size_t used = 0;
+};
+
+auto string_table() -> StringTable& {
+  // Never destroyed, values in other static objects may outlive it otherwise
+  static auto* table = new StringTable{};
+  return *table;
+}
+
+}  // namespace
+
+auto destroy(Obj* obj) -> void {
+  // Freeing an object drops the references it holds, which would otherwise
+  // recurse as deep as the longest chain of objects (e.g. a long linked list
+  // of instances) and overflow the stack. Objects freed while another one is
+  // being freed are queued instead, and freed one by one by the outermost call.
+  static std::vector<Obj*> pending;
+  static bool destroying = false;
+
+  if (destroying) {
+    pending.push_back(obj);
+    return;
+  }
+
+  destroying = true;
+  delete obj;
+  while (!pending.empty()) {
+    Obj* next = pending.back();
+    pending.pop_back();
+    delete next;
+  }
+  destroying = false;
+}
+
+auto StringObj::hash_of(std::string_view value) -> uint32_t {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (char c : value) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+auto StringObj::intern(std::string_view value) -> Ref<StringObj> {
+  auto& table = string_table();
+  uint32_t hash = hash_of(value);
+  std::lock_guard guard{table.lock};
+  if (auto* found = table.find(value, hash); found != nullptr)
+    return Ref<StringObj>{found};
+
+  auto* str = new StringObj{std::string{value}, hash};
+  table.insert(str);
+  return Ref<StringObj>{str};
+}
+
+auto StringObj::intern(std::string&& value) -> Ref<StringObj> {
+  auto& table = string_table();
+  uint32_t hash = hash_of(value);
+  std::lock_guard guard{table.lock};
+  if (auto* found = table.find(value, hash); found != nullptr)
+    return Ref<StringObj>{found};
+
+  auto* str = new StringObj{std::move(value), hash};
+  table.insert(str);
+  return Ref<StringObj>{str};
+}
+
+StringObj::~StringObj() {
+  auto& table = string_table();
+  std::lock_guard guard{table.lock};
+  table.erase(this);
+}
+
+auto BuilderObj::flatten() -> StringObj* {
+  if (!flat) flat = StringObj::intern(view());
+  return flat.get();
+}
+
+// Shorter strings are cheap enough to intern on every concatenation, and stay
+// cheap to compare and to use as keys
+static constexpr size_t MIN_BUILDER_LENGTH = 64;
+
+auto concatenate(const Value& left, const Value& right) -> Value {
+  std::string_view head = left.as_string_view();
+  std::string_view tail = right.as_string_view();
+  size_t length = head.size() + tail.size();
+
+  if (left.is_obj(ObjType::BUILDER)) {
+    const auto* builder = left.as<BuilderObj>();
+    const auto& buffer = builder->buffer;
+    // Appending to a buffer the other string is in could move it while it's
+    // being copied
+    bool shared = right.is_obj(ObjType::BUILDER) &&
+                  right.as<BuilderObj>()->buffer == buffer;
+    if (buffer->size() == builder->length && !shared) {
+      buffer->append(tail);
+      return make_ref<BuilderObj>(buffer, length);
+    }
+  } else if (length < MIN_BUILDER_LENGTH) {
+    std::string result{};
+    result.reserve(length);
+    result.append(head).append(tail);
+    return Value{std::move(result)};
+  }
+
+  // A new buffer, with room to append as much again
+  auto buffer = std::make_shared<std::string>();
+  buffer->reserve(length * 2);
+  buffer->append(head).append(tail);
+  return make_ref<BuilderObj>(std::move(buffer), length);
+}
+
+}  // namespace loxalone
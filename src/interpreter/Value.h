@@ -0,0 +1,304 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#ifndef LOXALONE_VALUE_H
+#define LOXALONE_VALUE_H
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace loxalone {
+
+enum class ObjType : uint8_t {
+  STRING,
+  BUILDER,
+  CALLABLE,
+  INSTANCE,
+  CELL,
+  ARRAY,
+  LIST,
+  MAP
+};
+
+// Number of objects alive, which `perf.objects()` reports to find leaks.
+// Other threads only create strings, which happens under the lock of the
+// string table.
+inline size_t live_objects = 0;
+
+/*
+ * Obj is the base class of every lox value that lives on the heap. Objects are
+ * reference counted intrusively, the count is maintained by `Value` and `Ref`
+ * so the object header only costs a few bytes.
+ * */
+class Obj {
+ public:
+  explicit Obj(ObjType type) : type{type}, refs{0} { live_objects++; }
+  Obj(const Obj&) = delete;
+  auto operator=(const Obj&) -> Obj& = delete;
+  virtual ~Obj() { live_objects--; }
+
+  const ObjType type;
+  uint32_t refs;
+};
+
+inline auto retain(Obj* obj) -> void { obj->refs++; }
+
+// Frees an object whose last reference was dropped
+auto destroy(Obj* obj) -> void;
+
+inline auto release(Obj* obj) -> void {
+  if (--obj->refs == 0) destroy(obj);
+}
+
+// Ref is a smart pointer that holds a reference to a heap object, much like
+// `std::shared_ptr` but without the separate control block.
+template <typename T>
+class Ref {
+ public:
+  Ref() : ptr{nullptr} {}
+  explicit Ref(T* ptr) : ptr{ptr} {
+    if (ptr != nullptr) retain(ptr);
+  }
+  Ref(const Ref& other) : Ref{other.ptr} {}
+  Ref(Ref&& other) noexcept : ptr{std::exchange(other.ptr, nullptr)} {}
+
+  template <typename U>
+    requires std::derived_from<U, T>
+  Ref(const Ref<U>& other) : Ref{other.get()} {}
+
+  ~Ref() {
+    if (ptr != nullptr) release(ptr);
+  }
+
+  auto operator=(Ref other) noexcept -> Ref& {
+    std::swap(ptr, other.ptr);
+    return *this;
+  }
+
+  auto get() const -> T* { return ptr; }
+  // Gives up the reference without dropping it, for the caller to drop
+  auto detach() -> T* { return std::exchange(ptr, nullptr); }
+  auto operator->() const -> T* { return ptr; }
+  auto operator*() const -> T& { return *ptr; }
+  explicit operator bool() const { return ptr != nullptr; }
+  auto operator==(const Ref& other) const -> bool { return ptr == other.ptr; }
+
+ private:
+  T* ptr;
+};
+
+template <typename T, typename... Args>
+auto make_ref(Args&&... args) -> Ref<T> {
+  return Ref<T>{new T(std::forward<Args>(args)...)};
+}
+
+/*
+ * StringObj is an immutable lox string. Every string is interned, there is
+ * never more than one live object with the same content, so two strings are
+ * equal only if they are the same object. The hash is computed once when the
+ * string is created.
+ * */
+class StringObj : public Obj {
+ public:
+  // Returns the interned string with the given content, creating it if there
+  // isn't one already
+  static auto intern(std::string_view value) -> Ref<StringObj>;
+  static auto intern(std::string&& value) -> Ref<StringObj>;
+
+  static auto hash_of(std::string_view value) -> uint32_t;
+
+  ~StringObj() override;
+
+  const std::string value;
+  const uint32_t hash;
+
+ private:
+  StringObj(std::string value, uint32_t hash)
+      : Obj{ObjType::STRING}, value{std::move(value)}, hash{hash} {}
+};
+
+/*
+ * BuilderObj is a long lox string made by `+`, which isn't interned right away
+ * so that building a string piece by piece doesn't copy and hash all of it
+ * every time. It's the first `length` characters of a buffer that can be
+ * shared with the strings it was built from and the ones built from it. Only
+ * the string ending at the end of the buffer appends to it, so appending to
+ * the string built last takes amortized constant time, and the characters a
+ * string can see never change.
+ *
+ * The string is interned the first time it's needed as a `StringObj`, e.g. as
+ * the key of a map. Printing and comparing it works on the buffer directly.
+ * */
+class BuilderObj : public Obj {
+ public:
+  BuilderObj(std::shared_ptr<std::string> buffer, size_t length)
+      : Obj{ObjType::BUILDER}, buffer{std::move(buffer)}, length{length} {}
+
+  auto view() const -> std::string_view { return {buffer->data(), length}; }
+
+  // Returns the interned string with the same content
+  auto flatten() -> StringObj*;
+
+  const std::shared_ptr<std::string> buffer;
+  const size_t length;
+
+ private:
+  Ref<StringObj> flat;
+};
+
+/*
+ * Value is a lox value packed into 64 bits with NaN-boxing. Numbers are stored
+ * as plain doubles. Every other value is encoded inside the payload of a quiet
+ * NaN: nil and booleans as small tags, heap objects as a pointer with the sign
+ * bit set. Copying a number or a boolean is a plain 8 byte copy, copying an
+ * object only bumps its reference count.
+ * */
+class Value {
+ public:
+  Value() : bits{NIL_BITS} {}
+  Value(bool value) : bits{value ? TRUE_BITS : FALSE_BITS} {}
+  Value(double value) : bits{std::bit_cast<uint64_t>(value)} {
+    // Only keep the canonical NaN, so no computed NaN can look like a tag
+    if (value != value) bits = CANONICAL_NAN;
+  }
+
+  // Strings are looked up in the string table, a new heap object is only
+  // created for content that hasn't been seen before
+  explicit Value(std::string value)
+      : Value{StringObj::intern(std::move(value))} {}
+  explicit Value(std::string_view value) : Value{StringObj::intern(value)} {}
+  explicit Value(const char* value) : Value{std::string_view{value}} {}
+
+  // Pointers must not silently turn into booleans
+  Value(const void*) = delete;
+
+  explicit Value(Obj* obj) : bits{SIGN_BIT | QNAN | std::bit_cast<uint64_t>(obj)} {
+    retain(obj);
+  }
+
+  template <typename T>
+    requires std::derived_from<T, Obj>
+  Value(const Ref<T>& ref) : Value{static_cast<Obj*>(ref.get())} {}
+  // Takes over the reference of `ref`, so e.g. a string interned on another
+  // thread isn't retained and released again outside of the table's lock
+  template <typename T>
+    requires std::derived_from<T, Obj>
+  Value(Ref<T>&& ref)
+      : bits{SIGN_BIT | QNAN |
+             std::bit_cast<uint64_t>(static_cast<Obj*>(ref.detach()))} {}
+
+  Value(const Value& other) : bits{other.bits} {
+    if (is_obj()) retain(as_obj());
+  }
+  Value(Value&& other) noexcept : bits{std::exchange(other.bits, NIL_BITS)} {}
+
+  ~Value() {
+    if (is_obj()) release(as_obj());
+  }
+
+  auto operator=(const Value& other) -> Value& {
+    if (other.is_obj()) retain(other.as_obj());
+    if (is_obj()) release(as_obj());
+    bits = other.bits;
+    return *this;
+  }
+
+  auto operator=(Value&& other) noexcept -> Value& {
+    if (this != &other) {
+      if (is_obj()) release(as_obj());
+      bits = std::exchange(other.bits, NIL_BITS);
+    }
+    return *this;
+  }
+
+  auto is_nil() const -> bool { return bits == NIL_BITS; }
+  auto is_bool() const -> bool { return (bits | 1) == TRUE_BITS; }
+  auto is_number() const -> bool { return (bits & QNAN) != QNAN; }
+  auto is_obj() const -> bool {
+    return (bits & (QNAN | SIGN_BIT)) == (QNAN | SIGN_BIT);
+  }
+  auto is_obj(ObjType type) const -> bool {
+    return is_obj() && as_obj()->type == type;
+  }
+  // Whether the value is a lox string, interned or built by `+`
+  auto is_string() const -> bool {
+    return is_obj(ObjType::STRING) || is_obj(ObjType::BUILDER);
+  }
+  auto is_callable() const -> bool { return is_obj(ObjType::CALLABLE); }
+  auto is_instance() const -> bool { return is_obj(ObjType::INSTANCE); }
+  auto is_array() const -> bool { return is_obj(ObjType::ARRAY); }
+  auto is_list() const -> bool { return is_obj(ObjType::LIST); }
+  auto is_map() const -> bool { return is_obj(ObjType::MAP); }
+
+  auto as_bool() const -> bool { return bits == TRUE_BITS; }
+  auto as_number() const -> double { return std::bit_cast<double>(bits); }
+  auto as_obj() const -> Obj* {
+    return std::bit_cast<Obj*>(bits & ~(SIGN_BIT | QNAN));
+  }
+  auto as_string() const -> const std::string& {
+    return as_string_obj()->value;
+  }
+
+  // The interned string, a string built by `+` is interned on the first call
+  auto as_string_obj() const -> StringObj* {
+    if (as_obj()->type == ObjType::STRING) return as<StringObj>();
+    return as<BuilderObj>()->flatten();
+  }
+
+  // The characters of the string, without interning it
+  auto as_string_view() const -> std::string_view {
+    if (as_obj()->type == ObjType::STRING) return as<StringObj>()->value;
+    return as<BuilderObj>()->view();
+  }
+
+  // The encoded value. Two values with the same bits behave the same in every
+  // operation, so the bits can be used as a key.
+  auto raw() const -> uint64_t { return bits; }
+
+  // Returns the heap object as the given type, the caller must have checked
+  // the type of the value beforehand
+  template <typename T>
+    requires std::derived_from<T, Obj>
+  auto as() const -> T* {
+    return static_cast<T*>(as_obj());
+  }
+
+  // Numbers are compared by value. Interned strings, like every other object,
+  // are only equal to themselves, strings built by `+` are compared by content.
+  auto operator==(const Value& other) const -> bool {
+    if (is_number() && other.is_number())
+      return as_number() == other.as_number();
+    if (bits == other.bits) return true;
+    if (is_obj(ObjType::BUILDER) || other.is_obj(ObjType::BUILDER))
+      return is_string() && other.is_string() &&
+             as_string_view() == other.as_string_view();
+    return false;
+  }
+
+ private:
+  static constexpr uint64_t SIGN_BIT = 0x8000000000000000;
+  static constexpr uint64_t QNAN = 0x7ffc000000000000;
+  static constexpr uint64_t CANONICAL_NAN = 0x7ff8000000000000;
+  static constexpr uint64_t NIL_BITS = QNAN | 1;
+  static constexpr uint64_t FALSE_BITS = QNAN | 2;
+  static constexpr uint64_t TRUE_BITS = QNAN | 3;
+
+  uint64_t bits;
+};
+
+static_assert(sizeof(Value) == 8);
+
+// Returns the concatenation of two strings. Short results are interned like
+// any other string, longer ones are built in a BuilderObj.
+auto concatenate(const Value& left, const Value& right) -> Value;
+
+}  // namespace loxalone
+
+#endif  // LOXALONE_VALUE_H
@@ -0,0 +1,51 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "../src/interpreter/ArrayKernels.h"
+
+using namespace loxalone;
+
+// Runs `min` and `max` of every set of kernels the CPU supports on arrays of
+// up to three vectors and a tail, with a NaN at each index in turn: the first
+// one, every lane of the vectors and the tail.
+int main() {
+  constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+  int failures = 0;
+  auto check = [&](const ArrayKernels& kernels, const char* kernel,
+                   size_t size, double result, double expected) {
+    bool same = std::isnan(expected) ? std::isnan(result) : result == expected;
+    if (same) return;
+    fmt::print(stderr, "{} {} of {} elements: expected {} but got {}\n",
+               kernels.name, kernel, size, expected, result);
+    failures++;
+  };
+
+  for (const auto* kernels : supported_array_kernels()) {
+    for (size_t size = 1; size <= 15; size++) {
+      std::vector<double> values(size);
+      for (size_t i = 0; i < size; i++)
+        values[i] = static_cast<double>(i * 7 % 11) - 5;
+
+      double min = *std::min_element(values.begin(), values.end());
+      double max = *std::max_element(values.begin(), values.end());
+      check(*kernels, "min", size, kernels->min(values.data(), size), min);
+      check(*kernels, "max", size, kernels->max(values.data(), size), max);
+
+      for (size_t i = 0; i < size; i++) {
+        std::vector<double> nan = values;
+        nan[i] = NaN;
+        check(*kernels, "min", size, kernels->min(nan.data(), size), NaN);
+        check(*kernels, "max", size, kernels->max(nan.data(), size), NaN);
+      }
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
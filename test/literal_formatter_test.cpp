@@ -0,0 +1,64 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include <fmt/format.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/interpreter/Collections.h"
+#include "../src/interpreter/LiteralFormatter.h"
+
+using namespace loxalone;
+
+namespace {
+
+int failures = 0;
+
+auto check(std::string_view what, const std::string& text,
+           const std::string& expected) -> void {
+  if (text == expected) return;
+  fmt::print(stderr, "{}: expected {} characters but got {}: {:.40}...\n", what,
+             expected.size(), text.size(), text);
+  failures++;
+}
+
+}  // namespace
+
+// Prints lists and maps nested far deeper than the C++ stack allows writing
+// them recursively, and lists and maps inside of themselves
+int main() {
+  constexpr size_t DEPTH = 1000000;
+
+  Value list{make_ref<ListObj>()};
+  for (size_t i = 0; i < DEPTH; i++)
+    list = Value{make_ref<ListObj>(std::vector<Value>{list, Value{1.0}})};
+  std::string expected = std::string(DEPTH + 1, '[');
+  for (size_t i = 0; i < DEPTH; i++) expected += "], 1";
+  check("nested lists", fmt::format("{}", list), expected + "]\n");
+
+  Value key{std::string_view{"k"}};
+  Value map{make_ref<MapObj>()};
+  for (size_t i = 0; i < DEPTH; i++) {
+    auto outer = make_ref<MapObj>();
+    outer->set(key, map);
+    map = Value{outer};
+  }
+  expected.clear();
+  for (size_t i = 0; i < DEPTH; i++) expected += "{k: ";
+  expected += "{}";
+  expected += std::string(DEPTH, '}');
+  check("nested maps", fmt::format("{}", map), expected + "\n");
+
+  auto cycle = make_ref<ListObj>();
+  auto inner = make_ref<MapObj>();
+  inner->set(key, Value{cycle});
+  cycle->values = {Value{inner}, Value{cycle}};
+  check("cycle", fmt::format("{}", Value{cycle}), "[{k: [...]}, [...]]\n");
+  // Neither of them is freed otherwise
+  cycle->values.clear();
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+//
+// Created by Htet Aung Shine on 17/10/2026.
+//
+
+#include <fmt/format.h>
+
+#include <string_view>
+#include <vector>
+
+#include "../src/interpreter/Arena.h"
+#include "../src/interpreter/Interpreter.h"
+#include "../src/interpreter/NativeStack.h"
+#include "../src/interpreter/Parser.h"
+#include "../src/interpreter/Resolver.h"
+#include "../src/interpreter/Scanner.h"
+
+using namespace loxalone;
+
+namespace {
+
+Value kept{};
+
+// Reads its argument, taken by reference, after calling back into lox
+auto keep(Engine& engine, LoxCallable& fn, const Value& value) -> void {
+  engine.call_back(fn, Args{});
+  kept = value;
+}
+
+// Recurses deep enough to grow the value stack of the tree engine, which
+// moves the arguments of the native
+constexpr std::string_view SCRIPT = R"(
+fun deep(n) {
+  var a = n;
+  var b = n;
+  if (n > 0) return deep(n - 1) + a - b;
+  return 0;
+}
+fun grow() { deep(3000); }
+keep(grow, "value" + " kept");
+)";
+
+}  // namespace
+
+// A value passed to a native stays valid across a call back into lox
+int main() {
+  return run_with_stack(native_stack_size(DEFAULT_MAX_CALL_DEPTH), [] {
+    Arena arena{};
+    Scanner scanner{SCRIPT};
+    Parser parser{scanner, arena};
+    List<Stmt> statements = arena.list(parser.parse());
+    Resolver{}.resolve(statements);
+
+    Interpreter interpreter{};
+    interpreter.register_native<&keep>("keep");
+    if (!interpreter.interpret(statements)) return 1;
+
+    if (!kept.is_string() || kept.as_string() != "value kept") {
+      fmt::print(stderr, "expected the kept value to be \"value kept\"\n");
+      return 1;
+    }
+    kept = Value{};
+    return 0;
+  });
+}
@@ -0,0 +1,38 @@
+# Runs a test script and compares its output with the comments in it:
+# - `// expect: <line>` is the next line printed on stdout.
+# - `// expect error: <text>` is printed on stderr, and the script fails.
+#
+# cmake -DLOXALONE=<binary> -DENGINE=<tree|vm> [-DFLAGS=<flags>] -DSCRIPT=<file>
+#       -P run_test.cmake
+
+execute_process(
+        COMMAND ${LOXALONE} --engine=${ENGINE} ${FLAGS} ${SCRIPT}
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE errors
+        RESULT_VARIABLE result)
+
+file(READ ${SCRIPT} source)
+
+string(REGEX MATCHALL "// expect: [^\n]*" expects "${source}")
+set(expected "")
+foreach (expect IN LISTS expects)
+    string(REPLACE "// expect: " "" line "${expect}")
+    string(APPEND expected "${line}\n")
+endforeach ()
+if (NOT output STREQUAL expected)
+    message(FATAL_ERROR "Expected output:\n${expected}Got:\n${output}${errors}")
+endif ()
+
+string(REGEX MATCHALL "// expect error: [^\n]*" expects "${source}")
+foreach (expect IN LISTS expects)
+    string(REPLACE "// expect error: " "" text "${expect}")
+    string(FIND "${errors}" "${text}" found)
+    if (found EQUAL -1)
+        message(FATAL_ERROR "Expected error: ${text}\nGot:\n${errors}")
+    endif ()
+endforeach ()
+if (expects AND result EQUAL 0)
+    message(FATAL_ERROR "Expected the script to fail")
+elseif (NOT expects AND NOT result EQUAL 0)
+    message(FATAL_ERROR "Exited with ${result}:\n${errors}")
+endif ()